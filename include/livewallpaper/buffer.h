@@ -68,6 +68,7 @@ void lw_buffer_set_normalized(LwBuffer *self, gboolean normalized);
 
 void lw_buffer_set_data(LwBuffer *self, guint size, gpointer data);
 void lw_buffer_set_sub_data(LwBuffer *self, guint offset, guint size, gpointer data);
+void lw_buffer_stream_data(LwBuffer *self, guint size, gpointer data);
 
 gpointer lw_buffer_get_data(LwBuffer *self, guint offset, guint size);
 /*void lw_buffer_get_data(LwBuffer *self, guint offset, guint size, gpointer data);*/
@@ -55,7 +55,9 @@ GType lw_cairo_texture_get_type(void);
 LwCairoTexture *lw_cairo_texture_new(guint width, guint height);
 
 cairo_t *lw_cairo_texture_cairo_create(LwCairoTexture *self);
+void lw_cairo_texture_freeze(LwCairoTexture *self);
 
+void lw_cairo_texture_mark_dirty(LwCairoTexture *self, gint x, gint y, gint width, gint height);
 void lw_cairo_texture_update(LwCairoTexture *self);
 
 G_END_DECLS
@@ -0,0 +1,62 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ * Copyright (C) 2012-2016 Aurélien   Rivière <aurelien.riv@gmail.com>
+ *
+ */
+
+#ifndef _LW_COLORIZED_TEXTURE_H_
+#define _LW_COLORIZED_TEXTURE_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_COLORIZED_TEXTURE            (lw_colorized_texture_get_type())
+#define LW_COLORIZED_TEXTURE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_COLORIZED_TEXTURE, LwColorizedTexture))
+#define LW_IS_COLORIZED_TEXTURE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_COLORIZED_TEXTURE))
+#define LW_COLORIZED_TEXTURE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_COLORIZED_TEXTURE, LwColorizedTextureClass))
+#define LW_IS_COLORIZED_TEXTURE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_COLORIZED_TEXTURE))
+#define LW_COLORIZED_TEXTURE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_COLORIZED_TEXTURE, LwColorizedTextureClass))
+
+typedef struct _LwColorizedTexture LwColorizedTexture;
+typedef struct _LwColorizedTextureClass LwColorizedTextureClass;
+
+typedef struct _LwColorizedTexturePrivate LwColorizedTexturePrivate;
+
+struct _LwColorizedTexture
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwColorizedTexturePrivate *priv;
+};
+
+struct _LwColorizedTextureClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_colorized_texture_get_type(void);
+
+LwColorizedTexture *lw_colorized_texture_new(LwTexture *source);
+
+LwTexture *lw_colorized_texture_get_texture(LwColorizedTexture *self);
+
+G_END_DECLS
+
+#endif /* _LW_COLORIZED_TEXTURE_H_ */
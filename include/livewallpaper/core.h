@@ -31,18 +31,28 @@
 #include <GL/glew.h>
 
 #include <livewallpaper/util.h>
+#include <livewallpaper/gl-state.h>
 #include <livewallpaper/error.h>
+#include <livewallpaper/job-system.h>
 #include <livewallpaper/random.h>
 #include <livewallpaper/range.h>
 #include <livewallpaper/noise.h>
+#include <livewallpaper/flow-field.h>
 #include <livewallpaper/color.h>
 #include <livewallpaper/output.h>
 #include <livewallpaper/texture.h>
+#include <livewallpaper/texture-loader.h>
+#include <livewallpaper/texture-cache.h>
+#include <livewallpaper/texture-atlas.h>
+#include <livewallpaper/colorized-texture.h>
 #include <livewallpaper/cairo-texture.h>
 #include <livewallpaper/shader.h>
 #include <livewallpaper/math.h>
+#include <livewallpaper/mat4.h>
 #include <livewallpaper/matrix.h>
 #include <livewallpaper/buffer.h>
+#include <livewallpaper/particle-system.h>
+#include <livewallpaper/level-of-detail.h>
 #include <livewallpaper/program.h>
 #include <livewallpaper/background.h>
 #include <livewallpaper/wallpaper.h>
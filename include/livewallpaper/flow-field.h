@@ -0,0 +1,63 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_FLOW_FIELD_H_
+#define _LW_FLOW_FIELD_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_FLOW_FIELD            (lw_flow_field_get_type())
+#define LW_FLOW_FIELD(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_FLOW_FIELD, LwFlowField))
+#define LW_IS_FLOW_FIELD(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_FLOW_FIELD))
+#define LW_FLOW_FIELD_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_FLOW_FIELD, LwFlowFieldClass))
+#define LW_IS_FLOW_FIELD_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_FLOW_FIELD))
+#define LW_FLOW_FIELD_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_FLOW_FIELD, LwFlowFieldClass))
+
+typedef struct _LwFlowField LwFlowField;
+typedef struct _LwFlowFieldClass LwFlowFieldClass;
+
+typedef struct _LwFlowFieldPrivate LwFlowFieldPrivate;
+
+struct _LwFlowField
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwFlowFieldPrivate *priv;
+};
+
+struct _LwFlowFieldClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_flow_field_get_type(void);
+
+LwFlowField *lw_flow_field_new(gfloat x, gfloat y, gfloat width, gfloat height, guint columns, guint rows);
+
+gboolean lw_flow_field_is_ready(LwFlowField *self);
+void lw_flow_field_sample(LwFlowField *self, gfloat x, gfloat y, gfloat *dx, gfloat *dy, gfloat *value);
+
+G_END_DECLS
+
+#endif /* _LW_FLOW_FIELD_H_ */
+
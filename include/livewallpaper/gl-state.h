@@ -0,0 +1,50 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_GL_STATE_H_
+#define _LW_GL_STATE_H_
+
+G_BEGIN_DECLS
+
+void lw_gl_state_invalidate(void);
+
+void lw_gl_state_enable(guint cap);
+void lw_gl_state_disable(guint cap);
+gboolean lw_gl_state_is_enabled(guint cap);
+
+void lw_gl_state_blend_func(guint sfactor, guint dfactor);
+
+void lw_gl_state_active_texture(guint unit);
+void lw_gl_state_bind_texture(guint target, guint name);
+void lw_gl_state_bind_buffer(guint target, guint name);
+void lw_gl_state_use_program(guint name);
+
+void lw_gl_state_forget_texture(guint name);
+void lw_gl_state_forget_buffer(guint name);
+void lw_gl_state_forget_program(guint name);
+
+guint lw_gl_state_get_elided_calls(void);
+void lw_gl_state_reset_elided_calls(void);
+
+G_END_DECLS
+
+#endif /* _LW_GL_STATE_H_ */
+
@@ -0,0 +1,97 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_JOB_SYSTEM_H_
+#define _LW_JOB_SYSTEM_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_JOB_SYSTEM            (lw_job_system_get_type())
+#define LW_JOB_SYSTEM(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_JOB_SYSTEM, LwJobSystem))
+#define LW_IS_JOB_SYSTEM(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_JOB_SYSTEM))
+#define LW_JOB_SYSTEM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_JOB_SYSTEM, LwJobSystemClass))
+#define LW_IS_JOB_SYSTEM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_JOB_SYSTEM))
+#define LW_JOB_SYSTEM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_JOB_SYSTEM, LwJobSystemClass))
+
+typedef struct _LwJob LwJob;
+
+typedef struct _LwJobSystem LwJobSystem;
+typedef struct _LwJobSystemClass LwJobSystemClass;
+
+typedef struct _LwJobSystemPrivate LwJobSystemPrivate;
+
+/**
+ * LwJobFunc:
+ * @data: The data passed to lw_job_new()
+ *
+ * The work done by a #LwJob.
+ *
+ * Since: 0.6
+ */
+typedef void (*LwJobFunc)(gpointer data);
+
+/**
+ * LwJobRangeFunc:
+ * @first: The first index of the range
+ * @count: Number of indices in the range
+ * @data: The data passed to lw_job_system_parallel_for()
+ *
+ * Processes the indices @first to @first + @count - 1.
+ *
+ * Since: 0.6
+ */
+typedef void (*LwJobRangeFunc)(guint first, guint count, gpointer data);
+
+struct _LwJobSystem
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwJobSystemPrivate *priv;
+};
+
+struct _LwJobSystemClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+LwJob *lw_job_new(LwJobFunc func, gpointer data, LwJob *parent);
+LwJob *lw_job_ref(LwJob *job);
+void lw_job_unref(LwJob *job);
+void lw_job_add_continuation(LwJob *job, LwJob *continuation);
+gboolean lw_job_is_finished(LwJob *job);
+
+GType lw_job_system_get_type(void);
+
+LwJobSystem *lw_job_system_new(guint n_workers, gboolean pin_workers);
+LwJobSystem *lw_job_system_get_default(void);
+
+guint lw_job_system_get_n_workers(LwJobSystem *self);
+
+void lw_job_system_submit(LwJobSystem *self, LwJob *job);
+void lw_job_system_wait(LwJobSystem *self, LwJob *job);
+void lw_job_system_parallel_for(LwJobSystem *self, guint count, guint grain, LwJobRangeFunc func, gpointer data);
+
+G_END_DECLS
+
+#endif /* _LW_JOB_SYSTEM_H_ */
+
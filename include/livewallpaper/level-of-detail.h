@@ -0,0 +1,66 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_LEVEL_OF_DETAIL_H_
+#define _LW_LEVEL_OF_DETAIL_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_LEVEL_OF_DETAIL            (lw_level_of_detail_get_type())
+#define LW_LEVEL_OF_DETAIL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_LEVEL_OF_DETAIL, LwLevelOfDetail))
+#define LW_IS_LEVEL_OF_DETAIL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_LEVEL_OF_DETAIL))
+#define LW_LEVEL_OF_DETAIL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_LEVEL_OF_DETAIL, LwLevelOfDetailClass))
+#define LW_IS_LEVEL_OF_DETAIL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_LEVEL_OF_DETAIL))
+#define LW_LEVEL_OF_DETAIL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_LEVEL_OF_DETAIL, LwLevelOfDetailClass))
+
+typedef struct _LwLevelOfDetail LwLevelOfDetail;
+typedef struct _LwLevelOfDetailClass LwLevelOfDetailClass;
+
+typedef struct _LwLevelOfDetailPrivate LwLevelOfDetailPrivate;
+
+struct _LwLevelOfDetail
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwLevelOfDetailPrivate *priv;
+};
+
+struct _LwLevelOfDetailClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_level_of_detail_get_type(void);
+
+LwLevelOfDetail *lw_level_of_detail_new(gdouble coverage);
+
+guint lw_level_of_detail_get_count(LwLevelOfDetail *self);
+
+void lw_level_of_detail_begin_frame(LwLevelOfDetail *self);
+void lw_level_of_detail_add_output(LwLevelOfDetail *self, LwOutput *output, gdouble point_size);
+void lw_level_of_detail_end_frame(LwLevelOfDetail *self);
+
+G_END_DECLS
+
+#endif /* _LW_LEVEL_OF_DETAIL_H_ */
+
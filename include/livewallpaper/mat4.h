@@ -0,0 +1,56 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_MAT4_H_
+#define _LW_MAT4_H_
+
+G_BEGIN_DECLS
+
+typedef struct _LwMat4 LwMat4;
+
+struct _LwMat4
+{
+	gfloat m[16];
+};
+
+void lw_mat4_init_identity(LwMat4 *self);
+
+void lw_mat4_ortho(LwMat4 *self,
+                   gfloat left, gfloat right,
+                   gfloat bottom, gfloat top,
+                   gfloat nearVal, gfloat farVal);
+void lw_mat4_frustum(LwMat4 *self,
+                     gfloat left, gfloat right,
+                     gfloat bottom, gfloat top,
+                     gfloat nearVal, gfloat farVal);
+
+void lw_mat4_translate(LwMat4 *self, gfloat x, gfloat y, gfloat z);
+void lw_mat4_rotate(LwMat4 *self, gfloat angle, gfloat x, gfloat y, gfloat z);
+void lw_mat4_scale(LwMat4 *self, gfloat x, gfloat y, gfloat z);
+
+void lw_mat4_multiply(LwMat4 *result, const LwMat4 *a, const LwMat4 *b);
+gboolean lw_mat4_invert(LwMat4 *result, const LwMat4 *m);
+void lw_mat4_transform_points(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points);
+
+G_END_DECLS
+
+#endif /* _LW_MAT4_H_ */
+
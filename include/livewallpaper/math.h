@@ -26,6 +26,12 @@
  *
  * The LiveWallpaper Core Library provides faster implementations of some common
  * mathematical functions.
+ *
+ * lw_sin(), lw_cos() and lw_sincos_batch() interpolate linearly in a table holding
+ * one period of the sine. Its resolution is set at build time with the CMake variable
+ * LW_SINE_TABLE_STEPS, the number of entries per quarter period. The maximum error is
+ * 7.5e-5 for 64 steps, 4.7e-6 for 256 steps and 4.6e-7 for 1024 steps, the default.
+ * More steps hardly improve the accuracy because of the precision of floats.
  */
 
 #ifndef _LW_MATH_H_
@@ -59,23 +65,18 @@
 #define LW_2PI (gfloat) 6.283185
 #define LW_PI2 (gfloat) 1.570796
 
+/* Generated by tools/sine-table-generator, see livewallpaper-core/CMakeLists.txt */
+extern const int sin_steps;
 extern const float step;
-extern const float sin_values[1024];
+extern const float sin_values[];
 
 /**
  * lw_sin:
- * @angle: The angle in the range -%LW_2PI <= @angle <= 0
- *
- * Calculates the sine value of an angle by using a lookup table. Using this function
- * is usually faster than computing the sine value with the sin() function of the standard
- * library.
+ * @angle: The angle in radians
  *
- * <warning>
- *   <para>
- *     Make sure to use this function only with angles in the allowed range. This function
- *     does not check if the angle is out of range and so the application will crash.
- *   </para>
- * </warning>
+ * Calculates the sine value of an angle by interpolating in a lookup table. Using this
+ * function is usually faster than computing the sine value with the sin() function of
+ * the standard library.
  *
  * Returns: The sine value of the @angle
  *
@@ -84,39 +85,24 @@ extern const float sin_values[1024];
 static inline gfloat
 lw_sin(gfloat angle)
 {
-	gint sign = -1;
-
-	angle = -angle;
-	/* 0 <= angle <= 2PI */
+	gfloat x = angle / step, f;
+	gint i = (gint) x;
 
-	if(angle > LW_PI)
-	{
-		sign = 1;
-		angle = angle - LW_PI;
-	}
-	/* 0 <= angle <= PI */
+	/* Round towards minus infinity and wrap around after a period */
+	i -= (gfloat) i > x;
+	f = x - (gfloat) i;
+	i &= 4 * sin_steps - 1;
 
-	if(angle > LW_PI2)
-		angle = LW_PI - angle;
-	/* 0 <= angle <= PI/2 */
-
-	return sign * sin_values[ ((gint) (angle / step)) ];
+	return sin_values[i] + f * (sin_values[i + 1] - sin_values[i]);
 }
 
 /**
  * lw_cos:
- * @angle: The angle in the range -%LW_2PI <= @angle <= 0
- *
- * Calculates the cosine value of an angle by using a lookup table. Using this function
- * is usually faster than computing the cosine value with the cos() function of the standard
- * library.
+ * @angle: The angle in radians
  *
- * <warning>
- *   <para>
- *     Make sure to use this function only with angles in the allowed range. This function
- *     does not check if the angle is out of range and so the application will crash.
- *   </para>
- * </warning>
+ * Calculates the cosine value of an angle by interpolating in a lookup table. Using this
+ * function is usually faster than computing the cosine value with the cos() function of
+ * the standard library.
  *
  * Returns: The cosine value of the @angle
  *
@@ -125,31 +111,17 @@ lw_sin(gfloat angle)
 static inline gfloat
 lw_cos(gfloat angle)
 {
-	gint sign = 1;
+	gfloat x = angle / step, f;
+	gint i = (gint) x;
 
-	angle = -angle;
-	/* 0 <= angle <= 2PI */
+	/* cos(angle) = sin(angle + PI/2), which is a quarter period later in the table */
+	i -= (gfloat) i > x;
+	f = x - (gfloat) i;
+	i = (i + sin_steps) & (4 * sin_steps - 1);
 
-	/* cos(angle) = sin(angle + PI/2) */
-	angle += LW_PI2;
-	/* PI/2 <= angle <= 2PI + PI/2 */
-
-	if(angle > LW_2PI)
-		angle -= LW_2PI;
-	/* 0 <= angle <= 2PI */
-
-	if(angle > LW_PI)
-	{
-		sign = -1;
-		angle = angle - LW_PI;
-	}
-	/* 0 <= angle <= PI */
-
-	if(angle > LW_PI2)
-		angle = LW_PI - angle;
-	/* 0 <= angle <= PI/2 */
-
-	return sign * sin_values[ ((gint) (angle / step)) ];
+	return sin_values[i] + f * (sin_values[i + 1] - sin_values[i]);
 }
 
+void lw_sincos_batch(const gfloat *angle, gfloat *s, gfloat *c, gsize n);
+
 #endif /* _LW_MATH_H_ */
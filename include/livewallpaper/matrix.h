@@ -55,6 +55,7 @@ GType lw_matrix_get_type(void);
 LwMatrix *lw_matrix_new();
 
 gfloat *lw_matrix_get_elements(LwMatrix *self);
+LwMat4 *lw_matrix_get_mat4(LwMatrix *self);
 
 void lw_matrix_ortho(LwMatrix *self,
                      gfloat left, gfloat right,
@@ -25,6 +25,7 @@
 void lw_noise_init();
 
 float lw_simplex_noise_2f(float x, float y);
+void lw_simplex_noise_2f_batch(const float *x, const float *y, float *out, gsize n);
 /* float lw_simplex_noise_3f(float x, float y, float z); */
 /* float lw_simplex_noise_4f(float x, float y, float z, float w); */
 
@@ -0,0 +1,94 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_PARTICLE_SYSTEM_H_
+#define _LW_PARTICLE_SYSTEM_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_PARTICLE_SYSTEM            (lw_particle_system_get_type())
+#define LW_PARTICLE_SYSTEM(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_PARTICLE_SYSTEM, LwParticleSystem))
+#define LW_IS_PARTICLE_SYSTEM(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_PARTICLE_SYSTEM))
+#define LW_PARTICLE_SYSTEM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_PARTICLE_SYSTEM, LwParticleSystemClass))
+#define LW_IS_PARTICLE_SYSTEM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_PARTICLE_SYSTEM))
+#define LW_PARTICLE_SYSTEM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_PARTICLE_SYSTEM, LwParticleSystemClass))
+
+/**
+ * LW_PARTICLE_SYSTEM_MAX_CHUNK_SIZE:
+ *
+ * The maximum number of particles passed to a #LwParticleUpdateFunc at once.
+ * Update functions can use it to allocate scratch space on the stack.
+ *
+ * Since: 0.6
+ */
+#define LW_PARTICLE_SYSTEM_MAX_CHUNK_SIZE 2048
+
+typedef struct _LwParticleSystem LwParticleSystem;
+typedef struct _LwParticleSystemClass LwParticleSystemClass;
+
+typedef struct _LwParticleSystemPrivate LwParticleSystemPrivate;
+
+/**
+ * LwParticleUpdateFunc:
+ * @system: The #LwParticleSystem
+ * @first: Index of the first particle to update
+ * @count: Number of particles to update
+ * @user_data: The data passed to lw_particle_system_update()
+ *
+ * Updates the particles @first to @first + @count - 1. It may be called from
+ * several threads at the same time, so it must only write to these particles.
+ *
+ * Since: 0.6
+ */
+typedef void (*LwParticleUpdateFunc)(LwParticleSystem *system, guint first, guint count, gpointer user_data);
+
+struct _LwParticleSystem
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwParticleSystemPrivate *priv;
+};
+
+struct _LwParticleSystemClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_particle_system_get_type(void);
+
+LwParticleSystem *lw_particle_system_new(guint n_columns);
+
+guint lw_particle_system_get_n_columns(LwParticleSystem *self);
+guint lw_particle_system_get_count(LwParticleSystem *self);
+void lw_particle_system_set_count(LwParticleSystem *self, guint count);
+guint lw_particle_system_get_chunk_size(LwParticleSystem *self);
+
+gfloat *lw_particle_system_get_column(LwParticleSystem *self, guint column);
+void lw_particle_system_upload_column(LwParticleSystem *self, guint column, LwBuffer *buffer);
+
+void lw_particle_system_update(LwParticleSystem *self, LwParticleUpdateFunc func, gpointer user_data);
+
+G_END_DECLS
+
+#endif /* _LW_PARTICLE_SYSTEM_H_ */
+
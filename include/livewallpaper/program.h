@@ -74,6 +74,10 @@ guint lw_program_get_name(LwProgram *self);
 
 void lw_program_attach_shader(LwProgram *self, LwShader *shader);
 gboolean lw_program_link(LwProgram *self);
+void lw_program_link_async(LwProgram *self);
+gboolean lw_program_is_ready(LwProgram *self);
+
+void lw_program_set_defines(LwProgram *self, const gchar * const *defines);
 
 gint lw_program_get_attrib_location(LwProgram *self, const gchar *name);
 gint lw_program_get_uniform_location(LwProgram *self, const gchar *name);
@@ -26,13 +26,35 @@
  * @Short_description: Various functions returning random numbers
  * @Title: Random Numbers
  *
- * The following functions provide an easy way to get random floating point
- * numbers. All functions using the internal <function>rand()</function> function
- * to generate random numbers.
+ * #LwRandom is a small and fast pseudo random number generator (xoshiro128+).
+ * It does not use any locks, so every thread should use its own instance. The
+ * instance returned by lw_random_get_default() belongs to the calling thread.
+ * Seed an own instance with lw_random_init() if you need a reproducible sequence.
+ *
+ * The functions randf(), rand1f() and rand2f() provide an easy way to get random
+ * floating point numbers from the default instance of the calling thread.
  */
 
+G_BEGIN_DECLS
+
+typedef struct _LwRandom LwRandom;
+
+struct _LwRandom
+{
+	guint32 s[4];
+};
+
+void lw_random_init(LwRandom *self, guint64 seed);
+LwRandom *lw_random_get_default(void);
+
+guint32 lw_random_next(LwRandom *self);
+guint32 lw_random_uint(LwRandom *self, guint32 n);
+gfloat lw_random_float(LwRandom *self);
+void lw_random_fill_uniform(LwRandom *self, gfloat *out, gsize n, gfloat min, gfloat max);
 
- /**
+G_END_DECLS
+
+/**
  * randf:
  *
  * Returns: A random floating point number between 0 and 1
@@ -40,7 +62,7 @@
 static inline gfloat
 randf(void)
 {
-	return rand() / (gfloat) RAND_MAX;
+	return lw_random_float(lw_random_get_default());
 }
 
 /**
@@ -54,11 +54,14 @@ GType lw_shader_get_type(void);
 
 LwShader *lw_shader_new_from_uri(const gchar *uri, guint type);
 LwShader *lw_shader_new_from_string(const gchar *source, guint type);
+LwShader *lw_shader_new_from_string_with_defines(const gchar *source, guint type,
+                                                 const gchar * const *defines);
 
 guint lw_shader_get_name(LwShader *self);
 guint lw_shader_get_shader_type(LwShader *self);
 
 gboolean lw_shader_compile(LwShader *self);
+void lw_shader_compile_async(LwShader *self);
 
 G_END_DECLS
 
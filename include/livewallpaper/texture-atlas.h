@@ -0,0 +1,64 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_TEXTURE_ATLAS_H_
+#define _LW_TEXTURE_ATLAS_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_TEXTURE_ATLAS            (lw_texture_atlas_get_type())
+#define LW_TEXTURE_ATLAS(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_TEXTURE_ATLAS, LwTextureAtlas))
+#define LW_IS_TEXTURE_ATLAS(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_TEXTURE_ATLAS))
+#define LW_TEXTURE_ATLAS_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_TEXTURE_ATLAS, LwTextureAtlasClass))
+#define LW_IS_TEXTURE_ATLAS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_TEXTURE_ATLAS))
+#define LW_TEXTURE_ATLAS_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_TEXTURE_ATLAS, LwTextureAtlasClass))
+
+typedef struct _LwTextureAtlas LwTextureAtlas;
+typedef struct _LwTextureAtlasClass LwTextureAtlasClass;
+
+typedef struct _LwTextureAtlasPrivate LwTextureAtlasPrivate;
+
+struct _LwTextureAtlas
+{
+	/*< private >*/
+	LwTexture parent_instance;
+
+	LwTextureAtlasPrivate *priv;
+};
+
+struct _LwTextureAtlasClass
+{
+	/*< private >*/
+	LwTextureClass parent_class;
+};
+
+GType lw_texture_atlas_get_type(void);
+
+LwTextureAtlas *lw_texture_atlas_new_from_pixbufs(GdkPixbuf **pixbufs, guint n_pixbufs, guint padding);
+LwTextureAtlas *lw_texture_atlas_new_from_resources(const gchar * const *paths, guint padding);
+
+guint lw_texture_atlas_get_n_images(LwTextureAtlas *self);
+const LwTextureMatrix *lw_texture_atlas_get_matrix(LwTextureAtlas *self, guint index);
+
+G_END_DECLS
+
+#endif /* _LW_TEXTURE_ATLAS_H_ */
+
@@ -0,0 +1,69 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_TEXTURE_CACHE_H_
+#define _LW_TEXTURE_CACHE_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_TEXTURE_CACHE            (lw_texture_cache_get_type())
+#define LW_TEXTURE_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_TEXTURE_CACHE, LwTextureCache))
+#define LW_IS_TEXTURE_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_TEXTURE_CACHE))
+#define LW_TEXTURE_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_TEXTURE_CACHE, LwTextureCacheClass))
+#define LW_IS_TEXTURE_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_TEXTURE_CACHE))
+#define LW_TEXTURE_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_TEXTURE_CACHE, LwTextureCacheClass))
+
+typedef struct _LwTextureCache LwTextureCache;
+typedef struct _LwTextureCacheClass LwTextureCacheClass;
+
+typedef struct _LwTextureCachePrivate LwTextureCachePrivate;
+
+struct _LwTextureCache
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwTextureCachePrivate *priv;
+};
+
+struct _LwTextureCacheClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_texture_cache_get_type(void);
+
+LwTextureCache *lw_texture_cache_get_default(void);
+
+LwTexture *lw_texture_cache_load_file(LwTextureCache *self, const gchar *path, guint filter, guint wrap, LwTextureFlags flags);
+LwTexture *lw_texture_cache_load_resource(LwTextureCache *self, const gchar *path, guint filter, guint wrap, LwTextureFlags flags);
+
+void lw_texture_cache_set_budget(LwTextureCache *self, gsize budget);
+gsize lw_texture_cache_get_budget(LwTextureCache *self);
+
+gsize lw_texture_cache_get_released_size(LwTextureCache *self);
+void lw_texture_cache_clear(LwTextureCache *self);
+
+G_END_DECLS
+
+#endif /* _LW_TEXTURE_CACHE_H_ */
+
@@ -0,0 +1,83 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#ifndef _LW_TEXTURE_LOADER_H_
+#define _LW_TEXTURE_LOADER_H_
+
+G_BEGIN_DECLS
+
+#define LW_TYPE_TEXTURE_LOADER            (lw_texture_loader_get_type())
+#define LW_TEXTURE_LOADER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), LW_TYPE_TEXTURE_LOADER, LwTextureLoader))
+#define LW_IS_TEXTURE_LOADER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), LW_TYPE_TEXTURE_LOADER))
+#define LW_TEXTURE_LOADER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), LW_TYPE_TEXTURE_LOADER, LwTextureLoaderClass))
+#define LW_IS_TEXTURE_LOADER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), LW_TYPE_TEXTURE_LOADER))
+#define LW_TEXTURE_LOADER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), LW_TYPE_TEXTURE_LOADER, LwTextureLoaderClass))
+
+typedef struct _LwTextureLoader LwTextureLoader;
+typedef struct _LwTextureLoaderClass LwTextureLoaderClass;
+
+typedef struct _LwTextureLoaderPrivate LwTextureLoaderPrivate;
+
+/**
+ * LwTextureDecodeFunc:
+ * @data: The data passed to lw_texture_loader_load_into()
+ * @error: Return location for a #GError
+ *
+ * Creates the image of a texture. It is called on a thread of the loader and must
+ * not use OpenGL.
+ *
+ * Returns: The new image or %NULL with @error set
+ *
+ * Since: 0.6
+ */
+typedef GdkPixbuf *(*LwTextureDecodeFunc)(gpointer data, GError **error);
+
+struct _LwTextureLoader
+{
+	/*< private >*/
+	GObject parent_instance;
+
+	LwTextureLoaderPrivate *priv;
+};
+
+struct _LwTextureLoaderClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+};
+
+GType lw_texture_loader_get_type(void);
+
+LwTextureLoader *lw_texture_loader_get_default(void);
+
+LwTexture *lw_texture_loader_load_file(LwTextureLoader *self, const gchar *path, LwTextureFlags flags);
+LwTexture *lw_texture_loader_load_resource(LwTextureLoader *self, const gchar *path, LwTextureFlags flags);
+void lw_texture_loader_load_into(LwTextureLoader *self, LwTexture *texture,
+                                 LwTextureDecodeFunc func, gpointer data,
+                                 GDestroyNotify notify, LwTextureFlags flags);
+
+void lw_texture_loader_process(LwTextureLoader *self);
+gboolean lw_texture_loader_is_busy(LwTextureLoader *self);
+
+G_END_DECLS
+
+#endif /* _LW_TEXTURE_LOADER_H_ */
+
@@ -33,6 +33,14 @@ G_BEGIN_DECLS
 #define LW_TEX_COORD_XY(m, px, py) ((m).xx * (px) + (m).xy * (py) + (m).x0)
 #define LW_TEX_COORD_YX(m, px, py) ((m).yx * (px) + (m).yy * (py) + (m).y0)
 
+typedef enum
+{
+	LW_TEXTURE_FLAGS_NONE        = 0,
+	LW_TEXTURE_FLAGS_MIPMAP      = 1 << 0,
+	LW_TEXTURE_FLAGS_ANISOTROPIC = 1 << 1,
+	LW_TEXTURE_FLAGS_COMPRESSED  = 1 << 2
+} LwTextureFlags;
+
 typedef struct _LwTextureMatrix LwTextureMatrix;
 
 struct _LwTextureMatrix
@@ -76,9 +84,13 @@ LwTexture *lw_texture_new_from_resource (const gchar *path);
 LwTexture *lw_texture_new_from_file(const gchar *path);
 LwTexture *lw_texture_new_from_pixbuf(GdkPixbuf *pixbuf);
 LwTexture *lw_texture_new_from_data(const guchar *data, guint width, guint height, guint format, guint type);
+LwTexture *lw_texture_new_from_data_with_flags(const guchar *data, guint width, guint height, guint format, guint type, LwTextureFlags flags);
+
+guint lw_texture_get_internal_format(guint format, LwTextureFlags flags);
 
 guint lw_texture_get_name(LwTexture *self);
 guint lw_texture_get_target(LwTexture *self);
+LwTextureFlags lw_texture_get_flags(LwTexture *self);
 
 void lw_texture_set_filter(LwTexture *self, guint filter);
 guint lw_texture_get_filter(LwTexture *self);
@@ -89,6 +101,8 @@ guint lw_texture_get_wrap(LwTexture *self);
 guint lw_texture_get_width(LwTexture *self);
 guint lw_texture_get_height(LwTexture *self);
 
+void lw_texture_replace(LwTexture *self, guint name, guint width, guint height, LwTextureFlags flags);
+
 void lw_texture_enable(LwTexture *self);
 void lw_texture_disable(LwTexture *self);
 
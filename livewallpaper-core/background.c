@@ -123,6 +123,25 @@ G_DEFINE_TYPE(LwBackground, lw_background, G_TYPE_OBJECT)
 
 static void lw_background_changed(GSettings *settings, G_GNUC_UNUSED gchar *key, LwBackground *self);
 
+/* Background images are often drawn smaller than their size, so they use mipmaps
+ * and trilinear filtering to avoid aliasing */
+static LwTexture*
+load_image_texture(const gchar *path, gboolean is_resource, LwTextureFlags flags)
+{
+	LwTexture *texture;
+
+	flags |= LW_TEXTURE_FLAGS_MIPMAP | LW_TEXTURE_FLAGS_ANISOTROPIC;
+
+	if(is_resource)
+		texture = lw_texture_loader_load_resource(lw_texture_loader_get_default(), path, flags);
+	else
+		texture = lw_texture_loader_load_file(lw_texture_loader_get_default(), path, flags);
+
+	lw_texture_set_filter(texture, GL_LINEAR);
+
+	return texture;
+}
+
 /**
  * lw_background_new_from_file:
  * @path: Name of the default background image
@@ -131,6 +150,8 @@ static void lw_background_changed(GSettings *settings, G_GNUC_UNUSED gchar *key,
  * Creates a new #LwBackground with an default background image.
  * Note that the background you set won't be necessary the one displayed,
  * it can be overrided by the user's configuration.
+ *
+ * The image is loaded asynchronously by the default #LwTextureLoader.
  * 
  * Returns: A new #LwBackground. Use g_object_unref() to free the #LwBackground.
  *
@@ -139,7 +160,7 @@ static void lw_background_changed(GSettings *settings, G_GNUC_UNUSED gchar *key,
 LwBackground*
 lw_background_new_from_file (const gchar *path, LwBackgroundRenderType type)
 {
-    LwTexture *texture = lw_texture_new_from_file(path);
+	LwTexture *texture = load_image_texture(path, FALSE, LW_TEXTURE_FLAGS_NONE);
 	return lw_background_new_from_texture(texture, type);
 }
 
@@ -152,6 +173,8 @@ lw_background_new_from_file (const gchar *path, LwBackgroundRenderType type)
  * Note that the background you set won't be necessary the one displayed,
  * it can be overrided by the user's configuration.
  *
+ * The image is loaded asynchronously by the default #LwTextureLoader.
+ *
  * Returns: A new #LwBackground. Use g_object_unref() to free the #LwBackground.
  *
  * Since: 0.5
@@ -160,7 +183,7 @@ LwBackground*
 lw_background_new_from_resource (const gchar *path,
                                  LwBackgroundRenderType type)
 {
-	LwTexture *texture = lw_texture_new_from_resource (path);
+	LwTexture *texture = load_image_texture(path, TRUE, LW_TEXTURE_FLAGS_NONE);
 	return lw_background_new_from_texture(texture, type);
 }
 
@@ -439,8 +462,9 @@ lw_background_draw(LwBackground *self, LwOutput *output)
 		}
 	}
 
-	/* Draw background */
+	/* Draw background. The fixed function pipeline samples texture unit 0. */
 	glColor3f(1.0f, 1.0f, 1.0f);
+	lw_gl_state_active_texture(0);
 	lw_texture_enable(tex);
 
 	glBegin(GL_QUADS);
@@ -488,9 +512,11 @@ lw_background_changed(GSettings *settings, G_GNUC_UNUSED gchar *key, LwBackgroun
 	{
 		case LwBackgroundCustomImage:
 		{
-			/* Load image */
+			/* Load image, custom images are usually photos in screen resolution
+			 * or above, so they are compressed as well */
 			if (self->priv->image[0] != '\0')
-				self->priv->bg_texture = lw_texture_new_from_file(self->priv->image);
+				self->priv->bg_texture = load_image_texture(self->priv->image, FALSE,
+				                                            LW_TEXTURE_FLAGS_COMPRESSED);
 
 			self->priv->bg_render_type = self->priv->render_type;
 			break;
@@ -227,7 +227,7 @@ lw_buffer_get_size(LwBuffer *self)
 void
 lw_buffer_bind(LwBuffer *self)
 {
-	LW_OPENGL_1_4_HELPER(glBindBuffer, glBindBufferARB, (self->priv->target, self->priv->name));
+	lw_gl_state_bind_buffer(self->priv->target, self->priv->name);
 }
 
 /**
@@ -244,7 +244,7 @@ lw_buffer_bind(LwBuffer *self)
 void
 lw_buffer_unbind(LwBuffer *self)
 {
-	LW_OPENGL_1_4_HELPER(glBindBuffer, glBindBufferARB, (self->priv->target, 0));
+	lw_gl_state_bind_buffer(self->priv->target, 0);
 }
 
 /**
@@ -310,6 +310,40 @@ lw_buffer_set_sub_data(LwBuffer *self, guint offset, guint size, gpointer data)
 	LW_OPENGL_1_4_HELPER(glBufferSubData, glBufferSubDataARB, (self->priv->target, offset, size, data));
 }
 
+/**
+ * lw_buffer_stream_data:
+ * @self: A #LwBuffer
+ * @size: The size of the new data in bytes
+ * @data: (element-type char) (array length=size): A pointer to the data that will be copied into the buffer's data store
+ *
+ * Replaces the whole data store of the buffer with @size bytes from @data. Use this function
+ * for data that changes every frame, the buffer should be created with GL_STREAM_DRAW.
+ *
+ * Unlike lw_buffer_set_sub_data() this function orphans the old data store first, so
+ * OpenGL can allocate a new one instead of waiting for draw calls that still use the
+ * old data. Upload the data once per frame and draw it for every output.
+ *
+ * <note>
+ *   <para>
+ *      This method binds the buffer using lw_buffer_bind(), but does not unbind it. After this operation
+ *      this #LwBuffer is still bound to its target.
+ *   </para>
+ * </note>
+ *
+ * Since: 0.6
+ */
+void
+lw_buffer_stream_data(LwBuffer *self, guint size, gpointer data)
+{
+	g_return_if_fail(data != NULL);
+
+	lw_buffer_bind(self);
+	LW_OPENGL_1_4_HELPER(glBufferData, glBufferDataARB, (self->priv->target, size, NULL, self->priv->usage));
+	LW_OPENGL_1_4_HELPER(glBufferSubData, glBufferSubDataARB, (self->priv->target, 0, size, data));
+
+	self->priv->size = size;
+}
+
 /**
  * lw_buffer_get_data:
  * @self: A #LwBuffer
@@ -358,7 +392,10 @@ lw_buffer_finalize(GObject *object)
 	LwBuffer *self = LW_BUFFER(object);
 
 	if(self->priv->name)
+	{
+		lw_gl_state_forget_buffer(self->priv->name);
 		LW_OPENGL_1_4_HELPER(glDeleteBuffers, glDeleteBuffersARB, (1, &(self->priv->name)));
+	}
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(lw_buffer_parent_class)->finalize(object);
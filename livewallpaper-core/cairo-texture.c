@@ -51,8 +51,18 @@
  * lw_texture_enable( LW_TEXTURE(tex) );
  * ...</programlisting>
  * </example>
+ *
+ * If you only draw onto a small part of the texture, tell the texture about it with
+ * lw_cairo_texture_mark_dirty() before calling lw_cairo_texture_update(). Only the
+ * dirty parts are uploaded then. Uploads go through two alternating pixel unpack
+ * buffers if they are supported, so an update never waits for the previous one.
+ *
+ * Textures which are drawn once and never touched again should be frozen with
+ * lw_cairo_texture_freeze(). This uploads them and frees the memory used by the
+ * cairo surface.
  */
 
+#include <string.h>
 #include <livewallpaper/core.h>
 
 
@@ -60,6 +70,14 @@ struct _LwCairoTexturePrivate
 {
 	cairo_surface_t *surf;
 	guchar *surf_data;
+
+	/* Parts changed since the last update, the whole surface if empty */
+	cairo_region_t *dirty;
+	gboolean allocated;
+
+	/* Pixel unpack buffers used alternately, 0 if not supported */
+	guint pbos[2];
+	guint current_pbo;
 };
 
 /**
@@ -118,6 +136,48 @@ lw_cairo_texture_new(guint width, guint height)
 	return NULL;
 }
 
+static void
+lw_cairo_texture_create_pbos(LwCairoTexture *self)
+{
+	/* Pixel buffer objects are core since OpenGL 2.1 */
+	if(GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)
+		LW_OPENGL_1_4_HELPER(glGenBuffers, glGenBuffersARB, (2, self->priv->pbos));
+}
+
+static void
+lw_cairo_texture_delete_pbos(LwCairoTexture *self)
+{
+	if(self->priv->pbos[0])
+	{
+		lw_gl_state_forget_buffer(self->priv->pbos[0]);
+		lw_gl_state_forget_buffer(self->priv->pbos[1]);
+		LW_OPENGL_1_4_HELPER(glDeleteBuffers, glDeleteBuffersARB, (2, self->priv->pbos));
+		self->priv->pbos[0] = self->priv->pbos[1] = 0;
+	}
+}
+
+/* Recreates the surface of a frozen texture from the texture's content */
+static void
+lw_cairo_texture_thaw(LwCairoTexture *self)
+{
+	LwTexture *tex = LW_TEXTURE(self);
+	guint width = lw_texture_get_width(tex);
+	guint height = lw_texture_get_height(tex);
+
+	self->priv->surf_data = g_malloc(4 * width * height);
+
+	lw_gl_state_bind_texture(lw_texture_get_target(tex),
+	                         lw_texture_get_name(tex));
+	glGetTexImage(lw_texture_get_target(tex), 0, GL_BGRA, GL_UNSIGNED_BYTE, self->priv->surf_data);
+
+	self->priv->surf = cairo_image_surface_create_for_data(self->priv->surf_data,
+	                                                       CAIRO_FORMAT_ARGB32,
+	                                                       width, height,
+	                                                       4 * width);
+
+	lw_cairo_texture_create_pbos(self);
+}
+
 /**
  * lw_cairo_texture_cairo_create:
  * @self: A #LwCairoTexture
@@ -125,37 +185,217 @@ lw_cairo_texture_new(guint width, guint height)
  * Creates a cairo context for drawing to the texture. Call lw_cairo_texture_update()
  * to update the texture when you are done with drawing.
  *
+ * If the texture has been frozen with lw_cairo_texture_freeze(), the cairo surface
+ * is recreated from the texture's content first.
+ *
  * Returns: A newly created cairo context. Free it with cairo_destroy() when you are done with drawing.
  */
 cairo_t*
 lw_cairo_texture_cairo_create(LwCairoTexture *self)
 {
+	if(self->priv->surf == NULL)
+		lw_cairo_texture_thaw(self);
+
 	return cairo_create(self->priv->surf);
 }
 
+/**
+ * lw_cairo_texture_freeze:
+ * @self: A #LwCairoTexture
+ *
+ * Uploads pending changes and frees the cairo surface and its memory. Use this
+ * for textures that you don't draw on anymore. The texture itself stays usable.
+ * If you call lw_cairo_texture_cairo_create() later on, the surface gets
+ * recreated with the texture's content.
+ *
+ * Since: 0.6
+ */
+void
+lw_cairo_texture_freeze(LwCairoTexture *self)
+{
+	if(self->priv->surf == NULL)
+		return;
+
+	lw_cairo_texture_update(self);
+
+	cairo_surface_destroy(self->priv->surf);
+	self->priv->surf = NULL;
+
+	g_free(self->priv->surf_data);
+	self->priv->surf_data = NULL;
+
+	lw_cairo_texture_delete_pbos(self);
+}
+
+/**
+ * lw_cairo_texture_mark_dirty:
+ * @self: A #LwCairoTexture
+ * @x: X coordinate of the changed rectangle
+ * @y: Y coordinate of the changed rectangle
+ * @width: Width of the changed rectangle
+ * @height: Height of the changed rectangle
+ *
+ * Marks a part of the surface as changed. The next lw_cairo_texture_update() only
+ * uploads the parts marked since the last update. If nothing has been marked, the
+ * whole surface is uploaded.
+ *
+ * Since: 0.6
+ */
+void
+lw_cairo_texture_mark_dirty(LwCairoTexture *self, gint x, gint y, gint width, gint height)
+{
+	cairo_rectangle_int_t rect;
+
+	rect.x = x;
+	rect.y = y;
+	rect.width = width;
+	rect.height = height;
+
+	cairo_region_union_rectangle(self->priv->dirty, &rect);
+}
+
+/* Uploads the dirty rectangles straight out of the surface */
+static void
+lw_cairo_texture_upload_direct(LwCairoTexture *self)
+{
+	LwTexture *tex = LW_TEXTURE(self);
+	guint width = lw_texture_get_width(tex);
+	gint i, n = cairo_region_num_rectangles(self->priv->dirty);
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+
+	for(i = 0; i < n; i++)
+	{
+		cairo_rectangle_int_t rect;
+
+		cairo_region_get_rectangle(self->priv->dirty, i, &rect);
+		glTexSubImage2D(lw_texture_get_target(tex), 0,
+		                rect.x, rect.y, rect.width, rect.height,
+		                GL_BGRA, GL_UNSIGNED_BYTE,
+		                self->priv->surf_data + 4 * (rect.y * width + rect.x));
+	}
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+/* Copies the dirty rectangles into the next pixel unpack buffer and uploads them from there */
+static void
+lw_cairo_texture_upload_through_pbo(LwCairoTexture *self)
+{
+	LwTexture *tex = LW_TEXTURE(self);
+	guint stride = 4 * lw_texture_get_width(tex);
+	gint i, y, n = cairo_region_num_rectangles(self->priv->dirty);
+	cairo_rectangle_int_t rect;
+	gsize size = 0, offset;
+	guchar *dst;
+
+	for(i = 0; i < n; i++)
+	{
+		cairo_region_get_rectangle(self->priv->dirty, i, &rect);
+		size += 4 * rect.width * rect.height;
+	}
+
+	/* The other buffer might still be read by the previous update */
+	self->priv->current_pbo = !self->priv->current_pbo;
+	lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, self->priv->pbos[self->priv->current_pbo]);
+
+	LW_OPENGL_1_4_HELPER(glBufferData, glBufferDataARB, (GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW));
+	dst = LW_OPENGL_1_4_HELPER(glMapBuffer, glMapBufferARB, (GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+
+	if(dst == NULL)
+	{
+		lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		lw_cairo_texture_upload_direct(self);
+		return;
+	}
+
+	/* Pack the rectangles one after another */
+	for(i = 0, offset = 0; i < n; i++)
+	{
+		cairo_region_get_rectangle(self->priv->dirty, i, &rect);
+
+		for(y = 0; y < rect.height; y++)
+			memcpy(dst + offset + 4 * rect.width * y,
+			       self->priv->surf_data + (rect.y + y) * stride + 4 * rect.x,
+			       4 * rect.width);
+
+		offset += 4 * rect.width * rect.height;
+	}
+
+	LW_OPENGL_1_4_HELPER(glUnmapBuffer, glUnmapBufferARB, (GL_PIXEL_UNPACK_BUFFER));
+
+	/* The data pointers are offsets into the pixel unpack buffer */
+	for(i = 0, offset = 0; i < n; i++)
+	{
+		cairo_region_get_rectangle(self->priv->dirty, i, &rect);
+		glTexSubImage2D(lw_texture_get_target(tex), 0,
+		                rect.x, rect.y, rect.width, rect.height,
+		                GL_BGRA, GL_UNSIGNED_BYTE,
+		                GSIZE_TO_POINTER(offset));
+
+		offset += 4 * rect.width * rect.height;
+	}
+
+	lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 /**
  * lw_cairo_texture_update:
  * @self: A #LwCairoTexture
  *
- * Updates the texture.
+ * Updates the texture. Only the parts marked by lw_cairo_texture_mark_dirty()
+ * are uploaded, or the whole surface if nothing has been marked. Does nothing
+ * if the texture is frozen.
  */
 void
 lw_cairo_texture_update(LwCairoTexture *self)
 {
 	LwTexture *tex = LW_TEXTURE(self);
+	cairo_rectangle_int_t bounds;
+
+	if(self->priv->surf == NULL)
+		return;
+
+	bounds.x = 0;
+	bounds.y = 0;
+	bounds.width = lw_texture_get_width(tex);
+	bounds.height = lw_texture_get_height(tex);
 
-	glBindTexture(lw_texture_get_target(tex),
-	              lw_texture_get_name(tex));
-
-	glTexImage2D(lw_texture_get_target(tex),
-	             0,
-	             GL_RGBA,
-	             lw_texture_get_width(tex),
-	             lw_texture_get_height(tex),
-	             0,
-	             GL_BGRA,
-	             GL_UNSIGNED_BYTE,
-	             self->priv->surf_data);
+	cairo_surface_flush(self->priv->surf);
+
+	lw_gl_state_bind_texture(lw_texture_get_target(tex),
+	                         lw_texture_get_name(tex));
+
+	if(!self->priv->allocated)
+	{
+		/* Allocate the texture's storage with the first update */
+		glTexImage2D(lw_texture_get_target(tex),
+		             0,
+		             GL_RGBA,
+		             bounds.width,
+		             bounds.height,
+		             0,
+		             GL_BGRA,
+		             GL_UNSIGNED_BYTE,
+		             self->priv->surf_data);
+
+		self->priv->allocated = TRUE;
+	}
+	else
+	{
+		if(cairo_region_is_empty(self->priv->dirty))
+			cairo_region_union_rectangle(self->priv->dirty, &bounds);
+		else
+			cairo_region_intersect_rectangle(self->priv->dirty, &bounds);
+
+		if(self->priv->pbos[0])
+			lw_cairo_texture_upload_through_pbo(self);
+		else
+			lw_cairo_texture_upload_direct(self);
+	}
+
+	cairo_region_destroy(self->priv->dirty);
+	self->priv->dirty = cairo_region_create();
 }
 
 static void
@@ -166,6 +406,13 @@ lw_cairo_texture_init(LwCairoTexture *self)
 
 	self->priv->surf = NULL;
 	self->priv->surf_data = NULL;
+
+	self->priv->dirty = cairo_region_create();
+	self->priv->allocated = FALSE;
+
+	self->priv->pbos[0] = self->priv->pbos[1] = 0;
+	self->priv->current_pbo = 0;
+	lw_cairo_texture_create_pbos(self);
 }
 
 static void
@@ -185,6 +432,14 @@ lw_cairo_texture_finalize(GObject *object)
 		self->priv->surf_data = NULL;
 	}
 
+	if(self->priv->dirty)
+	{
+		cairo_region_destroy(self->priv->dirty);
+		self->priv->dirty = NULL;
+	}
+
+	lw_cairo_texture_delete_pbos(self);
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(lw_cairo_texture_parent_class)->finalize(object);
 }
@@ -0,0 +1,427 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ * Copyright (C) 2012-2016 Aurélien   Rivière <aurelien.riv@gmail.com>
+ *
+ */
+
+/**
+ * SECTION: colorized-texture
+ * @Short_description: colors a texture with a radial gradient
+ *
+ * A #LwColorizedTexture keeps the lightness of every texel of a source texture
+ * and replaces hue and saturation by a radial gradient from
+ * #LwColorizedTexture:inner-color in the center to #LwColorizedTexture:outer-color
+ * towards the edges. The galaxy plugins use it to color their light image.
+ *
+ * The colors are baked into a texture by the default #LwJobSystem whenever a
+ * property has changed, so the result is drawn like any other texture. The
+ * lightness is read back from the source texture once its image is available,
+ * so a texture of the #LwTextureCache can be passed without decoding the image
+ * again. If the image of the source is replaced, the lightness is read again.
+ *
+ * <example>
+ *   <title>Coloring a light image</title>
+ *   <programlisting>
+ * // In init_plugin
+ * light = lw_texture_cache_load_resource(lw_texture_cache_get_default(), path,
+ *                                        GL_NEAREST, GL_CLAMP_TO_EDGE, LW_TEXTURE_FLAGS_NONE);
+ * colorized = lw_colorized_texture_new(light);
+ * lw_settings_bind_color(settings, "inner-color", colorized, "inner-color", G_SETTINGS_BIND_GET);
+ *
+ * // In paint
+ * texture = lw_colorized_texture_get_texture(colorized);
+ * lw_texture_enable(texture != NULL ? texture : light);</programlisting>
+ * </example>
+ */
+
+#include <math.h>
+#include <livewallpaper/core.h>
+
+/*
+ * (max + min) of the color channels of a texel is between 0 and 510, so the
+ * colors are looked up in tables instead of converting HSL for every texel.
+ */
+#define LIGHTNESS_STEPS 511
+
+/* Rows of the texture baked at once */
+#define BAKE_GRAIN 16
+
+struct _LwColorizedTexturePrivate
+{
+	LwTexture *source;
+	gulong source_handler_id;
+
+	/* (max + min) of every texel of the source, read on the first bake */
+	guint16 *lightness;
+	guint width;
+	guint height;
+
+	LwHSL *outer_color;
+	LwHSL *inner_color;
+
+	gdouble color_radius;
+
+	/* The colorized source, baked again when a property changes */
+	LwTexture *texture;
+	gboolean dirty;
+};
+
+/* One bake shared by all threads working on it */
+typedef struct
+{
+	LwColorizedTexturePrivate *priv;
+	guchar *pixels;
+
+	gfloat inner[LIGHTNESS_STEPS][3];
+	gfloat outer[LIGHTNESS_STEPS][3];
+} LwColorizedTextureBake;
+
+enum
+{
+	PROP_0,
+
+	PROP_OUTER_COLOR,
+	PROP_INNER_COLOR,
+
+	PROP_COLOR_RADIUS,
+
+	N_PROPERTIES
+};
+
+static GParamSpec *obj_properties[N_PROPERTIES] = {NULL, };
+
+/**
+ * LwColorizedTexture:
+ *
+ * Colors a texture with a radial gradient.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwColorizedTexture, lw_colorized_texture, G_TYPE_OBJECT)
+
+/* Forgets the lightness when the texture loader replaces the image of the source */
+static void
+lw_colorized_texture_source_changed(LwColorizedTexture *self)
+{
+	g_free(self->priv->lightness);
+	self->priv->lightness = NULL;
+	self->priv->dirty = TRUE;
+}
+
+/**
+ * lw_colorized_texture_new:
+ * @source: The #LwTexture whose lightness is used
+ *
+ * Creates a new #LwColorizedTexture for @source. Inner and outer color are white
+ * until they are set.
+ *
+ * Returns: A new #LwColorizedTexture. Use g_object_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwColorizedTexture*
+lw_colorized_texture_new(LwTexture *source)
+{
+	LwColorizedTexture *self = g_object_new(LW_TYPE_COLORIZED_TEXTURE, NULL);
+
+	self->priv->source = g_object_ref(source);
+	self->priv->source_handler_id = g_signal_connect_swapped(source, "notify::width",
+	                                                         G_CALLBACK(lw_colorized_texture_source_changed),
+	                                                         self);
+
+	return self;
+}
+
+static void
+lw_colorized_texture_set_property(GObject *object,
+                                  guint property_id,
+                                  const GValue *value,
+                                  GParamSpec *pspec)
+{
+	LwColorizedTexture *self = LW_COLORIZED_TEXTURE(object);
+
+	switch(property_id)
+	{
+		case PROP_OUTER_COLOR:
+			lw_hsl_free(self->priv->outer_color);
+			self->priv->outer_color = lw_rgb_to_hsl(g_value_get_boxed(value));
+			break;
+
+		case PROP_INNER_COLOR:
+			lw_hsl_free(self->priv->inner_color);
+			self->priv->inner_color = lw_rgb_to_hsl(g_value_get_boxed(value));
+			break;
+
+		case PROP_COLOR_RADIUS:
+			self->priv->color_radius = g_value_get_double(value);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+			return;
+	}
+
+	self->priv->dirty = TRUE;
+}
+
+static void
+lw_colorized_texture_get_property(GObject *object,
+                                  guint property_id,
+                                  GValue *value,
+                                  GParamSpec *pspec)
+{
+	LwColorizedTexture *self = LW_COLORIZED_TEXTURE(object);
+
+	switch(property_id)
+	{
+		case PROP_OUTER_COLOR:
+			g_value_take_boxed(value, lw_hsl_to_rgb(self->priv->outer_color));
+			break;
+
+		case PROP_INNER_COLOR:
+			g_value_take_boxed(value, lw_hsl_to_rgb(self->priv->inner_color));
+			break;
+
+		case PROP_COLOR_RADIUS:
+			g_value_set_double(value, self->priv->color_radius);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+			break;
+	}
+}
+
+/* Reads the lightness of the source back from OpenGL, the image is not decoded again */
+static gboolean
+lw_colorized_texture_read_source(LwColorizedTexture *self)
+{
+	LwColorizedTexturePrivate *priv = self->priv;
+	guchar *pixels;
+	guint i;
+
+	/* A texture that is still being loaded holds a placeholder of one texel */
+	priv->width = lw_texture_get_width(priv->source);
+	priv->height = lw_texture_get_height(priv->source);
+	if(priv->width <= 1 && priv->height <= 1)
+		return FALSE;
+
+	pixels = g_malloc(4 * priv->width * priv->height);
+	lw_texture_bind(priv->source);
+	glGetTexImage(lw_texture_get_target(priv->source), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	priv->lightness = g_new(guint16, priv->width * priv->height);
+	for(i = 0; i < priv->width * priv->height; i++)
+	{
+		const guchar *p = pixels + 4 * i;
+
+		priv->lightness[i] = MAX(p[0], MAX(p[1], p[2])) + MIN(p[0], MIN(p[1], p[2]));
+	}
+
+	g_free(pixels);
+
+	return TRUE;
+}
+
+/* Fills a table with the color for every lightness of the source */
+static void
+lw_colorized_texture_fill_table(gfloat table[LIGHTNESS_STEPS][3], const LwHSL *color)
+{
+	LwHSL hsl = *color;
+	guint i;
+
+	for(i = 0; i < LIGHTNESS_STEPS; i++)
+	{
+		GdkRGBA *rgb;
+
+		hsl.lightness = i / (LIGHTNESS_STEPS - 1.0);
+		rgb = lw_hsl_to_rgb(&hsl);
+		table[i][0] = rgb->red;
+		table[i][1] = rgb->green;
+		table[i][2] = rgb->blue;
+		gdk_rgba_free(rgb);
+	}
+}
+
+/* Bakes some rows of the texture, called from several threads at once */
+static void
+lw_colorized_texture_bake_rows(guint first, guint count, gpointer data)
+{
+	LwColorizedTextureBake *bake = data;
+	LwColorizedTexturePrivate *priv = bake->priv;
+	guint x, y;
+
+	for(y = first; y < first + count; y++)
+	{
+		gfloat dy = (y + 0.5f) / priv->height - 0.5f;
+
+		for(x = 0; x < priv->width; x++)
+		{
+			gfloat dx = (x + 0.5f) / priv->width - 0.5f;
+			guint i = y * priv->width + x, l = priv->lightness[i], c;
+
+			/* Mix between inner and outer color */
+			gfloat radius = 2.0f * sqrt(dx * dx + dy * dy) * priv->color_radius;
+
+			for(c = 0; c < 3; c++)
+			{
+				gfloat v = bake->inner[l][c] + radius * (bake->outer[l][c] - bake->inner[l][c]);
+				bake->pixels[4 * i + c] = CLAMP(v, 0.0f, 1.0f) * 255.0f + 0.5f;
+			}
+			bake->pixels[4 * i + 3] = 255;
+		}
+	}
+}
+
+static void
+lw_colorized_texture_bake(LwColorizedTexture *self)
+{
+	LwColorizedTextureBake *bake = g_new(LwColorizedTextureBake, 1);
+
+	bake->priv = self->priv;
+	bake->pixels = g_malloc(4 * self->priv->width * self->priv->height);
+	lw_colorized_texture_fill_table(bake->inner, self->priv->inner_color);
+	lw_colorized_texture_fill_table(bake->outer, self->priv->outer_color);
+
+	lw_job_system_parallel_for(lw_job_system_get_default(), self->priv->height, BAKE_GRAIN,
+	                           lw_colorized_texture_bake_rows, bake);
+
+	g_clear_object(&self->priv->texture);
+	self->priv->texture = lw_texture_new_from_data(bake->pixels, self->priv->width, self->priv->height,
+	                                               GL_RGBA, GL_UNSIGNED_BYTE);
+
+	g_free(bake->pixels);
+	g_free(bake);
+}
+
+/**
+ * lw_colorized_texture_get_texture:
+ * @self: A #LwColorizedTexture
+ *
+ * Returns the colorized texture and bakes it first if a property has changed.
+ * Call it with a current OpenGL context.
+ *
+ * Returns: (transfer none): The colorized texture or %NULL if the image of the
+ *          source has not been loaded yet
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_colorized_texture_get_texture(LwColorizedTexture *self)
+{
+	if(!self->priv->dirty)
+		return self->priv->texture;
+
+	if(self->priv->lightness == NULL && !lw_colorized_texture_read_source(self))
+		return NULL;
+
+	self->priv->dirty = FALSE;
+	lw_colorized_texture_bake(self);
+
+	return self->priv->texture;
+}
+
+static void
+lw_colorized_texture_init(LwColorizedTexture *self)
+{
+	LwHSL color = {1.0, 1.0, 1.0};
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_COLORIZED_TEXTURE,
+	                                         LwColorizedTexturePrivate);
+
+	self->priv->source = NULL;
+	self->priv->outer_color = lw_hsl_copy(&color);
+	self->priv->inner_color = lw_hsl_copy(&color);
+	self->priv->color_radius = 1.0;
+
+	self->priv->lightness = NULL;
+	self->priv->texture = NULL;
+	self->priv->dirty = TRUE;
+}
+
+static void
+lw_colorized_texture_dispose(GObject *object)
+{
+	LwColorizedTexture *self = LW_COLORIZED_TEXTURE(object);
+
+	if(self->priv->source != NULL)
+		g_signal_handler_disconnect(self->priv->source, self->priv->source_handler_id);
+
+	g_clear_object(&self->priv->source);
+	g_clear_object(&self->priv->texture);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_colorized_texture_parent_class)->dispose(object);
+}
+
+static void
+lw_colorized_texture_finalize(GObject *object)
+{
+	LwColorizedTexture *self = LW_COLORIZED_TEXTURE(object);
+
+	lw_hsl_free(self->priv->outer_color);
+	lw_hsl_free(self->priv->inner_color);
+	g_free(self->priv->lightness);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_colorized_texture_parent_class)->finalize(object);
+}
+
+static void
+lw_colorized_texture_class_init(LwColorizedTextureClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->set_property = lw_colorized_texture_set_property;
+	gobject_class->get_property = lw_colorized_texture_get_property;
+	gobject_class->dispose = lw_colorized_texture_dispose;
+	gobject_class->finalize = lw_colorized_texture_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwColorizedTexturePrivate));
+
+	/**
+	 * LwColorizedTexture:outer-color:
+	 *
+	 * Color at the edges of the texture if #LwColorizedTexture:color-radius is 1.0
+	 *
+	 * Since: 0.6
+	 */
+	obj_properties[PROP_OUTER_COLOR] = g_param_spec_boxed("outer-color", "Outer Color", "Color at the edges of the texture", GDK_TYPE_RGBA, G_PARAM_READWRITE);
+
+	/**
+	 * LwColorizedTexture:inner-color:
+	 *
+	 * Color in the center of the texture
+	 *
+	 * Since: 0.6
+	 */
+	obj_properties[PROP_INNER_COLOR] = g_param_spec_boxed("inner-color", "Inner Color", "Color in the center of the texture", GDK_TYPE_RGBA, G_PARAM_READWRITE);
+
+	/**
+	 * LwColorizedTexture:color-radius:
+	 *
+	 * Scales the gradient. At 1.0 it reaches the outer color at the edges of the
+	 * texture, at higher values closer to the center.
+	 *
+	 * Since: 0.6
+	 */
+	obj_properties[PROP_COLOR_RADIUS] = g_param_spec_double("color-radius", "Color radius", "Radius of the radial color gradient", 0.0, 2.0, 1.0, G_PARAM_READWRITE);
+
+	g_object_class_install_properties(gobject_class, N_PROPERTIES, obj_properties);
+}
@@ -0,0 +1,281 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: flow-field
+ * @Short_description: simplex noise sampled into a grid of directions
+ *
+ * A #LwFlowField samples lw_simplex_noise_2f() once on a grid covering a
+ * rectangle. For every grid point it stores the noise value and the unit vector
+ * pointing in the direction of the angle 2 * pi times the noise value.
+ *
+ * lw_flow_field_sample() interpolates these values bilinearly, which costs a
+ * few multiply-adds instead of a noise evaluation plus lw_sin() and lw_cos().
+ * This makes it well suited to move many particles along the noise field.
+ *
+ * The grid is filled row by row in a background thread. Until a row is ready,
+ * lw_flow_field_sample() evaluates the noise directly at positions that need
+ * it, so a new field can be used right away.
+ */
+
+#include <livewallpaper/core.h>
+
+/* Every grid point holds the direction x, the direction y and the noise value */
+#define NODE_SIZE 3
+
+struct _LwFlowFieldPrivate
+{
+	/* The rectangle covered by the grid */
+	gfloat x, y;
+	gfloat width, height;
+
+	/* Number of grid points and grid points per unit */
+	guint columns, rows;
+	gfloat scale_x, scale_y;
+
+	gfloat *nodes;
+
+	/* Number of rows filled by the thread, accessed atomically */
+	gint rows_ready;
+	gint cancelled;
+	GThread *thread;
+};
+
+/**
+ * LwFlowField:
+ *
+ * A grid of directions sampled from simplex noise.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwFlowField, lw_flow_field, G_TYPE_OBJECT)
+
+static gpointer
+lw_flow_field_fill(gpointer data)
+{
+	LwFlowField *self = LW_FLOW_FIELD(data);
+	LwFlowFieldPrivate *priv = self->priv;
+	gfloat *xs = g_new(gfloat, priv->columns);
+	gfloat *ys = g_new(gfloat, priv->columns);
+	gfloat *noise = g_new(gfloat, priv->columns);
+	gfloat *angle = g_new(gfloat, priv->columns);
+	gfloat *sines = g_new(gfloat, priv->columns);
+	gfloat *cosines = g_new(gfloat, priv->columns);
+	guint r, c;
+
+	for(c = 0; c < priv->columns; c++)
+		xs[c] = priv->x + c / priv->scale_x;
+
+	for(r = 0; r < priv->rows && !g_atomic_int_get(&priv->cancelled); r++)
+	{
+		gfloat *node = priv->nodes + NODE_SIZE * r * priv->columns;
+
+		for(c = 0; c < priv->columns; c++)
+			ys[c] = priv->y + r / priv->scale_y;
+
+		lw_simplex_noise_2f_batch(xs, ys, noise, priv->columns);
+
+		for(c = 0; c < priv->columns; c++)
+			angle[c] = LW_2PI * noise[c];
+
+		lw_sincos_batch(angle, sines, cosines, priv->columns);
+
+		for(c = 0; c < priv->columns; c++, node += NODE_SIZE)
+		{
+			node[0] = cosines[c];
+			node[1] = sines[c];
+			node[2] = noise[c];
+		}
+
+		/* Publish the row, the atomic operation is a full memory barrier */
+		g_atomic_int_set(&priv->rows_ready, r + 1);
+	}
+
+	g_free(xs);
+	g_free(ys);
+	g_free(noise);
+	g_free(angle);
+	g_free(sines);
+	g_free(cosines);
+
+	return NULL;
+}
+
+/**
+ * lw_flow_field_new:
+ * @x: Left border of the covered rectangle
+ * @y: Bottom border of the covered rectangle
+ * @width: Width of the covered rectangle
+ * @height: Height of the covered rectangle
+ * @columns: Number of grid points in x direction, at least 2
+ * @rows: Number of grid points in y direction, at least 2
+ *
+ * Creates a new flow field and starts filling it in a background thread.
+ * This calls lw_noise_init() for you.
+ *
+ * Returns: A new #LwFlowField. Use g_object_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwFlowField*
+lw_flow_field_new(gfloat x, gfloat y, gfloat width, gfloat height, guint columns, guint rows)
+{
+	LwFlowField *self;
+
+	g_return_val_if_fail(width > 0.0f && height > 0.0f, NULL);
+	g_return_val_if_fail(columns >= 2 && rows >= 2, NULL);
+
+	self = g_object_new(LW_TYPE_FLOW_FIELD, NULL);
+
+	self->priv->x = x;
+	self->priv->y = y;
+	self->priv->width = width;
+	self->priv->height = height;
+	self->priv->columns = columns;
+	self->priv->rows = rows;
+	self->priv->scale_x = (columns - 1) / width;
+	self->priv->scale_y = (rows - 1) / height;
+	self->priv->nodes = g_new(gfloat, NODE_SIZE * columns * rows);
+
+	/* The noise tables have to exist before the thread uses them */
+	lw_noise_init();
+	self->priv->thread = g_thread_new("lw-flow-field", lw_flow_field_fill, self);
+
+	return self;
+}
+
+/**
+ * lw_flow_field_is_ready:
+ * @self: A #LwFlowField
+ *
+ * Returns: %TRUE if the whole grid has been sampled, %FALSE otherwise
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_flow_field_is_ready(LwFlowField *self)
+{
+	return (guint) g_atomic_int_get(&self->priv->rows_ready) == self->priv->rows;
+}
+
+/**
+ * lw_flow_field_sample:
+ * @self: A #LwFlowField
+ * @x: A x coordinate
+ * @y: A y coordinate
+ * @dx: (out): Return location for the x component of the direction
+ * @dy: (out): Return location for the y component of the direction
+ * @value: (out): Return location for the noise value
+ *
+ * Interpolates the direction and the noise value at (@x, @y). Positions outside
+ * of the covered rectangle get the values at its border. The interpolated
+ * direction is not normalized, so its length may be slightly less than 1.0
+ * where the direction changes quickly.
+ *
+ * Since: 0.6
+ */
+void
+lw_flow_field_sample(LwFlowField *self, gfloat x, gfloat y, gfloat *dx, gfloat *dy, gfloat *value)
+{
+	LwFlowFieldPrivate *priv = self->priv;
+	const gfloat *n00, *n10, *n01, *n11;
+	gfloat u, v, a, b;
+	guint c, r, i;
+	gfloat out[NODE_SIZE];
+
+	/* Position in grid units, clamped to the grid */
+	u = CLAMP((x - priv->x) * priv->scale_x, 0.0f, priv->columns - 1.0f);
+	v = CLAMP((y - priv->y) * priv->scale_y, 0.0f, priv->rows - 1.0f);
+	c = MIN((guint) u, priv->columns - 2);
+	r = MIN((guint) v, priv->rows - 2);
+	u -= c;
+	v -= r;
+
+	if(r + 2 > (guint) g_atomic_int_get(&priv->rows_ready))
+	{
+		/* The rows are not sampled yet */
+		gfloat noise = lw_simplex_noise_2f(priv->x + (c + u) / priv->scale_x,
+		                                   priv->y + (r + v) / priv->scale_y);
+
+		*dx = lw_cos(LW_2PI * noise);
+		*dy = lw_sin(LW_2PI * noise);
+		*value = noise;
+		return;
+	}
+
+	n00 = priv->nodes + NODE_SIZE * (r * priv->columns + c);
+	n10 = n00 + NODE_SIZE;
+	n01 = n00 + NODE_SIZE * priv->columns;
+	n11 = n01 + NODE_SIZE;
+
+	for(i = 0; i < NODE_SIZE; i++)
+	{
+		a = n00[i] + u * (n10[i] - n00[i]);
+		b = n01[i] + u * (n11[i] - n01[i]);
+		out[i] = a + v * (b - a);
+	}
+
+	*dx = out[0];
+	*dy = out[1];
+	*value = out[2];
+}
+
+static void
+lw_flow_field_init(LwFlowField *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_FLOW_FIELD,
+	                                         LwFlowFieldPrivate);
+
+	self->priv->nodes = NULL;
+	self->priv->rows_ready = 0;
+	self->priv->cancelled = FALSE;
+	self->priv->thread = NULL;
+}
+
+static void
+lw_flow_field_finalize(GObject *object)
+{
+	LwFlowField *self = LW_FLOW_FIELD(object);
+
+	/* Stop the thread before freeing the grid it writes to */
+	if(self->priv->thread)
+	{
+		g_atomic_int_set(&self->priv->cancelled, TRUE);
+		g_thread_join(self->priv->thread);
+		self->priv->thread = NULL;
+	}
+
+	g_free(self->priv->nodes);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_flow_field_parent_class)->finalize(object);
+}
+
+static void
+lw_flow_field_class_init(LwFlowFieldClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_flow_field_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwFlowFieldPrivate));
+}
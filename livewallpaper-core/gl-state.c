@@ -0,0 +1,489 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: gl-state
+ * @Short_description: Skips redundant OpenGL state changes
+ *
+ * The functions in this section shadow the OpenGL state that changes most often
+ * while painting a wallpaper: enabled capabilities, the blend function, the active
+ * texture unit, texture and buffer bindings and the current program. A call that
+ * would not change anything is not passed to OpenGL at all.
+ *
+ * #LwTexture, #LwBuffer, #LwProgram and #LwBackground use these functions internally,
+ * so calling lw_texture_enable() for an already enabled texture costs nothing. Plugins
+ * should use them as well instead of calling glEnable(), glBlendFunc() and friends
+ * directly.
+ *
+ * LiveWallpaper uses a single OpenGL context, so there is only one set of shadowed
+ * state. If OpenGL state is changed without using these functions, for example by
+ * glPopAttrib() or by a Python plugin, call lw_gl_state_invalidate() afterwards.
+ * LiveWallpaper does this for you after every callback of a wallpaper that changes
+ * OpenGL state directly. Such plugins set X-GLStateCache=false in their plugin file.
+ *
+ * lw_gl_state_get_elided_calls() returns the number of skipped OpenGL calls, which
+ * helps to find plugins that change state more often than necessary.
+ */
+
+#include <livewallpaper/core.h>
+
+/* Texture units with a higher index are passed through without caching */
+#define MAX_TEXTURE_UNITS 16
+
+#define N_TEXTURE_TARGETS 5
+#define N_BUFFER_TARGETS  4
+#define N_CAPS            10
+
+/* Marks a binding or capability whose value is not known */
+#define UNKNOWN_NAME  G_MAXUINT
+#define UNKNOWN_STATE -1
+
+typedef struct
+{
+	guint texture[N_TEXTURE_TARGETS];
+	gint enabled[N_TEXTURE_TARGETS];
+} LwGLTextureUnit;
+
+typedef struct
+{
+	gboolean valid;
+
+	guint active_unit;
+	LwGLTextureUnit units[MAX_TEXTURE_UNITS];
+
+	guint buffer[N_BUFFER_TARGETS];
+	guint program;
+
+	gint caps[N_CAPS];
+	guint blend_src;
+	guint blend_dst;
+
+	guint elided;
+} LwGLState;
+
+static LwGLState state;
+
+static gint
+texture_target_index(guint target)
+{
+	switch(target)
+	{
+		case GL_TEXTURE_1D:            return 0;
+		case GL_TEXTURE_2D:            return 1;
+		case GL_TEXTURE_3D:            return 2;
+		case GL_TEXTURE_CUBE_MAP:      return 3;
+		case GL_TEXTURE_RECTANGLE_ARB: return 4;
+		default:                       return -1;
+	}
+}
+
+static gint
+buffer_target_index(guint target)
+{
+	switch(target)
+	{
+		case GL_ARRAY_BUFFER:         return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_PIXEL_PACK_BUFFER:    return 2;
+		case GL_PIXEL_UNPACK_BUFFER:  return 3;
+		default:                      return -1;
+	}
+}
+
+static gint
+cap_index(guint cap)
+{
+	switch(cap)
+	{
+		case GL_BLEND:                     return 0;
+		case GL_DEPTH_TEST:                return 1;
+		case GL_CULL_FACE:                 return 2;
+		case GL_SCISSOR_TEST:              return 3;
+		case GL_ALPHA_TEST:                return 4;
+		case GL_POINT_SPRITE:              return 5;
+		case GL_POINT_SMOOTH:              return 6;
+		case GL_LINE_SMOOTH:               return 7;
+		case GL_MULTISAMPLE:               return 8;
+		case GL_VERTEX_PROGRAM_POINT_SIZE: return 9;
+		default:                           return -1;
+	}
+}
+
+/* Returns the cached enable state of @cap or NULL if it is not cached */
+static gint*
+lw_gl_state_lookup_cap(guint cap)
+{
+	gint i;
+
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	/* Enabling a texture target only affects the active texture unit */
+	i = texture_target_index(cap);
+	if(i != -1)
+		return (state.active_unit < MAX_TEXTURE_UNITS) ? &state.units[state.active_unit].enabled[i] : NULL;
+
+	i = cap_index(cap);
+	return (i != -1) ? &state.caps[i] : NULL;
+}
+
+/**
+ * lw_gl_state_invalidate:
+ *
+ * Forgets all shadowed OpenGL state, so the next call of every lw_gl_state_*()
+ * function is passed to OpenGL. Call this after changing OpenGL state without
+ * using the lw_gl_state_*() functions, e.g. after glPopAttrib().
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_invalidate(void)
+{
+	guint i, j;
+
+	state.active_unit = UNKNOWN_NAME;
+	for(i = 0; i < MAX_TEXTURE_UNITS; i++)
+		for(j = 0; j < N_TEXTURE_TARGETS; j++)
+		{
+			state.units[i].texture[j] = UNKNOWN_NAME;
+			state.units[i].enabled[j] = UNKNOWN_STATE;
+		}
+
+	for(i = 0; i < N_BUFFER_TARGETS; i++)
+		state.buffer[i] = UNKNOWN_NAME;
+	state.program = UNKNOWN_NAME;
+
+	for(i = 0; i < N_CAPS; i++)
+		state.caps[i] = UNKNOWN_STATE;
+	state.blend_src = UNKNOWN_NAME;
+	state.blend_dst = UNKNOWN_NAME;
+
+	state.valid = TRUE;
+}
+
+/**
+ * lw_gl_state_enable:
+ * @cap: An OpenGL capability, e.g. GL_BLEND or GL_TEXTURE_2D
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glEnable.xml">glEnable</ulink>
+ * unless @cap is already enabled. Texture targets are tracked for every texture unit.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_enable(guint cap)
+{
+	gint *enabled = lw_gl_state_lookup_cap(cap);
+
+	if(enabled != NULL)
+	{
+		if(*enabled == TRUE)
+		{
+			state.elided++;
+			return;
+		}
+		*enabled = TRUE;
+	}
+
+	glEnable(cap);
+}
+
+/**
+ * lw_gl_state_disable:
+ * @cap: An OpenGL capability, e.g. GL_BLEND or GL_TEXTURE_2D
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glEnable.xml">glDisable</ulink>
+ * unless @cap is already disabled.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_disable(guint cap)
+{
+	gint *enabled = lw_gl_state_lookup_cap(cap);
+
+	if(enabled != NULL)
+	{
+		if(*enabled == FALSE)
+		{
+			state.elided++;
+			return;
+		}
+		*enabled = FALSE;
+	}
+
+	glDisable(cap);
+}
+
+/**
+ * lw_gl_state_is_enabled:
+ * @cap: An OpenGL capability, e.g. GL_BLEND or GL_TEXTURE_2D
+ *
+ * Returns whether @cap is enabled. OpenGL is only queried using
+ * <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glIsEnabled.xml">glIsEnabled</ulink>
+ * if the state is not known yet.
+ *
+ * Returns: %TRUE if @cap is enabled, %FALSE otherwise
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_gl_state_is_enabled(guint cap)
+{
+	gint *enabled = lw_gl_state_lookup_cap(cap);
+
+	if(enabled == NULL)
+		return glIsEnabled(cap);
+
+	if(*enabled == UNKNOWN_STATE)
+		*enabled = glIsEnabled(cap) ? TRUE : FALSE;
+	else
+		state.elided++;
+
+	return *enabled;
+}
+
+/**
+ * lw_gl_state_blend_func:
+ * @sfactor: The source blending factor
+ * @dfactor: The destination blending factor
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glBlendFunc.xml">glBlendFunc</ulink>
+ * unless the blending factors are already set.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_blend_func(guint sfactor, guint dfactor)
+{
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	if(state.blend_src == sfactor && state.blend_dst == dfactor)
+	{
+		state.elided++;
+		return;
+	}
+
+	state.blend_src = sfactor;
+	state.blend_dst = dfactor;
+	glBlendFunc(sfactor, dfactor);
+}
+
+/**
+ * lw_gl_state_active_texture:
+ * @unit: The texture unit from 0 to lw_texture_get_max_texture_units()
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glActiveTexture.xml">glActiveTexture</ulink>
+ * unless @unit is already the active texture unit.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_active_texture(guint unit)
+{
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	if(state.active_unit == unit)
+	{
+		state.elided++;
+		return;
+	}
+
+	state.active_unit = unit;
+	glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+/**
+ * lw_gl_state_bind_texture:
+ * @target: The texture target, e.g. GL_TEXTURE_2D
+ * @name: The name of a texture or 0
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glBindTexture.xml">glBindTexture</ulink>
+ * unless @name is already bound to @target of the active texture unit.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_bind_texture(guint target, guint name)
+{
+	gint i = texture_target_index(target);
+
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	if(i != -1 && state.active_unit < MAX_TEXTURE_UNITS)
+	{
+		guint *bound = &state.units[state.active_unit].texture[i];
+
+		if(*bound == name)
+		{
+			state.elided++;
+			return;
+		}
+		*bound = name;
+	}
+
+	glBindTexture(target, name);
+}
+
+/**
+ * lw_gl_state_bind_buffer:
+ * @target: The buffer target, e.g. GL_ARRAY_BUFFER
+ * @name: The name of a buffer or 0
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glBindBuffer.xml">glBindBuffer</ulink>
+ * unless @name is already bound to @target.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_bind_buffer(guint target, guint name)
+{
+	gint i = buffer_target_index(target);
+
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	if(i != -1)
+	{
+		if(state.buffer[i] == name)
+		{
+			state.elided++;
+			return;
+		}
+		state.buffer[i] = name;
+	}
+
+	LW_OPENGL_1_4_HELPER(glBindBuffer, glBindBufferARB, (target, name));
+}
+
+/**
+ * lw_gl_state_use_program:
+ * @name: The name of a program or 0
+ *
+ * Calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glUseProgram.xml">glUseProgram</ulink>
+ * unless @name is already the current program.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_use_program(guint name)
+{
+	if(!state.valid)
+		lw_gl_state_invalidate();
+
+	if(state.program == name)
+	{
+		state.elided++;
+		return;
+	}
+
+	state.program = name;
+	LW_OPENGL_1_4_HELPER(glUseProgram, glUseProgramObjectARB, (name));
+}
+
+/**
+ * lw_gl_state_forget_texture:
+ * @name: The name of a texture
+ *
+ * Tells the state cache that the texture @name is going to be deleted. OpenGL
+ * binds 0 in place of a deleted texture, so the cache does the same.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_forget_texture(guint name)
+{
+	guint i, j;
+
+	for(i = 0; i < MAX_TEXTURE_UNITS; i++)
+		for(j = 0; j < N_TEXTURE_TARGETS; j++)
+			if(state.units[i].texture[j] == name)
+				state.units[i].texture[j] = 0;
+}
+
+/**
+ * lw_gl_state_forget_buffer:
+ * @name: The name of a buffer
+ *
+ * Tells the state cache that the buffer @name is going to be deleted. OpenGL
+ * binds 0 in place of a deleted buffer, so the cache does the same.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_forget_buffer(guint name)
+{
+	guint i;
+
+	for(i = 0; i < N_BUFFER_TARGETS; i++)
+		if(state.buffer[i] == name)
+			state.buffer[i] = 0;
+}
+
+/**
+ * lw_gl_state_forget_program:
+ * @name: The name of a program
+ *
+ * Tells the state cache that the program @name is going to be deleted. A deleted
+ * program stays in use until another one is installed, but its name may be reused,
+ * so the current program is considered unknown afterwards.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_forget_program(guint name)
+{
+	if(state.program == name)
+		state.program = UNKNOWN_NAME;
+}
+
+/**
+ * lw_gl_state_get_elided_calls:
+ *
+ * Returns the number of OpenGL calls skipped by the state cache since the last
+ * call of lw_gl_state_reset_elided_calls(). This is meant for debugging.
+ *
+ * Returns: The number of skipped OpenGL calls
+ *
+ * Since: 0.6
+ */
+guint
+lw_gl_state_get_elided_calls(void)
+{
+	return state.elided;
+}
+
+/**
+ * lw_gl_state_reset_elided_calls:
+ *
+ * Resets the counter returned by lw_gl_state_get_elided_calls() to 0.
+ *
+ * Since: 0.6
+ */
+void
+lw_gl_state_reset_elided_calls(void)
+{
+	state.elided = 0;
+}
+
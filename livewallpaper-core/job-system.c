@@ -0,0 +1,780 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: job-system
+ * @Short_description: work-stealing scheduler for small jobs
+ *
+ * A #LwJobSystem runs jobs on a fixed set of worker threads. Every
+ * worker has its own queue of jobs. It takes the job it added last from its own
+ * queue, which is usually still in its cache, and steals the oldest job of
+ * another queue if its own is empty. This keeps the overhead per job low
+ * enough to split the work of a single frame.
+ *
+ * A job can have a parent, which is not finished before all of its children are
+ * finished, and continuations, which are submitted once the job is finished.
+ * lw_job_system_wait() runs other jobs until a job is finished, so the waiting
+ * thread helps instead of blocking. It only sleeps while there is nothing left
+ * to run and the remaining jobs are running on other threads.
+ *
+ * lw_job_system_parallel_for() is the easiest way to use it. It splits a range
+ * of indices in halves until the parts are small enough, and every split part
+ * can be stolen by an idle worker.
+ *
+ * |[
+ * static void
+ * update_range(guint first, guint count, gpointer data)
+ * {
+ *     guint i;
+ *
+ *     for(i = first; i < first + count; i++)
+ *         update_particle(data, i);
+ * }
+ *
+ * lw_job_system_parallel_for(lw_job_system_get_default(), n_particles, 256,
+ *                            update_range, particles);
+ * ]|
+ */
+
+#if defined(__linux__)
+/* Needed for pthread_setaffinity_np() */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#define LW_JOB_SYSTEM_AFFINITY
+#endif
+
+#include <livewallpaper/core.h>
+
+/* Initial capacity of a queue, it has to be a power of two */
+#define QUEUE_CAPACITY 64
+
+struct _LwJob
+{
+	LwJobFunc func;
+	gpointer data;
+
+	/* The parent holds a reference of the job until it is finished */
+	LwJob *parent;
+	GSList *continuations;
+	LwJobSystem *system;
+
+	/* 1 for the job itself and 1 for every unfinished child, accessed atomically */
+	gint unfinished;
+	gint ref_count;
+};
+
+typedef struct
+{
+	GMutex mutex;
+	LwJob **jobs;
+	guint head;
+	guint count;
+	guint capacity;
+} LwJobQueue;
+
+typedef struct
+{
+	LwJobSystem *system;
+	LwJobQueue queue;
+	GThread *thread;
+	guint index;
+
+	/* Used to choose the queue to steal from */
+	LwRandom random;
+} LwJobWorker;
+
+struct _LwJobSystemPrivate
+{
+	guint n_workers;
+	LwJobWorker *workers;
+	gboolean pin_workers;
+
+	/* Jobs submitted by threads which are not workers */
+	LwJobQueue shared;
+
+	/* Number of queued jobs, sleeping workers and threads sleeping in
+	 * lw_job_system_wait(), accessed atomically */
+	gint queued;
+	gint sleeping;
+	gint waiting;
+	gint quit;
+
+	/* Protects sleeping threads from missing new or finished jobs */
+	GMutex mutex;
+	GCond cond;
+	GCond wait_cond;
+};
+
+/**
+ * LwJob:
+ *
+ * A function with its data, which can be run by a #LwJobSystem.
+ *
+ * Since: 0.6
+ */
+
+/**
+ * LwJobSystem:
+ *
+ * A set of worker threads which run #LwJob instances.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwJobSystem, lw_job_system, G_TYPE_OBJECT)
+
+static LwJobSystem *default_system = NULL;
+
+/* The LwJobWorker of the current thread or NULL if it is not a worker */
+static GPrivate current_worker;
+
+static void
+lw_job_queue_init(LwJobQueue *queue)
+{
+	g_mutex_init(&queue->mutex);
+	queue->jobs = g_new(LwJob*, QUEUE_CAPACITY);
+	queue->head = 0;
+	queue->count = 0;
+	queue->capacity = QUEUE_CAPACITY;
+}
+
+static void
+lw_job_queue_clear(LwJobQueue *queue)
+{
+	g_mutex_clear(&queue->mutex);
+	g_free(queue->jobs);
+}
+
+static void
+lw_job_queue_push(LwJobQueue *queue, LwJob *job)
+{
+	g_mutex_lock(&queue->mutex);
+
+	if(queue->count == queue->capacity)
+	{
+		LwJob **jobs = g_new(LwJob*, 2 * queue->capacity);
+		guint i;
+
+		for(i = 0; i < queue->count; i++)
+			jobs[i] = queue->jobs[(queue->head + i) & (queue->capacity - 1)];
+
+		g_free(queue->jobs);
+		queue->jobs = jobs;
+		queue->head = 0;
+		queue->capacity *= 2;
+	}
+
+	queue->jobs[(queue->head + queue->count) & (queue->capacity - 1)] = job;
+	queue->count++;
+
+	g_mutex_unlock(&queue->mutex);
+}
+
+/* Takes the newest job, used by the owner of the queue */
+static LwJob*
+lw_job_queue_pop(LwJobQueue *queue)
+{
+	LwJob *job = NULL;
+
+	g_mutex_lock(&queue->mutex);
+	if(queue->count > 0)
+	{
+		queue->count--;
+		job = queue->jobs[(queue->head + queue->count) & (queue->capacity - 1)];
+	}
+	g_mutex_unlock(&queue->mutex);
+
+	return job;
+}
+
+/* Takes the oldest job, used by other threads */
+static LwJob*
+lw_job_queue_steal(LwJobQueue *queue)
+{
+	LwJob *job = NULL;
+
+	g_mutex_lock(&queue->mutex);
+	if(queue->count > 0)
+	{
+		job = queue->jobs[queue->head];
+		queue->head = (queue->head + 1) & (queue->capacity - 1);
+		queue->count--;
+	}
+	g_mutex_unlock(&queue->mutex);
+
+	return job;
+}
+
+/**
+ * lw_job_new:
+ * @func: (scope notified): The function to run
+ * @data: Data to pass to @func
+ * @parent: (allow-none): The parent of the new job or %NULL
+ *
+ * Creates a new job. The @parent is not finished before the new job is finished,
+ * so the job has to be created before @parent is finished, for example while
+ * @parent is running or before it is submitted.
+ *
+ * Returns: A new #LwJob. Use lw_job_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwJob*
+lw_job_new(LwJobFunc func, gpointer data, LwJob *parent)
+{
+	LwJob *job = g_slice_new(LwJob);
+
+	job->func = func;
+	job->data = data;
+	job->parent = NULL;
+	job->continuations = NULL;
+	job->system = NULL;
+	job->unfinished = 1;
+	job->ref_count = 1;
+
+	if(parent)
+	{
+		g_atomic_int_inc(&parent->unfinished);
+		job->parent = lw_job_ref(parent);
+	}
+
+	return job;
+}
+
+/**
+ * lw_job_ref:
+ * @job: A #LwJob
+ *
+ * Increases the reference count of @job by one.
+ *
+ * Returns: @job
+ *
+ * Since: 0.6
+ */
+LwJob*
+lw_job_ref(LwJob *job)
+{
+	g_atomic_int_inc(&job->ref_count);
+
+	return job;
+}
+
+/**
+ * lw_job_unref:
+ * @job: A #LwJob
+ *
+ * Decreases the reference count of @job by one. The job is freed if the
+ * reference count drops to 0. A submitted job keeps a reference to itself
+ * until it is finished.
+ *
+ * Since: 0.6
+ */
+void
+lw_job_unref(LwJob *job)
+{
+	if(g_atomic_int_dec_and_test(&job->ref_count))
+	{
+		g_slist_free_full(job->continuations, (GDestroyNotify) lw_job_unref);
+		g_slice_free(LwJob, job);
+	}
+}
+
+/**
+ * lw_job_add_continuation:
+ * @job: A #LwJob
+ * @continuation: The #LwJob to run after @job
+ *
+ * Submits @continuation to the same #LwJobSystem as @job once @job and all of
+ * its children are finished. Continuations have to be added before @job is
+ * submitted.
+ *
+ * Since: 0.6
+ */
+void
+lw_job_add_continuation(LwJob *job, LwJob *continuation)
+{
+	g_return_if_fail(job->system == NULL);
+
+	job->continuations = g_slist_prepend(job->continuations, lw_job_ref(continuation));
+}
+
+/**
+ * lw_job_is_finished:
+ * @job: A #LwJob
+ *
+ * Returns: %TRUE if @job and all of its children are finished, %FALSE otherwise
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_job_is_finished(LwJob *job)
+{
+	return g_atomic_int_get(&job->unfinished) == 0;
+}
+
+/* Wakes up the threads sleeping in lw_job_system_wait(), so they check their job
+ * or run a new one. Like for sleeping workers, the waiting thread changes the
+ * counter and reads the job, while this side changes the job and reads the
+ * counter. */
+static void
+lw_job_system_wake_waiters(LwJobSystem *self)
+{
+	LwJobSystemPrivate *priv = self->priv;
+
+	if(g_atomic_int_get(&priv->waiting) > 0)
+	{
+		g_mutex_lock(&priv->mutex);
+		g_cond_broadcast(&priv->wait_cond);
+		g_mutex_unlock(&priv->mutex);
+	}
+}
+
+static void
+lw_job_finish(LwJob *job)
+{
+	GSList *iter;
+
+	if(!g_atomic_int_dec_and_test(&job->unfinished))
+		return;
+
+	/* A parent which was never submitted has no system */
+	if(job->system)
+		lw_job_system_wake_waiters(job->system);
+
+	for(iter = job->continuations; iter; iter = iter->next)
+		lw_job_system_submit(job->system, iter->data);
+
+	if(job->parent)
+	{
+		lw_job_finish(job->parent);
+		lw_job_unref(job->parent);
+		job->parent = NULL;
+	}
+
+	/* Drop the reference taken by lw_job_system_submit() */
+	lw_job_unref(job);
+}
+
+static void
+lw_job_execute(LwJob *job)
+{
+	if(job->func)
+		job->func(job->data);
+
+	lw_job_finish(job);
+}
+
+/* Looks for a job in the queue of @worker first and steals one otherwise */
+static LwJob*
+lw_job_system_find_job(LwJobSystem *self, LwJobWorker *worker)
+{
+	LwJobSystemPrivate *priv = self->priv;
+	LwJob *job = NULL;
+	guint i, start;
+
+	if(g_atomic_int_get(&priv->queued) <= 0)
+		return NULL;
+
+	if(worker)
+		job = lw_job_queue_pop(&worker->queue);
+
+	if(job == NULL)
+		job = lw_job_queue_steal(&priv->shared);
+
+	/* Start at a random worker, so thieves do not all compete for the same queue */
+	start = worker ? lw_random_uint(&worker->random, priv->n_workers)
+	               : lw_random_uint(lw_random_get_default(), priv->n_workers);
+
+	for(i = 0; job == NULL && i < priv->n_workers; i++)
+	{
+		LwJobWorker *victim = &priv->workers[(start + i) % priv->n_workers];
+
+		if(victim != worker)
+			job = lw_job_queue_steal(&victim->queue);
+	}
+
+	if(job)
+		g_atomic_int_add(&priv->queued, -1);
+
+	return job;
+}
+
+static gpointer
+lw_job_system_worker_run(gpointer data)
+{
+	LwJobWorker *worker = data;
+	LwJobSystemPrivate *priv = worker->system->priv;
+
+	g_private_set(&current_worker, worker);
+
+#ifdef LW_JOB_SYSTEM_AFFINITY
+	if(priv->pin_workers)
+	{
+		cpu_set_t set;
+
+		/* The first processor is left to the thread which created the system */
+		CPU_ZERO(&set);
+		CPU_SET((worker->index + 1) % g_get_num_processors(), &set);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+			g_debug("Could not pin job worker %u", worker->index);
+	}
+#endif
+
+	while(!g_atomic_int_get(&priv->quit))
+	{
+		LwJob *job = lw_job_system_find_job(worker->system, worker);
+
+		if(job)
+		{
+			lw_job_execute(job);
+			continue;
+		}
+
+		/* Sleep until a job is submitted. Both sides change one counter and
+		 * read the other one, so either the worker sees the job or the
+		 * submitting thread sees the sleeping worker. */
+		g_mutex_lock(&priv->mutex);
+		g_atomic_int_inc(&priv->sleeping);
+		while(g_atomic_int_get(&priv->queued) <= 0 && !g_atomic_int_get(&priv->quit))
+			g_cond_wait(&priv->cond, &priv->mutex);
+		g_atomic_int_add(&priv->sleeping, -1);
+		g_mutex_unlock(&priv->mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * lw_job_system_new:
+ * @n_workers: Number of worker threads
+ * @pin_workers: Whether to bind every worker to its own processor
+ *
+ * Creates a new job system and starts its workers. Pinning the workers avoids
+ * migrations between processors, but it is only supported on Linux and should
+ * only be used if nothing else keeps the processors busy.
+ *
+ * Returns: A new #LwJobSystem. Use g_object_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwJobSystem*
+lw_job_system_new(guint n_workers, gboolean pin_workers)
+{
+	LwJobSystem *self = g_object_new(LW_TYPE_JOB_SYSTEM, NULL);
+	guint i;
+
+	self->priv->n_workers = n_workers;
+	self->priv->pin_workers = pin_workers;
+	self->priv->workers = g_new0(LwJobWorker, n_workers);
+
+	/* All queues have to exist before the first worker steals from them */
+	for(i = 0; i < n_workers; i++)
+	{
+		LwJobWorker *worker = &self->priv->workers[i];
+
+		worker->system = self;
+		worker->index = i;
+		lw_job_queue_init(&worker->queue);
+		lw_random_init(&worker->random, i);
+	}
+
+	for(i = 0; i < n_workers; i++)
+		self->priv->workers[i].thread = g_thread_new("lw-job-worker", lw_job_system_worker_run,
+		                                             &self->priv->workers[i]);
+
+	return self;
+}
+
+/**
+ * lw_job_system_get_default:
+ *
+ * Returns the job system shared by the core and all plugins. It has one worker
+ * less than there are processors, because the thread waiting for the jobs runs
+ * jobs too.
+ *
+ * Returns: (transfer none): The default #LwJobSystem
+ *
+ * Since: 0.6
+ */
+LwJobSystem*
+lw_job_system_get_default(void)
+{
+	static gsize initialized = 0;
+
+	/* Workers may submit jobs too, so this has to be thread safe */
+	if(g_once_init_enter(&initialized))
+	{
+		default_system = lw_job_system_new(g_get_num_processors() - 1, FALSE);
+		g_debug("Using %u job workers", default_system->priv->n_workers);
+
+		g_once_init_leave(&initialized, 1);
+	}
+
+	return default_system;
+}
+
+/**
+ * lw_job_system_get_n_workers:
+ * @self: A #LwJobSystem
+ *
+ * Returns: The number of worker threads
+ *
+ * Since: 0.6
+ */
+guint
+lw_job_system_get_n_workers(LwJobSystem *self)
+{
+	return self->priv->n_workers;
+}
+
+/**
+ * lw_job_system_submit:
+ * @self: A #LwJobSystem
+ * @job: The #LwJob to run
+ *
+ * Queues @job to be run by one of the workers or a thread waiting in
+ * lw_job_system_wait(). A job must only be submitted once.
+ *
+ * Since: 0.6
+ */
+void
+lw_job_system_submit(LwJobSystem *self, LwJob *job)
+{
+	LwJobSystemPrivate *priv = self->priv;
+	LwJobWorker *worker = g_private_get(&current_worker);
+
+	job->system = self;
+	lw_job_ref(job);
+
+	/* Without workers the job is run by the next lw_job_system_wait() */
+	if(worker && worker->system == self)
+		lw_job_queue_push(&worker->queue, job);
+	else
+		lw_job_queue_push(&priv->shared, job);
+
+	g_atomic_int_inc(&priv->queued);
+
+	if(g_atomic_int_get(&priv->sleeping) > 0)
+	{
+		g_mutex_lock(&priv->mutex);
+		g_cond_signal(&priv->cond);
+		g_mutex_unlock(&priv->mutex);
+	}
+
+	/* A waiting thread can run the job as well */
+	lw_job_system_wake_waiters(self);
+}
+
+/**
+ * lw_job_system_wait:
+ * @self: A #LwJobSystem
+ * @job: A #LwJob submitted to @self
+ *
+ * Runs queued jobs until @job and all of its children are finished. If no job is
+ * left to run, the calling thread sleeps until another thread finishes a job or
+ * submits a new one.
+ *
+ * @job has to be submitted with lw_job_system_submit() first. A job which is
+ * never submitted, like a parent only used to group its children, is never
+ * finished, so waiting for it would never return.
+ *
+ * Since: 0.6
+ */
+void
+lw_job_system_wait(LwJobSystem *self, LwJob *job)
+{
+	LwJobSystemPrivate *priv = self->priv;
+	LwJobWorker *worker = g_private_get(&current_worker);
+
+	g_return_if_fail(job->system == self);
+
+	if(worker && worker->system != self)
+		worker = NULL;
+
+	while(!lw_job_is_finished(job))
+	{
+		LwJob *next = lw_job_system_find_job(self, worker);
+
+		if(next)
+		{
+			lw_job_execute(next);
+			continue;
+		}
+
+		/* The remaining jobs are running on other threads */
+		g_mutex_lock(&priv->mutex);
+		g_atomic_int_inc(&priv->waiting);
+		while(g_atomic_int_get(&priv->queued) <= 0 && !lw_job_is_finished(job))
+			g_cond_wait(&priv->wait_cond, &priv->mutex);
+		g_atomic_int_add(&priv->waiting, -1);
+		g_mutex_unlock(&priv->mutex);
+	}
+}
+
+typedef struct
+{
+	LwJobSystem *system;
+	LwJob *root;
+	LwJobRangeFunc func;
+	gpointer data;
+	guint first;
+	guint count;
+	guint grain;
+} LwJobRange;
+
+static void
+lw_job_system_run_range(gpointer data)
+{
+	LwJobRange *range = data;
+
+	/* Give away the upper half until the rest is small enough */
+	while(range->count > range->grain)
+	{
+		LwJobRange *half = g_slice_dup(LwJobRange, range);
+		LwJob *job;
+
+		half->count = range->count / 2;
+		range->count -= half->count;
+		half->first = range->first + range->count;
+
+		job = lw_job_new(lw_job_system_run_range, half, range->root);
+		lw_job_system_submit(range->system, job);
+		lw_job_unref(job);
+	}
+
+	range->func(range->first, range->count, range->data);
+	g_slice_free(LwJobRange, range);
+}
+
+/**
+ * lw_job_system_parallel_for:
+ * @self: A #LwJobSystem
+ * @count: Number of indices
+ * @grain: Maximum number of indices passed to @func at once, at least 1
+ * @func: (scope call): The function processing a range of indices
+ * @data: Data to pass to @func
+ *
+ * Calls @func for ranges covering the indices 0 to @count - 1 and returns after
+ * all of them are processed. The ranges are processed in parallel, so @func has
+ * to be thread safe. A larger @grain reduces the overhead, a smaller one
+ * balances the work better.
+ *
+ * Since: 0.6
+ */
+void
+lw_job_system_parallel_for(LwJobSystem *self, guint count, guint grain, LwJobRangeFunc func, gpointer data)
+{
+	LwJobRange *range;
+	LwJob *root;
+
+	g_return_if_fail(grain > 0);
+
+	if(count == 0)
+		return;
+
+	/* Without workers or with a single range, this is a plain loop without jobs */
+	if(self->priv->n_workers == 0 || count <= grain)
+	{
+		func(0, count, data);
+		return;
+	}
+
+	range = g_slice_new(LwJobRange);
+	range->system = self;
+	range->func = func;
+	range->data = data;
+	range->first = 0;
+	range->count = count;
+	range->grain = grain;
+
+	/* The range is freed by the job, so the root is kept separately */
+	root = range->root = lw_job_new(lw_job_system_run_range, range, NULL);
+
+	lw_job_system_submit(self, root);
+	lw_job_system_wait(self, root);
+	lw_job_unref(root);
+}
+
+static void
+lw_job_system_init(LwJobSystem *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_JOB_SYSTEM,
+	                                         LwJobSystemPrivate);
+
+	self->priv->n_workers = 0;
+	self->priv->workers = NULL;
+	self->priv->pin_workers = FALSE;
+	lw_job_queue_init(&self->priv->shared);
+	self->priv->queued = 0;
+	self->priv->sleeping = 0;
+	self->priv->waiting = 0;
+	self->priv->quit = FALSE;
+	g_mutex_init(&self->priv->mutex);
+	g_cond_init(&self->priv->cond);
+	g_cond_init(&self->priv->wait_cond);
+}
+
+static void
+lw_job_system_finalize(GObject *object)
+{
+	LwJobSystem *self = LW_JOB_SYSTEM(object);
+	LwJob *job;
+	guint i;
+
+	/* Queued jobs are dropped, running ones are waited for */
+	g_mutex_lock(&self->priv->mutex);
+	g_atomic_int_set(&self->priv->quit, TRUE);
+	g_cond_broadcast(&self->priv->cond);
+	g_mutex_unlock(&self->priv->mutex);
+
+	for(i = 0; i < self->priv->n_workers; i++)
+		g_thread_join(self->priv->workers[i].thread);
+
+	for(i = 0; i < self->priv->n_workers; i++)
+	{
+		while((job = lw_job_queue_pop(&self->priv->workers[i].queue)) != NULL)
+			lw_job_unref(job);
+		lw_job_queue_clear(&self->priv->workers[i].queue);
+	}
+
+	while((job = lw_job_queue_pop(&self->priv->shared)) != NULL)
+		lw_job_unref(job);
+	lw_job_queue_clear(&self->priv->shared);
+
+	g_free(self->priv->workers);
+	g_mutex_clear(&self->priv->mutex);
+	g_cond_clear(&self->priv->cond);
+	g_cond_clear(&self->priv->wait_cond);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_job_system_parent_class)->finalize(object);
+}
+
+static void
+lw_job_system_class_init(LwJobSystemClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_job_system_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwJobSystemPrivate));
+}
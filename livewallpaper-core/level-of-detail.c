@@ -0,0 +1,516 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: level-of-detail
+ * @Short_description: automatic particle counts for weak hardware
+ *
+ * A #LwLevelOfDetail chooses how many particles a wallpaper draws if the user
+ * enables automatic quality. The count never exceeds #LwLevelOfDetail:max-count,
+ * usually the count set by the user, and is limited by two measurements:
+ *
+ * The pixel area of the outputs. Drawing more particles than it takes to cover
+ * every pixel a few times does not change the look of a wallpaper, so the count
+ * is limited to the area divided by the area of one particle, multiplied by the
+ * coverage passed to lw_level_of_detail_new(). Particles that are only a pixel
+ * or two wide can not be told apart if there are more of them than a quarter of
+ * the pixels, so the count never exceeds that either.
+ *
+ * The frame time. lw_level_of_detail_begin_frame() and lw_level_of_detail_end_frame()
+ * measure how long the CPU works on a frame and, if the OpenGL implementation
+ * supports timer queries, how long the GPU draws it. The GPU time is read back a
+ * frame or two later, so measuring does not stall the pipeline. The longer of the
+ * two times counts, because the CPU and the GPU work in parallel. Waiting for the
+ * vertical blank after the buffers are swapped is not included, so a wallpaper
+ * that is limited by vsync is not mistaken for a slow one. Without timer queries
+ * only the CPU time is measured. If the average exceeds
+ * #LwLevelOfDetail:budget, the count is lowered step by step. It is only raised
+ * again once the average falls clearly below the budget, and after every change
+ * the count stays the same for a while, so it does not oscillate.
+ *
+ * Connect to the notify signal of #LwLevelOfDetail:count to add or remove
+ * particles. The count changes in small steps, so the particles that remain
+ * should keep their state.
+ *
+ * <example>
+ *   <title>Using LwLevelOfDetail</title>
+ *   <programlisting>
+ * // In init_plugin
+ * lod = lw_level_of_detail_new(4.0);
+ * g_settings_bind(settings, "auto-quality", lod, "enabled", G_SETTINGS_BIND_GET);
+ * g_settings_bind(settings, "particle-count", lod, "max-count", G_SETTINGS_BIND_GET);
+ * g_object_bind_property(lod, "count", particles, "particle-count", G_BINDING_SYNC_CREATE);
+ *
+ * // In prepare_paint, paint and done_paint
+ * lw_level_of_detail_begin_frame(lod);
+ * lw_level_of_detail_add_output(lod, output, particle_size);
+ * lw_level_of_detail_end_frame(lod);
+ *   </programlisting>
+ * </example>
+ */
+
+#include <livewallpaper/core.h>
+
+/* Weight of the last frame in the average frame time */
+#define SMOOTHING 0.125
+
+/* Frames the count stays the same after it has been changed */
+#define SETTLE_FRAMES 30
+
+/* The count is only raised if the frame time is below this part of the budget */
+#define LOW_WATERMARK 0.75
+
+/* Particles closer than this many pixels on average can not be told apart */
+#define PIXELS_PER_PARTICLE 4.0
+
+/* Timer queries in flight, the results are read when they become available */
+#define N_QUERIES 3
+
+#define lw_level_of_detail_has_timer_query() (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+
+struct _LwLevelOfDetailPrivate
+{
+	gboolean enabled;
+	guint max_count;
+	gdouble budget;
+	gdouble coverage;
+
+	guint count;
+
+	/* Particles that cover the outputs, summed up during a frame */
+	gdouble area_count;
+	gdouble frame_area_count;
+
+	gint64 frame_start;
+	gdouble frame_time;
+
+	/* GPU time of the last frame whose query result is available */
+	GLuint queries[N_QUERIES];
+	guint next_query;
+	guint pending_queries;
+	gboolean query_active;
+	gdouble gpu_time;
+
+	gboolean measured;
+	guint frames_since_change;
+};
+
+enum
+{
+	PROP_0,
+
+	PROP_ENABLED,
+	PROP_MAX_COUNT,
+	PROP_BUDGET,
+	PROP_COUNT,
+
+	N_PROPERTIES
+};
+
+/**
+ * LwLevelOfDetail:
+ *
+ * Chooses particle counts from the output size and the frame time.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwLevelOfDetail, lw_level_of_detail, G_TYPE_OBJECT)
+
+static void
+lw_level_of_detail_set_count(LwLevelOfDetail *self, guint count)
+{
+	self->priv->frames_since_change = 0;
+
+	if(self->priv->count == count)
+		return;
+
+	self->priv->count = count;
+	g_object_notify(G_OBJECT(self), "count");
+}
+
+/* The count if the frame time is within the budget */
+static guint
+lw_level_of_detail_get_limit(LwLevelOfDetail *self)
+{
+	/* The area is not known before the first frame */
+	if(self->priv->area_count <= 0.0 || self->priv->area_count >= self->priv->max_count)
+		return self->priv->max_count;
+
+	return (guint) self->priv->area_count;
+}
+
+/**
+ * lw_level_of_detail_new:
+ * @coverage: How often the particles may cover every pixel of the outputs
+ *
+ * Creates a new #LwLevelOfDetail, which is disabled until #LwLevelOfDetail:enabled
+ * is set. Particles drawn with additive blending need a higher @coverage than
+ * opaque ones to keep their look.
+ *
+ * Returns: A new #LwLevelOfDetail. Use g_object_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwLevelOfDetail*
+lw_level_of_detail_new(gdouble coverage)
+{
+	LwLevelOfDetail *self = g_object_new(LW_TYPE_LEVEL_OF_DETAIL, NULL);
+
+	self->priv->coverage = coverage;
+
+	return self;
+}
+
+static void
+lw_level_of_detail_set_property(GObject *object,
+                                guint property_id,
+                                const GValue *value,
+                                GParamSpec *pspec)
+{
+	LwLevelOfDetail *self = LW_LEVEL_OF_DETAIL(object);
+
+	switch(property_id)
+	{
+		case PROP_ENABLED:
+			self->priv->enabled = g_value_get_boolean(value);
+			self->priv->measured = FALSE;
+
+			/* Without measurements the count only goes down until the next frame */
+			if(self->priv->enabled)
+				lw_level_of_detail_set_count(self, MIN(self->priv->count, lw_level_of_detail_get_limit(self)));
+			else
+				lw_level_of_detail_set_count(self, self->priv->max_count);
+			break;
+
+		case PROP_MAX_COUNT:
+			self->priv->max_count = g_value_get_uint(value);
+
+			if(self->priv->enabled)
+				lw_level_of_detail_set_count(self, MIN(self->priv->count, self->priv->max_count));
+			else
+				lw_level_of_detail_set_count(self, self->priv->max_count);
+			break;
+
+		case PROP_BUDGET:
+			self->priv->budget = g_value_get_double(value);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+lw_level_of_detail_get_property(GObject *object,
+                                guint property_id,
+                                GValue *value,
+                                GParamSpec *pspec)
+{
+	LwLevelOfDetail *self = LW_LEVEL_OF_DETAIL(object);
+
+	switch(property_id)
+	{
+		case PROP_ENABLED:
+			g_value_set_boolean(value, self->priv->enabled);
+			break;
+
+		case PROP_MAX_COUNT:
+			g_value_set_uint(value, self->priv->max_count);
+			break;
+
+		case PROP_BUDGET:
+			g_value_set_double(value, self->priv->budget);
+			break;
+
+		case PROP_COUNT:
+			g_value_set_uint(value, self->priv->count);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * lw_level_of_detail_get_count:
+ * @self: A #LwLevelOfDetail
+ *
+ * Returns: The number of particles to draw. It equals #LwLevelOfDetail:max-count
+ *          if @self is disabled.
+ *
+ * Since: 0.6
+ */
+guint
+lw_level_of_detail_get_count(LwLevelOfDetail *self)
+{
+	return self->priv->count;
+}
+
+/* Reads the results of the finished timer queries, oldest first */
+static void
+lw_level_of_detail_read_queries(LwLevelOfDetail *self, gboolean wait)
+{
+	LwLevelOfDetailPrivate *priv = self->priv;
+
+	while(priv->pending_queries > 0)
+	{
+		GLuint query = priv->queries[(priv->next_query + N_QUERIES - priv->pending_queries) % N_QUERIES];
+		GLuint64 elapsed;
+		GLint available = GL_TRUE;
+
+		if(!wait)
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if(!available)
+			break;
+
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		priv->gpu_time = elapsed / 1000000.0;
+		priv->pending_queries--;
+		wait = FALSE;
+	}
+}
+
+/**
+ * lw_level_of_detail_begin_frame:
+ * @self: A #LwLevelOfDetail
+ *
+ * Starts measuring a frame. Call it at the beginning of the prepare_paint
+ * function of a #LwWallpaper.
+ *
+ * Since: 0.6
+ */
+void
+lw_level_of_detail_begin_frame(LwLevelOfDetail *self)
+{
+	LwLevelOfDetailPrivate *priv = self->priv;
+
+	priv->frame_start = g_get_monotonic_time();
+	priv->frame_area_count = 0.0;
+
+	if(!priv->enabled || !lw_level_of_detail_has_timer_query())
+		return;
+
+	if(priv->queries[0] == 0)
+		glGenQueries(N_QUERIES, priv->queries);
+
+	/* All queries are in flight, wait for the oldest one */
+	if(priv->pending_queries == N_QUERIES)
+		lw_level_of_detail_read_queries(self, TRUE);
+
+	glBeginQuery(GL_TIME_ELAPSED, priv->queries[priv->next_query]);
+	priv->query_active = TRUE;
+}
+
+/**
+ * lw_level_of_detail_add_output:
+ * @self: A #LwLevelOfDetail
+ * @output: The #LwOutput painted in this frame
+ * @point_size: The diameter of a particle on @output in pixels
+ *
+ * Adds the area of @output to the area covered by the particles. Call it in
+ * the paint function of a #LwWallpaper.
+ *
+ * Since: 0.6
+ */
+void
+lw_level_of_detail_add_output(LwLevelOfDetail *self, LwOutput *output, gdouble point_size)
+{
+	gdouble pixels = (gdouble) lw_output_get_width(output) * lw_output_get_height(output);
+
+	point_size = MAX(point_size, 1.0);
+	self->priv->frame_area_count += MIN(self->priv->coverage / (point_size * point_size),
+	                                    1.0 / PIXELS_PER_PARTICLE) * pixels;
+}
+
+/**
+ * lw_level_of_detail_end_frame:
+ * @self: A #LwLevelOfDetail
+ *
+ * Finishes measuring a frame and adjusts #LwLevelOfDetail:count. Call it in
+ * the done_paint function of a #LwWallpaper.
+ *
+ * Since: 0.6
+ */
+void
+lw_level_of_detail_end_frame(LwLevelOfDetail *self)
+{
+	LwLevelOfDetailPrivate *priv = self->priv;
+	gdouble frame_time = (g_get_monotonic_time() - priv->frame_start) / 1000.0;
+	guint limit, count = priv->count;
+
+	if(priv->query_active)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		priv->query_active = FALSE;
+		priv->next_query = (priv->next_query + 1) % N_QUERIES;
+		priv->pending_queries++;
+	}
+
+	if(priv->pending_queries > 0)
+	{
+		lw_level_of_detail_read_queries(self, FALSE);
+		frame_time = MAX(frame_time, priv->gpu_time);
+	}
+
+	if(priv->frame_area_count > 0.0)
+		priv->area_count = priv->frame_area_count;
+
+	if(!priv->enabled)
+		return;
+
+	limit = lw_level_of_detail_get_limit(self);
+
+	/* The first frame only tells the area */
+	if(!priv->measured)
+	{
+		priv->measured = TRUE;
+		priv->frame_time = frame_time;
+		lw_level_of_detail_set_count(self, limit);
+		return;
+	}
+
+	priv->frame_time += SMOOTHING * (frame_time - priv->frame_time);
+
+	/* Smaller outputs or bigger particles take effect at once */
+	if(count > limit)
+	{
+		lw_level_of_detail_set_count(self, limit);
+		return;
+	}
+
+	if(++priv->frames_since_change < SETTLE_FRAMES)
+		return;
+
+	if(priv->frame_time > priv->budget && count > 0)
+		lw_level_of_detail_set_count(self, count - MAX(count / 8, 1));
+	else if(priv->frame_time < LOW_WATERMARK * priv->budget && count < limit)
+		lw_level_of_detail_set_count(self, MIN(count + MAX(count / 16, limit / 64 + 1), limit));
+}
+
+static void
+lw_level_of_detail_init(LwLevelOfDetail *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_LEVEL_OF_DETAIL,
+	                                         LwLevelOfDetailPrivate);
+
+	self->priv->enabled = FALSE;
+	self->priv->max_count = 0;
+	self->priv->budget = 4.0;
+	self->priv->coverage = 1.0;
+	self->priv->count = 0;
+	self->priv->area_count = 0.0;
+	self->priv->measured = FALSE;
+	self->priv->next_query = 0;
+	self->priv->pending_queries = 0;
+	self->priv->query_active = FALSE;
+	self->priv->gpu_time = 0.0;
+}
+
+static void
+lw_level_of_detail_finalize(GObject *object)
+{
+	LwLevelOfDetail *self = LW_LEVEL_OF_DETAIL(object);
+
+	if(self->priv->queries[0] != 0)
+		glDeleteQueries(N_QUERIES, self->priv->queries);
+
+	G_OBJECT_CLASS(lw_level_of_detail_parent_class)->finalize(object);
+}
+
+static void
+lw_level_of_detail_class_init(LwLevelOfDetailClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->set_property = lw_level_of_detail_set_property;
+	gobject_class->get_property = lw_level_of_detail_get_property;
+	gobject_class->finalize = lw_level_of_detail_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwLevelOfDetailPrivate));
+
+	/**
+	 * LwLevelOfDetail:enabled:
+	 *
+	 * Whether the count is chosen automatically. If disabled, the count equals
+	 * #LwLevelOfDetail:max-count.
+	 *
+	 * Since: 0.6
+	 */
+	g_object_class_install_property(gobject_class,
+	                                PROP_ENABLED,
+	                                g_param_spec_boolean("enabled",
+	                                                     "Enabled",
+	                                                     "Whether the count is chosen automatically",
+	                                                     FALSE,
+	                                                     G_PARAM_READWRITE));
+
+	/**
+	 * LwLevelOfDetail:max-count:
+	 *
+	 * The highest count, usually the number of particles set by the user.
+	 *
+	 * Since: 0.6
+	 */
+	g_object_class_install_property(gobject_class,
+	                                PROP_MAX_COUNT,
+	                                g_param_spec_uint("max-count",
+	                                                  "Maximum count",
+	                                                  "The highest number of particles",
+	                                                  0, G_MAXUINT,
+	                                                  0,
+	                                                  G_PARAM_READWRITE));
+
+	/**
+	 * LwLevelOfDetail:budget:
+	 *
+	 * The time in milliseconds the CPU or the GPU may work on a frame. The GPU
+	 * time is only measured if the OpenGL implementation supports timer queries.
+	 *
+	 * Since: 0.6
+	 */
+	g_object_class_install_property(gobject_class,
+	                                PROP_BUDGET,
+	                                g_param_spec_double("budget",
+	                                                    "Budget",
+	                                                    "The time in milliseconds the CPU or the GPU may work on a frame",
+	                                                    0.1, 1000.0,
+	                                                    4.0,
+	                                                    G_PARAM_READWRITE));
+
+	/**
+	 * LwLevelOfDetail:count:
+	 *
+	 * The number of particles to draw.
+	 *
+	 * Since: 0.6
+	 */
+	g_object_class_install_property(gobject_class,
+	                                PROP_COUNT,
+	                                g_param_spec_uint("count",
+	                                                  "Count",
+	                                                  "The number of particles to draw",
+	                                                  0, G_MAXUINT,
+	                                                  0,
+	                                                  G_PARAM_READABLE));
+}
@@ -0,0 +1,591 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: mat4
+ * @Short_description: A 4x4 matrix value type
+ *
+ * #LwMat4 is a plain 4x4 matrix, which can be allocated on the stack. The elements
+ * have the same layout as the ones of #LwMatrix: row-major with the translation in
+ * the last column.
+ *
+ * None of the functions allocate memory. lw_mat4_multiply(), lw_mat4_invert() and
+ * lw_mat4_transform_points() use SSE or NEON if the CPU supports it. The
+ * implementation gets chosen at runtime when one of them is called the first time.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <livewallpaper/core.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define LW_MAT4_SSE
+#include <xmmintrin.h>
+/* Allows the SSE code on i386 builds without -msse, it is only used if the CPU supports it */
+#define LW_MAT4_SSE_TARGET __attribute__((target("sse")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LW_MAT4_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * LwMat4:
+ * @m: The elements of the matrix in row-major order
+ *
+ * A 4x4 matrix.
+ *
+ * Since: 0.6
+ */
+
+typedef struct _LwMat4Kernels LwMat4Kernels;
+
+struct _LwMat4Kernels
+{
+	const gchar *name;
+	void (*multiply)(LwMat4 *result, const LwMat4 *a, const LwMat4 *b);
+	gboolean (*invert)(LwMat4 *result, const LwMat4 *m);
+	void (*transform_points)(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points);
+};
+
+static const LwMat4 identity = {{1, 0, 0, 0,
+                                 0, 1, 0, 0,
+                                 0, 0, 1, 0,
+                                 0, 0, 0, 1}};
+
+static void
+lw_mat4_multiply_scalar(LwMat4 *result, const LwMat4 *a, const LwMat4 *b)
+{
+	const gfloat *t = a->m, *o = b->m;
+	gfloat r[16];
+	guint i;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		r[i + 0] = t[i] * o[ 0] + t[i + 1] * o[ 4] + t[i + 2] * o[ 8] + t[i + 3] * o[12];
+		r[i + 1] = t[i] * o[ 1] + t[i + 1] * o[ 5] + t[i + 2] * o[ 9] + t[i + 3] * o[13];
+		r[i + 2] = t[i] * o[ 2] + t[i + 1] * o[ 6] + t[i + 2] * o[10] + t[i + 3] * o[14];
+		r[i + 3] = t[i] * o[ 3] + t[i + 1] * o[ 7] + t[i + 2] * o[11] + t[i + 3] * o[15];
+	}
+
+	memcpy(result->m, r, sizeof(r));
+}
+
+/* Inverse by cofactors, the same as in the gluInvertMatrix() of Mesa */
+static gboolean
+lw_mat4_invert_scalar(LwMat4 *result, const LwMat4 *mat)
+{
+	const gfloat *m = mat->m;
+	gfloat inv[16], det;
+	guint i;
+
+	inv[ 0] =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv[ 4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv[ 8] =  m[4] * m[ 9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[ 9];
+	inv[12] = -m[4] * m[ 9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[ 9];
+	inv[ 1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv[ 5] =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv[ 9] = -m[0] * m[ 9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[ 9];
+	inv[13] =  m[0] * m[ 9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[ 9];
+	inv[ 2] =  m[1] * m[ 6] * m[15] - m[1] * m[ 7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[ 7] - m[13] * m[3] * m[ 6];
+	inv[ 6] = -m[0] * m[ 6] * m[15] + m[0] * m[ 7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[ 7] + m[12] * m[3] * m[ 6];
+	inv[10] =  m[0] * m[ 5] * m[15] - m[0] * m[ 7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[ 7] - m[12] * m[3] * m[ 5];
+	inv[14] = -m[0] * m[ 5] * m[14] + m[0] * m[ 6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[ 6] + m[12] * m[2] * m[ 5];
+	inv[ 3] = -m[1] * m[ 6] * m[11] + m[1] * m[ 7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[ 9] * m[2] * m[ 7] + m[ 9] * m[3] * m[ 6];
+	inv[ 7] =  m[0] * m[ 6] * m[11] - m[0] * m[ 7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[ 8] * m[2] * m[ 7] - m[ 8] * m[3] * m[ 6];
+	inv[11] = -m[0] * m[ 5] * m[11] + m[0] * m[ 7] * m[ 9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[ 9] - m[ 8] * m[1] * m[ 7] + m[ 8] * m[3] * m[ 5];
+	inv[15] =  m[0] * m[ 5] * m[10] - m[0] * m[ 6] * m[ 9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[ 9] + m[ 8] * m[1] * m[ 6] - m[ 8] * m[2] * m[ 5];
+
+	det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if(det == 0.0f)
+		return FALSE;
+
+	det = 1.0f / det;
+	for(i = 0; i < 16; i++)
+		result->m[i] = inv[i] * det;
+
+	return TRUE;
+}
+
+static void
+lw_mat4_transform_points_scalar(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points)
+{
+	const gfloat *m = self->m;
+	guint i;
+
+	for(i = 0; i < n_points; i++, points += 4, result += 4)
+	{
+		gfloat x = points[0], y = points[1], z = points[2], w = points[3];
+
+		result[0] = m[ 0] * x + m[ 1] * y + m[ 2] * z + m[ 3] * w;
+		result[1] = m[ 4] * x + m[ 5] * y + m[ 6] * z + m[ 7] * w;
+		result[2] = m[ 8] * x + m[ 9] * y + m[10] * z + m[11] * w;
+		result[3] = m[12] * x + m[13] * y + m[14] * z + m[15] * w;
+	}
+}
+
+static const LwMat4Kernels scalar_kernels = {
+	"scalar",
+	lw_mat4_multiply_scalar,
+	lw_mat4_invert_scalar,
+	lw_mat4_transform_points_scalar
+};
+
+#ifdef LW_MAT4_SSE
+
+#define LW_SWIZZLE(v, x, y, z, w)    _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+#define LW_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+
+static void LW_MAT4_SSE_TARGET
+lw_mat4_multiply_sse(LwMat4 *result, const LwMat4 *a, const LwMat4 *b)
+{
+	__m128 b0 = _mm_loadu_ps(b->m + 0), b1 = _mm_loadu_ps(b->m + 4),
+	       b2 = _mm_loadu_ps(b->m + 8), b3 = _mm_loadu_ps(b->m + 12);
+	__m128 r[4];
+	guint i;
+
+	/* Each row of the result is a linear combination of the rows of b */
+	for(i = 0; i < 4; i++)
+	{
+		const gfloat *row = a->m + 4 * i;
+
+		r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), b0),
+		                             _mm_mul_ps(_mm_set1_ps(row[1]), b1)),
+		                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[2]), b2),
+		                             _mm_mul_ps(_mm_set1_ps(row[3]), b3)));
+	}
+
+	for(i = 0; i < 4; i++)
+		_mm_storeu_ps(result->m + 4 * i, r[i]);
+}
+
+/* Products of 2x2 matrices stored as (m00, m01, m10, m11), '#' is the adjugate */
+
+/* a * b */
+static __m128 LW_MAT4_SSE_TARGET
+lw_mat2_mul_sse(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, LW_SWIZZLE(b, 0, 3, 0, 3)),
+	                  _mm_mul_ps(LW_SWIZZLE(a, 1, 0, 3, 2), LW_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/* a# * b */
+static __m128 LW_MAT4_SSE_TARGET
+lw_mat2_adj_mul_sse(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(LW_SWIZZLE(a, 3, 3, 0, 0), b),
+	                  _mm_mul_ps(LW_SWIZZLE(a, 1, 1, 2, 2), LW_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/* a * b# */
+static __m128 LW_MAT4_SSE_TARGET
+lw_mat2_mul_adj_sse(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, LW_SWIZZLE(b, 3, 0, 3, 0)),
+	                  _mm_mul_ps(LW_SWIZZLE(a, 1, 0, 3, 2), LW_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/*
+ * Inverse by blockwise inversion of the four 2x2 sub matrices
+ *     | A B |
+ *     | C D |
+ */
+static gboolean LW_MAT4_SSE_TARGET
+lw_mat4_invert_sse(LwMat4 *result, const LwMat4 *m)
+{
+	__m128 r0 = _mm_loadu_ps(m->m + 0), r1 = _mm_loadu_ps(m->m + 4),
+	       r2 = _mm_loadu_ps(m->m + 8), r3 = _mm_loadu_ps(m->m + 12);
+	__m128 a = _mm_movelh_ps(r0, r1), b = _mm_movehl_ps(r1, r0),
+	       c = _mm_movelh_ps(r2, r3), d = _mm_movehl_ps(r3, r2);
+	__m128 det_sub, det_a, det_b, det_c, det_d, det_m, tr, rdet_m;
+	__m128 d_c, a_b, x, y, z, w;
+	gfloat det;
+
+	/* (|A|, |B|, |C|, |D|) */
+	det_sub = _mm_sub_ps(_mm_mul_ps(LW_SHUFFLE(r0, r2, 0, 2, 0, 2), LW_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+	                     _mm_mul_ps(LW_SHUFFLE(r0, r2, 1, 3, 1, 3), LW_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+	det_a = LW_SWIZZLE(det_sub, 0, 0, 0, 0);
+	det_b = LW_SWIZZLE(det_sub, 1, 1, 1, 1);
+	det_c = LW_SWIZZLE(det_sub, 2, 2, 2, 2);
+	det_d = LW_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+	d_c = lw_mat2_adj_mul_sse(d, c);
+	a_b = lw_mat2_adj_mul_sse(a, b);
+
+	/* Adjugates of the sub matrices of the inverse */
+	x = _mm_sub_ps(_mm_mul_ps(det_d, a), lw_mat2_mul_sse(b, d_c));
+	w = _mm_sub_ps(_mm_mul_ps(det_a, d), lw_mat2_mul_sse(c, a_b));
+	y = _mm_sub_ps(_mm_mul_ps(det_b, c), lw_mat2_mul_adj_sse(d, a_b));
+	z = _mm_sub_ps(_mm_mul_ps(det_c, b), lw_mat2_mul_adj_sse(a, d_c));
+
+	/* |M| = |A| |D| + |B| |C| - tr((A# B) (D# C)) */
+	tr = _mm_mul_ps(a_b, LW_SWIZZLE(d_c, 0, 2, 1, 3));
+	tr = _mm_add_ps(tr, LW_SWIZZLE(tr, 1, 0, 3, 2));
+	tr = _mm_add_ps(tr, LW_SWIZZLE(tr, 2, 3, 0, 1));
+	det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+	det = _mm_cvtss_f32(det_m);
+	if(det == 0.0f)
+		return FALSE;
+
+	rdet_m = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+	x = _mm_mul_ps(x, rdet_m);
+	y = _mm_mul_ps(y, rdet_m);
+	z = _mm_mul_ps(z, rdet_m);
+	w = _mm_mul_ps(w, rdet_m);
+
+	/* Undo the adjugates while storing the rows */
+	_mm_storeu_ps(result->m + 0,  LW_SHUFFLE(x, y, 3, 1, 3, 1));
+	_mm_storeu_ps(result->m + 4,  LW_SHUFFLE(x, y, 2, 0, 2, 0));
+	_mm_storeu_ps(result->m + 8,  LW_SHUFFLE(z, w, 3, 1, 3, 1));
+	_mm_storeu_ps(result->m + 12, LW_SHUFFLE(z, w, 2, 0, 2, 0));
+
+	return TRUE;
+}
+
+static void LW_MAT4_SSE_TARGET
+lw_mat4_transform_points_sse(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points)
+{
+	__m128 c0 = _mm_loadu_ps(self->m + 0), c1 = _mm_loadu_ps(self->m + 4),
+	       c2 = _mm_loadu_ps(self->m + 8), c3 = _mm_loadu_ps(self->m + 12);
+	guint i;
+
+	/* The result is a linear combination of the columns of the matrix */
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+	for(i = 0; i < n_points; i++, points += 4, result += 4)
+	{
+		__m128 p = _mm_loadu_ps(points);
+
+		_mm_storeu_ps(result,
+		              _mm_add_ps(_mm_add_ps(_mm_mul_ps(LW_SWIZZLE(p, 0, 0, 0, 0), c0),
+		                                    _mm_mul_ps(LW_SWIZZLE(p, 1, 1, 1, 1), c1)),
+		                         _mm_add_ps(_mm_mul_ps(LW_SWIZZLE(p, 2, 2, 2, 2), c2),
+		                                    _mm_mul_ps(LW_SWIZZLE(p, 3, 3, 3, 3), c3))));
+	}
+}
+
+static const LwMat4Kernels sse_kernels = {
+	"SSE",
+	lw_mat4_multiply_sse,
+	lw_mat4_invert_sse,
+	lw_mat4_transform_points_sse
+};
+
+#endif /* LW_MAT4_SSE */
+
+#ifdef LW_MAT4_NEON
+
+static void
+lw_mat4_multiply_neon(LwMat4 *result, const LwMat4 *a, const LwMat4 *b)
+{
+	float32x4_t b0 = vld1q_f32(b->m + 0), b1 = vld1q_f32(b->m + 4),
+	            b2 = vld1q_f32(b->m + 8), b3 = vld1q_f32(b->m + 12);
+	float32x4_t r[4];
+	guint i;
+
+	/* Each row of the result is a linear combination of the rows of b */
+	for(i = 0; i < 4; i++)
+	{
+		const gfloat *row = a->m + 4 * i;
+
+		r[i] = vmulq_n_f32(b0, row[0]);
+		r[i] = vmlaq_n_f32(r[i], b1, row[1]);
+		r[i] = vmlaq_n_f32(r[i], b2, row[2]);
+		r[i] = vmlaq_n_f32(r[i], b3, row[3]);
+	}
+
+	for(i = 0; i < 4; i++)
+		vst1q_f32(result->m + 4 * i, r[i]);
+}
+
+static void
+lw_mat4_transform_points_neon(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points)
+{
+	float32x4x4_t c = vld4q_f32(self->m);
+	guint i;
+
+	/* vld4q_f32() transposes, so c holds the columns of the matrix */
+	for(i = 0; i < n_points; i++, points += 4, result += 4)
+	{
+		float32x4_t p = vld1q_f32(points), v;
+
+		v = vmulq_laneq_f32(c.val[0], p, 0);
+		v = vfmaq_laneq_f32(v, c.val[1], p, 1);
+		v = vfmaq_laneq_f32(v, c.val[2], p, 2);
+		v = vfmaq_laneq_f32(v, c.val[3], p, 3);
+
+		vst1q_f32(result, v);
+	}
+}
+
+/* The scalar inverse is already fast on ARM cores with NEON */
+static const LwMat4Kernels neon_kernels = {
+	"NEON",
+	lw_mat4_multiply_neon,
+	lw_mat4_invert_scalar,
+	lw_mat4_transform_points_neon
+};
+
+#endif /* LW_MAT4_NEON */
+
+static const LwMat4Kernels *kernels = NULL;
+
+static const LwMat4Kernels*
+lw_mat4_get_kernels(void)
+{
+	static gsize initialized = 0;
+
+	if(g_once_init_enter(&initialized))
+	{
+		kernels = &scalar_kernels;
+
+#if defined(LW_MAT4_SSE)
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("sse"))
+			kernels = &sse_kernels;
+#elif defined(LW_MAT4_NEON)
+		kernels = &neon_kernels;
+#endif
+
+		g_debug("Using %s kernels for matrix operations", kernels->name);
+		g_once_init_leave(&initialized, 1);
+	}
+
+	return kernels;
+}
+
+/**
+ * lw_mat4_init_identity:
+ * @self: A #LwMat4
+ *
+ * Sets @self to the identity matrix.
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_init_identity(LwMat4 *self)
+{
+	*self = identity;
+}
+
+/**
+ * lw_mat4_ortho:
+ * @self: A #LwMat4
+ * @left: Coordinate of the left vertical clipping plane
+ * @right: Coordinate of the right vertical clipping plane
+ * @bottom: Coordinate of the bottom horizontal clipping plane
+ * @top: Coordinate of the top horizontal clipping plane
+ * @nearVal: Distance to the nearer depth clipping plane
+ * @farVal: Distance to the farther depth clipping plane
+ *
+ * Multiplies @self by an orthographic matrix. See lw_matrix_ortho().
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_ortho(LwMat4 *self,
+              gfloat left, gfloat right,
+              gfloat bottom, gfloat top,
+              gfloat nearVal, gfloat farVal)
+{
+	LwMat4 o;
+
+	g_return_if_fail(left != right);
+	g_return_if_fail(bottom != top);
+	g_return_if_fail(nearVal != farVal);
+	g_return_if_fail(nearVal >= 0 && farVal >= 0);
+
+	memset(&o, 0, sizeof(o));
+	o.m[ 0] = 2.0f / (right - left);
+	o.m[ 3] = - (right + left) / (right - left);
+	o.m[ 5] = 2.0f / (top - bottom);
+	o.m[ 7] = - (top + bottom) / (top - bottom);
+	o.m[10] = - 2.0f / (farVal - nearVal);
+	o.m[11] = - (farVal + nearVal) / (farVal - nearVal);
+	o.m[15] = 1.0f;
+
+	lw_mat4_multiply(self, self, &o);
+}
+
+/**
+ * lw_mat4_frustum:
+ * @self: A #LwMat4
+ * @left: Coordinate of the left vertical clipping plane
+ * @right: Coordinate of the right vertical clipping plane
+ * @bottom: Coordinate of the bottom horizontal clipping plane
+ * @top: Coordinate of the top horizontal clipping plane
+ * @nearVal: Distance to the nearer depth clipping plane
+ * @farVal: Distance to the farther depth clipping plane
+ *
+ * Multiplies @self by a perspective matrix. See lw_matrix_frustum().
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_frustum(LwMat4 *self,
+                gfloat left, gfloat right,
+                gfloat bottom, gfloat top,
+                gfloat nearVal, gfloat farVal)
+{
+	LwMat4 f;
+
+	g_return_if_fail(left != right);
+	g_return_if_fail(bottom != top);
+	g_return_if_fail(nearVal != farVal);
+
+	memset(&f, 0, sizeof(f));
+	f.m[ 0] = 2.0f * nearVal / (right - left);
+	f.m[ 2] = (right + left) / (right - left);
+	f.m[ 5] = 2.0f * nearVal / (top - bottom);
+	f.m[ 6] = (top + bottom) / (top - bottom);
+	f.m[10] = - (farVal + nearVal) / (farVal - nearVal);
+	f.m[11] = - 2.0f * farVal * nearVal / (farVal - nearVal);
+	f.m[14] = - 1.0f;
+
+	lw_mat4_multiply(self, self, &f);
+}
+
+/**
+ * lw_mat4_translate:
+ * @self: A #LwMat4
+ * @x: Translation in x direction
+ * @y: Translation in y direction
+ * @z: Translation in z direction
+ *
+ * Multiplies @self by a translation matrix. See lw_matrix_translate().
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_translate(LwMat4 *self, gfloat x, gfloat y, gfloat z)
+{
+	gfloat *m = self->m;
+
+	m[ 3] = x * m[ 0] + y * m[ 1] + z * m[ 2] + m[ 3];
+	m[ 7] = x * m[ 4] + y * m[ 5] + z * m[ 6] + m[ 7];
+	m[11] = x * m[ 8] + y * m[ 9] + z * m[10] + m[11];
+	m[15] = x * m[12] + y * m[13] + z * m[14] + m[15];
+}
+
+/**
+ * lw_mat4_rotate:
+ * @self: A #LwMat4
+ * @angle: Angle of rotation in radians
+ * @x: x coordinate of a vector
+ * @y: y coordinate of a vector
+ * @z: z coordinate of a vector
+ *
+ * Multiplies @self by a rotation matrix. See lw_matrix_rotate().
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_rotate(LwMat4 *self, gfloat angle, gfloat x, gfloat y, gfloat z)
+{
+	LwMat4 r;
+	gfloat c = cos(angle), s = sin(angle), t = 1.0f - c;
+
+	/* normalize vector */
+	gfloat magnitude = sqrt(x*x + y*y + z*z);
+	x = x / magnitude;
+	y = y / magnitude;
+	z = z / magnitude;
+
+	memset(&r, 0, sizeof(r));
+	r.m[ 0] = x*x*t + c  ; r.m[ 1] = x*y*t - z*s; r.m[ 2] = x*z*t + y*s;
+	r.m[ 4] = y*x*t + z*s; r.m[ 5] = y*y*t + c  ; r.m[ 6] = y*z*t - x*s;
+	r.m[ 8] = z*x*t - y*s; r.m[ 9] = z*y*t + x*s; r.m[10] = z*z*t + c  ;
+	r.m[15] = 1.0f;
+
+	lw_mat4_multiply(self, self, &r);
+}
+
+/**
+ * lw_mat4_scale:
+ * @self: A #LwMat4
+ * @x: Scale factor along the x axis
+ * @y: Scale factor along the y axis
+ * @z: Scale factor along the z axis
+ *
+ * Multiplies @self by a scaling matrix. See lw_matrix_scale().
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_scale(LwMat4 *self, gfloat x, gfloat y, gfloat z)
+{
+	gfloat *m = self->m;
+
+	m[ 0] = x * m[ 0]; m[ 1] = y * m[ 1]; m[ 2] = z * m[ 2];
+	m[ 4] = x * m[ 4]; m[ 5] = y * m[ 5]; m[ 6] = z * m[ 6];
+	m[ 8] = x * m[ 8]; m[ 9] = y * m[ 9]; m[10] = z * m[10];
+	m[12] = x * m[12]; m[13] = y * m[13]; m[14] = z * m[14];
+}
+
+/**
+ * lw_mat4_multiply:
+ * @result: (out caller-allocates): Return location for @a * @b
+ * @a: The left operand
+ * @b: The right operand
+ *
+ * Multiplies @a with @b. @result may point to @a or @b.
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_multiply(LwMat4 *result, const LwMat4 *a, const LwMat4 *b)
+{
+	lw_mat4_get_kernels()->multiply(result, a, b);
+}
+
+/**
+ * lw_mat4_invert:
+ * @result: (out caller-allocates): Return location for the inverse of @m
+ * @m: A #LwMat4
+ *
+ * Inverts @m. @result may point to @m. If @m is singular, @result stays unchanged.
+ *
+ * Returns: %TRUE if @m could be inverted, %FALSE otherwise
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_mat4_invert(LwMat4 *result, const LwMat4 *m)
+{
+	return lw_mat4_get_kernels()->invert(result, m);
+}
+
+/**
+ * lw_mat4_transform_points:
+ * @self: A #LwMat4
+ * @points: (array): @n_points points, each one as four floats (x, y, z, w)
+ * @result: (array): Return location for the transformed points, may be the same as @points
+ * @n_points: Number of points
+ *
+ * Multiplies @self with each of the points.
+ *
+ * Since: 0.6
+ */
+void
+lw_mat4_transform_points(const LwMat4 *self, const gfloat *points, gfloat *result, guint n_points)
+{
+	lw_mat4_get_kernels()->transform_points(self, points, result, n_points);
+}
@@ -0,0 +1,223 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#include <livewallpaper/core.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define LW_MATH_X86
+#include <immintrin.h>
+/* The kernels are only used if the CPU supports the instruction set */
+#define LW_MATH_SSE2_TARGET __attribute__((target("sse2")))
+#define LW_MATH_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LW_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+ * All kernels do the same single precision operations in the same order, so
+ * they return the same bits. The values may differ slightly from the ones of
+ * lw_sin() and lw_cos() because they multiply by the reciprocal of the step.
+ */
+typedef void (*LwSincosFunc)(const gfloat *angle, gfloat *s, gfloat *c, gsize n);
+
+static void
+lw_sincos_batch_scalar(const gfloat *angle, gfloat *s, gfloat *c, gsize n)
+{
+	const gfloat scale = 1.0f / step;
+	const gint mask = 4 * sin_steps - 1;
+	gsize k;
+
+	for(k = 0; k < n; k++)
+	{
+		gfloat x = angle[k] * scale, f;
+		gint i = (gint) x, is, ic;
+
+		i -= (gfloat) i > x;
+		f = x - (gfloat) i;
+		is = i & mask;
+		ic = (i + sin_steps) & mask;
+
+		s[k] = sin_values[is] + f * (sin_values[is + 1] - sin_values[is]);
+		c[k] = sin_values[ic] + f * (sin_values[ic + 1] - sin_values[ic]);
+	}
+}
+
+#ifdef LW_MATH_X86
+
+/* SSE2 has no gather, so only the table lookups are done per element */
+static void LW_MATH_SSE2_TARGET
+lw_sincos_batch_sse2(const gfloat *angle, gfloat *s, gfloat *c, gsize n)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / step);
+	const __m128i mask = _mm_set1_epi32(4 * sin_steps - 1), quarter = _mm_set1_epi32(sin_steps);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		__m128 x = _mm_mul_ps(_mm_loadu_ps(angle + k), scale), f;
+		__m128i i = _mm_cvttps_epi32(x);
+		gint is[4], ic[4];
+
+		i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), x)));
+		f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+		_mm_storeu_si128((__m128i*) is, _mm_and_si128(i, mask));
+		_mm_storeu_si128((__m128i*) ic, _mm_and_si128(_mm_add_epi32(i, quarter), mask));
+
+#define LW_SSE2_LERP(idx) \
+		_mm_add_ps(_mm_setr_ps(sin_values[idx[0]], sin_values[idx[1]], sin_values[idx[2]], sin_values[idx[3]]), \
+		           _mm_mul_ps(f, _mm_sub_ps(_mm_setr_ps(sin_values[idx[0] + 1], sin_values[idx[1] + 1], \
+		                                                sin_values[idx[2] + 1], sin_values[idx[3] + 1]), \
+		                                    _mm_setr_ps(sin_values[idx[0]], sin_values[idx[1]], \
+		                                                sin_values[idx[2]], sin_values[idx[3]]))))
+
+		_mm_storeu_ps(s + k, LW_SSE2_LERP(is));
+		_mm_storeu_ps(c + k, LW_SSE2_LERP(ic));
+
+#undef LW_SSE2_LERP
+	}
+
+	lw_sincos_batch_scalar(angle + k, s + k, c + k, n - k);
+}
+
+static void LW_MATH_AVX2_TARGET
+lw_sincos_batch_avx2(const gfloat *angle, gfloat *s, gfloat *c, gsize n)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / step);
+	const __m256i mask = _mm256_set1_epi32(4 * sin_steps - 1), quarter = _mm256_set1_epi32(sin_steps);
+	gsize k;
+
+	for(k = 0; k + 8 <= n; k += 8)
+	{
+		__m256 x = _mm256_mul_ps(_mm256_loadu_ps(angle + k), scale), f, v0, v1;
+		__m256i i = _mm256_cvttps_epi32(x), is, ic;
+
+		i = _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(i), x, _CMP_GT_OQ)));
+		f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(i));
+		is = _mm256_and_si256(i, mask);
+		ic = _mm256_and_si256(_mm256_add_epi32(i, quarter), mask);
+
+		v0 = _mm256_i32gather_ps(sin_values, is, 4);
+		v1 = _mm256_i32gather_ps(sin_values + 1, is, 4);
+		_mm256_storeu_ps(s + k, _mm256_add_ps(v0, _mm256_mul_ps(f, _mm256_sub_ps(v1, v0))));
+
+		v0 = _mm256_i32gather_ps(sin_values, ic, 4);
+		v1 = _mm256_i32gather_ps(sin_values + 1, ic, 4);
+		_mm256_storeu_ps(c + k, _mm256_add_ps(v0, _mm256_mul_ps(f, _mm256_sub_ps(v1, v0))));
+	}
+
+	lw_sincos_batch_sse2(angle + k, s + k, c + k, n - k);
+}
+
+#endif /* LW_MATH_X86 */
+
+#ifdef LW_MATH_NEON
+
+static float32x4_t
+lw_sincos_lerp_neon(const gint *idx, float32x4_t f)
+{
+	gfloat v[8];
+	float32x4_t v0, v1;
+	gint l;
+
+	for(l = 0; l < 4; l++)
+	{
+		v[l] = sin_values[idx[l]];
+		v[l + 4] = sin_values[idx[l] + 1];
+	}
+	v0 = vld1q_f32(v);
+	v1 = vld1q_f32(v + 4);
+
+	return vaddq_f32(v0, vmulq_f32(f, vsubq_f32(v1, v0)));
+}
+
+/* NEON has no gather, so only the table lookups are done per element */
+static void
+lw_sincos_batch_neon(const gfloat *angle, gfloat *s, gfloat *c, gsize n)
+{
+	const float32x4_t scale = vdupq_n_f32(1.0f / step);
+	const int32x4_t mask = vdupq_n_s32(4 * sin_steps - 1), quarter = vdupq_n_s32(sin_steps);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		float32x4_t x = vmulq_f32(vld1q_f32(angle + k), scale), f;
+		int32x4_t i = vcvtq_s32_f32(x);
+		gint is[4], ic[4];
+
+		i = vaddq_s32(i, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(i), x)));
+		f = vsubq_f32(x, vcvtq_f32_s32(i));
+		vst1q_s32(is, vandq_s32(i, mask));
+		vst1q_s32(ic, vandq_s32(vaddq_s32(i, quarter), mask));
+
+		vst1q_f32(s + k, lw_sincos_lerp_neon(is, f));
+		vst1q_f32(c + k, lw_sincos_lerp_neon(ic, f));
+	}
+
+	lw_sincos_batch_scalar(angle + k, s + k, c + k, n - k);
+}
+
+#endif /* LW_MATH_NEON */
+
+static LwSincosFunc
+lw_sincos_get_kernel(void)
+{
+	static LwSincosFunc kernel = NULL;
+	static gsize initialized = 0;
+
+	if(g_once_init_enter(&initialized))
+	{
+		kernel = lw_sincos_batch_scalar;
+
+#if defined(LW_MATH_X86)
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2"))
+			kernel = lw_sincos_batch_avx2;
+		else if(__builtin_cpu_supports("sse2"))
+			kernel = lw_sincos_batch_sse2;
+#elif defined(LW_MATH_NEON)
+		kernel = lw_sincos_batch_neon;
+#endif
+
+		g_once_init_leave(&initialized, 1);
+	}
+
+	return kernel;
+}
+
+/**
+ * lw_sincos_batch:
+ * @angle: (array length=n): The angles in radians
+ * @s: (array length=n): Return location for the sine values
+ * @c: (array length=n): Return location for the cosine values
+ * @n: Number of angles
+ *
+ * Calculates the sine and cosine values of @n angles by interpolating in the same
+ * lookup table as lw_sin() and lw_cos(). It uses SSE2, AVX2 or NEON if the CPU
+ * supports it and returns the same values on every CPU.
+ *
+ * Since: 0.6
+ */
+void
+lw_sincos_batch(const gfloat *angle, gfloat *s, gfloat *c, gsize n)
+{
+	lw_sincos_get_kernel()(angle, s, c, n);
+}
@@ -25,16 +25,17 @@
  * SECTION: matrix
  * @Short_description: A 4x4 matrix class
  *
- * #LwMatrix provides some basic matrix functionality.
+ * #LwMatrix provides some basic matrix functionality. It is a wrapper around a #LwMat4
+ * with a stack for lw_matrix_push() and lw_matrix_pop(). Once the stack has grown to
+ * its maximum depth, none of the functions allocate memory.
  */
 
-#include <math.h>
 #include <livewallpaper/core.h>
 
 struct _LwMatrixPrivate
 {
-	gfloat *data;
-	GSList *stack;
+	LwMat4 data;
+	GArray *stack;
 };
 
 /**
@@ -47,11 +48,6 @@ struct _LwMatrixPrivate
 
 G_DEFINE_TYPE(LwMatrix, lw_matrix, G_TYPE_OBJECT)
 
-gfloat identity[] = {1, 0, 0, 0,
-                     0, 1, 0, 0,
-                     0, 0, 1, 0,
-                     0, 0, 0, 1};
-
 /**
  * lw_matrix_new:
  *
@@ -78,49 +74,21 @@ lw_matrix_new()
 gfloat*
 lw_matrix_get_elements(LwMatrix *self)
 {
-	return self->priv->data;
+	return self->priv->data.m;
 }
 
-static void
-lw_matrix_multiply_real(gfloat *a, gfloat *b)
+/**
+ * lw_matrix_get_mat4:
+ * @self: A #LwMatrix
+ *
+ * Returns: (transfer none): The #LwMat4 holding the current matrix
+ *
+ * Since: 0.6
+ */
+LwMat4*
+lw_matrix_get_mat4(LwMatrix *self)
 {
-	gfloat *t = g_slice_copy(sizeof(identity), a);
-
-	/*
-	 * The following matrix multiplication code was generated by these loops:
-	 *     int i, j, r, c;
-	 *     for(i = 0; i < 16; i++)
-	 *     {
-	 *         r = i / 4;
-	 *         c = i % 4;
-	 *         printf("a[%2d] =", i);
-	 *         for(j = 0; j < 4; j++)
-	 *         {
-	 *             printf(" t[%2d] * b[%2d]", 4 * r + j, c + 4 * j);
-	 *             if(j != 3) printf(" +");
-	 *         }
-	 *         printf(";\n");
-	 *     }
-	 */
-
-	a[ 0] = t[ 0] * b[ 0] + t[ 1] * b[ 4] + t[ 2] * b[ 8] + t[ 3] * b[12];
-	a[ 1] = t[ 0] * b[ 1] + t[ 1] * b[ 5] + t[ 2] * b[ 9] + t[ 3] * b[13];
-	a[ 2] = t[ 0] * b[ 2] + t[ 1] * b[ 6] + t[ 2] * b[10] + t[ 3] * b[14];
-	a[ 3] = t[ 0] * b[ 3] + t[ 1] * b[ 7] + t[ 2] * b[11] + t[ 3] * b[15];
-	a[ 4] = t[ 4] * b[ 0] + t[ 5] * b[ 4] + t[ 6] * b[ 8] + t[ 7] * b[12];
-	a[ 5] = t[ 4] * b[ 1] + t[ 5] * b[ 5] + t[ 6] * b[ 9] + t[ 7] * b[13];
-	a[ 6] = t[ 4] * b[ 2] + t[ 5] * b[ 6] + t[ 6] * b[10] + t[ 7] * b[14];
-	a[ 7] = t[ 4] * b[ 3] + t[ 5] * b[ 7] + t[ 6] * b[11] + t[ 7] * b[15];
-	a[ 8] = t[ 8] * b[ 0] + t[ 9] * b[ 4] + t[10] * b[ 8] + t[11] * b[12];
-	a[ 9] = t[ 8] * b[ 1] + t[ 9] * b[ 5] + t[10] * b[ 9] + t[11] * b[13];
-	a[10] = t[ 8] * b[ 2] + t[ 9] * b[ 6] + t[10] * b[10] + t[11] * b[14];
-	a[11] = t[ 8] * b[ 3] + t[ 9] * b[ 7] + t[10] * b[11] + t[11] * b[15];
-	a[12] = t[12] * b[ 0] + t[13] * b[ 4] + t[14] * b[ 8] + t[15] * b[12];
-	a[13] = t[12] * b[ 1] + t[13] * b[ 5] + t[14] * b[ 9] + t[15] * b[13];
-	a[14] = t[12] * b[ 2] + t[13] * b[ 6] + t[14] * b[10] + t[15] * b[14];
-	a[15] = t[12] * b[ 3] + t[13] * b[ 7] + t[14] * b[11] + t[15] * b[15];
-
-	g_slice_free1(sizeof(identity), t);
+	return &self->priv->data;
 }
 
 #if 0
@@ -128,7 +96,7 @@ lw_matrix_multiply_real(gfloat *a, gfloat *b)
 void
 lw_matrix_print(LwMatrix *self)
 {
-	gfloat *m = self->priv->data;
+	gfloat *m = self->priv->data.m;
 	int i;
 
 	for(i = 0; i < 16; i++)
@@ -163,25 +131,7 @@ lw_matrix_ortho(LwMatrix *self,
                 gfloat bottom, gfloat top,
                 gfloat nearVal, gfloat farVal)
 {
-	gfloat *o;
-
-	g_return_if_fail(left != right);
-	g_return_if_fail(bottom != top);
-	g_return_if_fail(nearVal != farVal);
-	g_return_if_fail(nearVal >= 0 && farVal >= 0);
-
-	o = g_slice_alloc0(sizeof(identity));
-
-	o[ 0] = 2.0f / (right - left);
-	o[ 3] = - (right + left) / (right - left);
-	o[ 5] = 2.0f / (top - bottom);
-	o[ 7] = - (top + bottom) / (top - bottom);
-	o[10] = - 2.0f / (farVal - nearVal);
-	o[11] = - (farVal + nearVal) / (farVal - nearVal);
-	o[15] = 1.0f;
-
-	lw_matrix_multiply_real(self->priv->data, o);
-	g_slice_free1(sizeof(identity), o);
+	lw_mat4_ortho(&self->priv->data, left, right, bottom, top, nearVal, farVal);
 }
 
 /**
@@ -208,24 +158,7 @@ lw_matrix_frustum(LwMatrix *self,
                   gfloat bottom, gfloat top,
                   gfloat nearVal, gfloat farVal)
 {
-	gfloat *f;
-
-	g_return_if_fail(left != right);
-	g_return_if_fail(bottom != top);
-	g_return_if_fail(nearVal != farVal);
-
-	f = g_slice_alloc0(sizeof(identity));
-
-	f[ 0] = 2.0f * nearVal / (right - left);
-	f[ 2] = (right + left) / (right - left);
-	f[ 5] = 2.0f * nearVal / (top - bottom);
-	f[ 6] = (top + bottom) / (top - bottom);
-	f[10] = - (farVal + nearVal) / (farVal - nearVal);
-	f[11] = - 2.0f * farVal * nearVal / (farVal - nearVal);
-	f[14] = - 1.0f;
-
-	lw_matrix_multiply_real(self->priv->data, f);
-	g_slice_free1(sizeof(identity), f);
+	lw_mat4_frustum(&self->priv->data, left, right, bottom, top, nearVal, farVal);
 }
 
 /**
@@ -246,12 +179,7 @@ lw_matrix_frustum(LwMatrix *self,
 void
 lw_matrix_translate(LwMatrix *self, gfloat x, gfloat y, gfloat z)
 {
-	gfloat *m = self->priv->data;
-
-	m[ 3] = x * m[ 0] + y * m[ 1] + z * m[ 2] + m[ 3];
-	m[ 7] = x * m[ 4] + y * m[ 5] + z * m[ 6] + m[ 7];
-	m[11] = x * m[ 8] + y * m[ 9] + z * m[10] + m[11];
-	m[15] = x * m[12] + y * m[13] + z * m[14] + m[15];
+	lw_mat4_translate(&self->priv->data, x, y, z);
 }
 
 /**
@@ -273,22 +201,7 @@ lw_matrix_translate(LwMatrix *self, gfloat x, gfloat y, gfloat z)
 void
 lw_matrix_rotate(LwMatrix *self, gfloat angle, gfloat x, gfloat y, gfloat z)
 {
-	gfloat *r = g_slice_alloc0(sizeof(identity));
-	gfloat c = cos(angle), s = sin(angle), t = 1.0f - c;
-
-	/* normalize vector */
-	gfloat magnitude = sqrt(x*x + y*y + z*z);
-	x = x / magnitude;
-	y = y / magnitude;
-	z = z / magnitude;
-
-	r[ 0] = x*x*t + c  ; r[ 1] = x*y*t - z*s; r[ 2] = x*z*t + y*s;
-	r[ 4] = y*x*t + z*s; r[ 5] = y*y*t + c  ; r[ 6] = y*z*t - x*s;
-	r[ 8] = z*x*t - y*s; r[ 9] = z*y*t + x*s; r[10] = z*z*t + c  ;
-	r[15] = 1.0f;
-
-	lw_matrix_multiply_real(self->priv->data, r);
-	g_slice_free1(sizeof(identity), r);
+	lw_mat4_rotate(&self->priv->data, angle, x, y, z);
 }
 
 /**
@@ -309,12 +222,7 @@ lw_matrix_rotate(LwMatrix *self, gfloat angle, gfloat x, gfloat y, gfloat z)
 void
 lw_matrix_scale(LwMatrix *self, gfloat x, gfloat y, gfloat z)
 {
-	gfloat *m = self->priv->data;
-
-	m[ 0] = x * m[ 0]; m[ 1] = y * m[ 1]; m[ 2] = z * m[ 2];
-	m[ 4] = x * m[ 4]; m[ 5] = y * m[ 5]; m[ 6] = z * m[ 6];
-	m[ 8] = x * m[ 8]; m[ 9] = y * m[ 9]; m[10] = z * m[10];
-	m[12] = x * m[12]; m[13] = y * m[13]; m[14] = z * m[14];
+	lw_mat4_scale(&self->priv->data, x, y, z);
 }
 
 /**
@@ -329,7 +237,7 @@ lw_matrix_scale(LwMatrix *self, gfloat x, gfloat y, gfloat z)
 void
 lw_matrix_multiply(LwMatrix *self, LwMatrix *other)
 {
-	lw_matrix_multiply_real(self->priv->data, other->priv->data);
+	lw_mat4_multiply(&self->priv->data, &self->priv->data, &other->priv->data);
 }
 
 /**
@@ -346,9 +254,7 @@ lw_matrix_multiply(LwMatrix *self, LwMatrix *other)
 void
 lw_matrix_push(LwMatrix *self)
 {
-	self->priv->stack = g_slist_prepend(self->priv->stack,
-	                                    g_slice_copy(sizeof(identity),
-	                                                 self->priv->data));
+	g_array_append_val(self->priv->stack, self->priv->data);
 }
 
 /**
@@ -365,21 +271,17 @@ lw_matrix_push(LwMatrix *self)
 void
 lw_matrix_pop(LwMatrix *self)
 {
-	if(self->priv->stack == NULL)
+	guint len = self->priv->stack->len;
+
+	if(len == 0)
 	{
 		g_warning("lw_matrix_pop(): The stack is empty. Make sure to call lw_matrix_push() first.");
 		return;
 	}
 
-	/* Free current matrix */
-	g_slice_free1(sizeof(identity), self->priv->data);
-
-	/* Get matrix on top of the stack */
-	self->priv->data = self->priv->stack->data;
-
-	/* Free first node of the stack */
-	self->priv->stack = g_slist_delete_link(self->priv->stack,
-	                                        self->priv->stack);
+	/* Get matrix on top of the stack, shrinking the array keeps its memory */
+	self->priv->data = g_array_index(self->priv->stack, LwMat4, len - 1);
+	g_array_set_size(self->priv->stack, len - 1);
 }
 
 static void
@@ -388,13 +290,8 @@ lw_matrix_init(LwMatrix *self)
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_MATRIX,
 	                                         LwMatrixPrivate);
 
-	self->priv->data = g_slice_copy(sizeof(identity), &identity);
-}
-
-static void
-lw_matrix_data_free(gpointer data)
-{
-	g_slice_free1(sizeof(identity), data);
+	lw_mat4_init_identity(&self->priv->data);
+	self->priv->stack = g_array_new(FALSE, FALSE, sizeof(LwMat4));
 }
 
 static void
@@ -402,8 +299,7 @@ lw_matrix_finalize(GObject *object)
 {
 	LwMatrix *self = LW_MATRIX(object);
 
-	g_slice_free1(sizeof(identity), self->priv->data);
-	g_slist_free_full(self->priv->stack, lw_matrix_data_free);
+	g_array_free(self->priv->stack, TRUE);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(lw_matrix_parent_class)->finalize(object);
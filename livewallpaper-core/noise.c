@@ -34,20 +34,410 @@
  * @Title: Noise
  *
  * These functions may help you to add some randomness to your live wallpapers.
+ *
+ * If you need noise values for many positions at once, e.g. one for each particle,
+ * use lw_simplex_noise_2f_batch(). It uses SSE2, AVX2 or NEON if the CPU supports
+ * it and returns exactly the same values as lw_simplex_noise_2f() on every CPU.
+ * Setting the environment variable LW_NOISE_KERNEL to scalar, sse2, avx2 or neon
+ * restricts it to that kernel, which is used to test each of them.
  */
 
 #include <math.h>
 #include <livewallpaper/core.h>
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define LW_NOISE_X86
+#include <immintrin.h>
+/* The kernels are only used if the CPU supports the instruction set */
+#define LW_NOISE_SSE2_TARGET __attribute__((target("sse2")))
+#define LW_NOISE_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LW_NOISE_NEON
+#include <arm_neon.h>
+#endif
+
 /* Permutation and gradient table */
 #define PERM_SIZE 256
+#define PERM_MASK (PERM_SIZE - 1)
 
 static int perm[2 * PERM_SIZE];
-static float grad[PERM_SIZE][2];
+static float grad_x[PERM_SIZE];
+static float grad_y[PERM_SIZE];
 
 /* Skewing and unskewing factors */
 #define F2 0.36602540f
 #define G2 0.21132486f
+#define G2_2 0.42264973f
+
+/*
+ * All kernels do exactly the same single precision operations in the same
+ * order and without fused multiply-adds, so they return the same bits.
+ */
+typedef void (*LwNoiseBatchFunc)(const float *x, const float *y, float *out, gsize n);
+
+static void lw_simplex_noise_2f_batch_scalar(const float *x, const float *y, float *out, gsize n);
+
+static LwNoiseBatchFunc batch_kernel = lw_simplex_noise_2f_batch_scalar;
+
+/* floor() for values in the range of int, (int) rounds towards zero */
+static int
+lw_noise_floor(float v)
+{
+	int i = (int) v;
+	return (float) i > v ? i - 1 : i;
+}
+
+/* Contribution of a simplex corner with the distance (x, y) and the gradient gi */
+static float
+lw_noise_corner(float x, float y, int gi)
+{
+	float t = (0.5f - x * x) - y * y;
+
+	if(t < 0.0f)
+		t = 0.0f;
+	t = t * t;
+
+	return (t * t) * (grad_x[gi] * x + grad_y[gi] * y);
+}
+
+static float
+lw_simplex_noise_2f_real(float x, float y)
+{
+	float t;
+
+	/* Noise contributions from the three corners */
+	float n0, n1, n2;
+
+	/* The distances from the cell origin in (x,y) unskewed coords */
+	float x0, y0, x1, y1, x2, y2;
+
+	/* x and y skewed to (i,j) coords */
+	int i, j;
+
+	/* Offsets for second (middle) corner of simplex in (i,j) coords */
+	int i1, j1;
+
+	/* Gradient table indices */
+	int gi0, gi1, gi2;
+
+	/* Skew the input space to determine which simplex cell we're in */
+	t = (x + y) * F2;
+	i = lw_noise_floor(x + t);
+	j = lw_noise_floor(y + t);
+
+	/* Unskew the cell origin back to (x, y) space */
+	t = (float) (i + j) * G2;
+	/* X0 = i - t; Y0 = j - t; */
+
+	x0 = (x - (float) i) + t; /* x - X0 */
+	y0 = (y - (float) j) + t; /* y - Y0 */
+
+	/* For the 2D case, the simplex shape is an equilateral triangle.
+	 * Determine which simplex we are in: the lower triangle with the
+	 * XY order (0,0)->(1,0)->(1,1) or the upper one with the YX order
+	 * (0,0)->(0,1)->(1,1). */
+	i1 = x0 > y0;
+	j1 = 1 - i1;
+
+	/* A step of (1,0) in (i,j) means a step of (1-G2,-G2) in (x,y) and
+	 * a step of (0,1) in (i,j) means a step of (-G2,1-G2) in (x,y). */
+	x1 = (x0 - (float) i1) + G2;
+	y1 = (y0 - (float) j1) + G2;
+	x2 = (x0 - 1.0f) + G2_2;
+	y2 = (y0 - 1.0f) + G2_2;
+
+	/* Work out the hashed gradient indices of the three simplex corners */
+	i &= PERM_MASK;
+	j &= PERM_MASK;
+	gi0 = perm[i + perm[j]];
+	gi1 = perm[i + i1 + perm[j + j1]];
+	gi2 = perm[i + 1  + perm[j + 1 ]];
+
+	/* Calculate the contribution from the three corners */
+	n0 = lw_noise_corner(x0, y0, gi0);
+	n1 = lw_noise_corner(x1, y1, gi1);
+	n2 = lw_noise_corner(x2, y2, gi2);
+
+	/* Add contributions from each corner to get the final noise value.
+	 * The result is scaled to return values in the interval [-1;1]. */
+	return 70.0f * ((n0 + n1) + n2);
+}
+
+static void
+lw_simplex_noise_2f_batch_scalar(const float *x, const float *y, float *out, gsize n)
+{
+	gsize k;
+
+	for(k = 0; k < n; k++)
+		out[k] = lw_simplex_noise_2f_real(x[k], y[k]);
+}
+
+#ifdef LW_NOISE_X86
+
+static __m128 LW_NOISE_SSE2_TARGET
+lw_noise_corner_sse2(__m128 x, __m128 y, const int *gi)
+{
+	__m128 gx = _mm_setr_ps(grad_x[gi[0]], grad_x[gi[1]], grad_x[gi[2]], grad_x[gi[3]]);
+	__m128 gy = _mm_setr_ps(grad_y[gi[0]], grad_y[gi[1]], grad_y[gi[2]], grad_y[gi[3]]);
+	__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+
+	t = _mm_max_ps(t, _mm_setzero_ps());
+	t = _mm_mul_ps(t, t);
+
+	return _mm_mul_ps(_mm_mul_ps(t, t), _mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y)));
+}
+
+/* Like lw_noise_floor(), the comparison mask is -1 where truncation rounded up */
+static __m128i LW_NOISE_SSE2_TARGET
+lw_noise_floor_sse2(__m128 v)
+{
+	__m128i i = _mm_cvttps_epi32(v);
+	return _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), v)));
+}
+
+/* SSE2 has no gather, so only the hashing is done per element */
+static void LW_NOISE_SSE2_TARGET
+lw_simplex_noise_2f_batch_sse2(const float *x, const float *y, float *out, gsize n)
+{
+	const __m128 one = _mm_set1_ps(1.0f), g2 = _mm_set1_ps(G2), g2_2 = _mm_set1_ps(G2_2);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		__m128 vx = _mm_loadu_ps(x + k), vy = _mm_loadu_ps(y + k);
+		__m128 t, x0, y0, x1, y1, x2, y2, mask, i1f, n0, n1, n2;
+		__m128i i, j;
+		int ii[4], jj[4], i1[4], gi0[4], gi1[4], gi2[4];
+		int l;
+
+		t = _mm_mul_ps(_mm_add_ps(vx, vy), _mm_set1_ps(F2));
+		i = lw_noise_floor_sse2(_mm_add_ps(vx, t));
+		j = lw_noise_floor_sse2(_mm_add_ps(vy, t));
+
+		t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), g2);
+		x0 = _mm_add_ps(_mm_sub_ps(vx, _mm_cvtepi32_ps(i)), t);
+		y0 = _mm_add_ps(_mm_sub_ps(vy, _mm_cvtepi32_ps(j)), t);
+
+		mask = _mm_cmpgt_ps(x0, y0);
+		i1f = _mm_and_ps(mask, one);
+
+		x1 = _mm_add_ps(_mm_sub_ps(x0, i1f), g2);
+		y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_sub_ps(one, i1f)), g2);
+		x2 = _mm_add_ps(_mm_sub_ps(x0, one), g2_2);
+		y2 = _mm_add_ps(_mm_sub_ps(y0, one), g2_2);
+
+		_mm_storeu_si128((__m128i*) ii, i);
+		_mm_storeu_si128((__m128i*) jj, j);
+		_mm_storeu_si128((__m128i*) i1, _mm_cvttps_epi32(i1f));
+
+		for(l = 0; l < 4; l++)
+		{
+			int pi = ii[l] & PERM_MASK, pj = jj[l] & PERM_MASK;
+
+			gi0[l] = perm[pi + perm[pj]];
+			gi1[l] = perm[pi + i1[l] + perm[pj + 1 - i1[l]]];
+			gi2[l] = perm[pi + 1 + perm[pj + 1]];
+		}
+
+		n0 = lw_noise_corner_sse2(x0, y0, gi0);
+		n1 = lw_noise_corner_sse2(x1, y1, gi1);
+		n2 = lw_noise_corner_sse2(x2, y2, gi2);
+
+		_mm_storeu_ps(out + k, _mm_mul_ps(_mm_set1_ps(70.0f), _mm_add_ps(_mm_add_ps(n0, n1), n2)));
+	}
+
+	lw_simplex_noise_2f_batch_scalar(x + k, y + k, out + k, n - k);
+}
+
+static __m256 LW_NOISE_AVX2_TARGET
+lw_noise_corner_avx2(__m256 x, __m256 y, __m256i gi)
+{
+	__m256 gx = _mm256_i32gather_ps(grad_x, gi, 4);
+	__m256 gy = _mm256_i32gather_ps(grad_y, gi, 4);
+	__m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+
+	t = _mm256_max_ps(t, _mm256_setzero_ps());
+	t = _mm256_mul_ps(t, t);
+
+	return _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y)));
+}
+
+static __m256i LW_NOISE_AVX2_TARGET
+lw_noise_floor_avx2(__m256 v)
+{
+	__m256i i = _mm256_cvttps_epi32(v);
+	return _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(i), v, _CMP_GT_OQ)));
+}
+
+static void LW_NOISE_AVX2_TARGET
+lw_simplex_noise_2f_batch_avx2(const float *x, const float *y, float *out, gsize n)
+{
+	const __m256 one = _mm256_set1_ps(1.0f), g2 = _mm256_set1_ps(G2), g2_2 = _mm256_set1_ps(G2_2);
+	const __m256i mask_perm = _mm256_set1_epi32(PERM_MASK), one_i = _mm256_set1_epi32(1);
+	gsize k;
+
+	for(k = 0; k + 8 <= n; k += 8)
+	{
+		__m256 vx = _mm256_loadu_ps(x + k), vy = _mm256_loadu_ps(y + k);
+		__m256 t, x0, y0, x1, y1, x2, y2, i1f, n0, n1, n2;
+		__m256i i, j, i1, gi0, gi1, gi2;
+
+		t = _mm256_mul_ps(_mm256_add_ps(vx, vy), _mm256_set1_ps(F2));
+		i = lw_noise_floor_avx2(_mm256_add_ps(vx, t));
+		j = lw_noise_floor_avx2(_mm256_add_ps(vy, t));
+
+		t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), g2);
+		x0 = _mm256_add_ps(_mm256_sub_ps(vx, _mm256_cvtepi32_ps(i)), t);
+		y0 = _mm256_add_ps(_mm256_sub_ps(vy, _mm256_cvtepi32_ps(j)), t);
+
+		i1f = _mm256_and_ps(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ), one);
+		i1 = _mm256_cvttps_epi32(i1f);
+
+		x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1f), g2);
+		y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_sub_ps(one, i1f)), g2);
+		x2 = _mm256_add_ps(_mm256_sub_ps(x0, one), g2_2);
+		y2 = _mm256_add_ps(_mm256_sub_ps(y0, one), g2_2);
+
+		/* Hash with gathers from the permutation table */
+		i = _mm256_and_si256(i, mask_perm);
+		j = _mm256_and_si256(j, mask_perm);
+		gi0 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(i, _mm256_i32gather_epi32(perm, j, 4)), 4);
+		gi1 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(i, i1),
+		                             _mm256_i32gather_epi32(perm, _mm256_sub_epi32(_mm256_add_epi32(j, one_i), i1), 4)), 4);
+		gi2 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(i, one_i),
+		                             _mm256_i32gather_epi32(perm, _mm256_add_epi32(j, one_i), 4)), 4);
+
+		n0 = lw_noise_corner_avx2(x0, y0, gi0);
+		n1 = lw_noise_corner_avx2(x1, y1, gi1);
+		n2 = lw_noise_corner_avx2(x2, y2, gi2);
+
+		_mm256_storeu_ps(out + k, _mm256_mul_ps(_mm256_set1_ps(70.0f), _mm256_add_ps(_mm256_add_ps(n0, n1), n2)));
+	}
+
+	lw_simplex_noise_2f_batch_sse2(x + k, y + k, out + k, n - k);
+}
+
+#endif /* LW_NOISE_X86 */
+
+#ifdef LW_NOISE_NEON
+
+static float32x4_t
+lw_noise_corner_neon(float32x4_t x, float32x4_t y, const int *gi)
+{
+	float g[8];
+	float32x4_t gx, gy, t;
+	int l;
+
+	for(l = 0; l < 4; l++)
+	{
+		g[l] = grad_x[gi[l]];
+		g[l + 4] = grad_y[gi[l]];
+	}
+	gx = vld1q_f32(g);
+	gy = vld1q_f32(g + 4);
+
+	t = vsubq_f32(vsubq_f32(vdupq_n_f32(0.5f), vmulq_f32(x, x)), vmulq_f32(y, y));
+	t = vmaxq_f32(t, vdupq_n_f32(0.0f));
+	t = vmulq_f32(t, t);
+
+	return vmulq_f32(vmulq_f32(t, t), vaddq_f32(vmulq_f32(gx, x), vmulq_f32(gy, y)));
+}
+
+static int32x4_t
+lw_noise_floor_neon(float32x4_t v)
+{
+	int32x4_t i = vcvtq_s32_f32(v);
+	return vaddq_s32(i, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(i), v)));
+}
+
+/* NEON has no gather, so only the hashing is done per element */
+static void
+lw_simplex_noise_2f_batch_neon(const float *x, const float *y, float *out, gsize n)
+{
+	const float32x4_t one = vdupq_n_f32(1.0f), g2 = vdupq_n_f32(G2), g2_2 = vdupq_n_f32(G2_2);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		float32x4_t vx = vld1q_f32(x + k), vy = vld1q_f32(y + k);
+		float32x4_t t, x0, y0, x1, y1, x2, y2, i1f, n0, n1, n2;
+		int32x4_t i, j;
+		int ii[4], jj[4], i1[4], gi0[4], gi1[4], gi2[4];
+		int l;
+
+		t = vmulq_f32(vaddq_f32(vx, vy), vdupq_n_f32(F2));
+		i = lw_noise_floor_neon(vaddq_f32(vx, t));
+		j = lw_noise_floor_neon(vaddq_f32(vy, t));
+
+		t = vmulq_f32(vcvtq_f32_s32(vaddq_s32(i, j)), g2);
+		x0 = vaddq_f32(vsubq_f32(vx, vcvtq_f32_s32(i)), t);
+		y0 = vaddq_f32(vsubq_f32(vy, vcvtq_f32_s32(j)), t);
+
+		i1f = vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(x0, y0), vreinterpretq_u32_f32(one)));
+
+		x1 = vaddq_f32(vsubq_f32(x0, i1f), g2);
+		y1 = vaddq_f32(vsubq_f32(y0, vsubq_f32(one, i1f)), g2);
+		x2 = vaddq_f32(vsubq_f32(x0, one), g2_2);
+		y2 = vaddq_f32(vsubq_f32(y0, one), g2_2);
+
+		vst1q_s32(ii, i);
+		vst1q_s32(jj, j);
+		vst1q_s32(i1, vcvtq_s32_f32(i1f));
+
+		for(l = 0; l < 4; l++)
+		{
+			int pi = ii[l] & PERM_MASK, pj = jj[l] & PERM_MASK;
+
+			gi0[l] = perm[pi + perm[pj]];
+			gi1[l] = perm[pi + i1[l] + perm[pj + 1 - i1[l]]];
+			gi2[l] = perm[pi + 1 + perm[pj + 1]];
+		}
+
+		n0 = lw_noise_corner_neon(x0, y0, gi0);
+		n1 = lw_noise_corner_neon(x1, y1, gi1);
+		n2 = lw_noise_corner_neon(x2, y2, gi2);
+
+		vst1q_f32(out + k, vmulq_f32(vdupq_n_f32(70.0f), vaddq_f32(vaddq_f32(n0, n1), n2)));
+	}
+
+	lw_simplex_noise_2f_batch_scalar(x + k, y + k, out + k, n - k);
+}
+
+#endif /* LW_NOISE_NEON */
+
+/* Picks the fastest batch kernel the CPU supports, LW_NOISE_KERNEL limits the choice */
+#define lw_noise_kernel_allowed(forced, name) ((forced) == NULL || g_strcmp0(forced, name) == 0)
+
+static void
+lw_noise_init_kernel(void)
+{
+	const gchar *forced = g_getenv("LW_NOISE_KERNEL");
+
+#if defined(LW_NOISE_X86)
+	__builtin_cpu_init();
+	if(lw_noise_kernel_allowed(forced, "avx2") && __builtin_cpu_supports("avx2"))
+	{
+		batch_kernel = lw_simplex_noise_2f_batch_avx2;
+		g_debug("Using AVX2 kernel for simplex noise");
+	}
+	else if(lw_noise_kernel_allowed(forced, "sse2") && __builtin_cpu_supports("sse2"))
+	{
+		batch_kernel = lw_simplex_noise_2f_batch_sse2;
+		g_debug("Using SSE2 kernel for simplex noise");
+	}
+#elif defined(LW_NOISE_NEON)
+	if(lw_noise_kernel_allowed(forced, "neon"))
+	{
+		batch_kernel = lw_simplex_noise_2f_batch_neon;
+		g_debug("Using NEON kernel for simplex noise");
+	}
+#endif
+
+	if(batch_kernel == lw_simplex_noise_2f_batch_scalar)
+		g_debug("Using scalar kernel for simplex noise");
+}
+
+#undef lw_noise_kernel_allowed
 
 /**
  * lw_noise_init:
@@ -65,6 +455,7 @@ lw_noise_init()
 
 	if(!is_initialized)
 	{
+		LwRandom *random = lw_random_get_default();
 		int i;
 
 		/* Create permutation table */
@@ -77,7 +468,7 @@ lw_noise_init()
 		for(i = 0; i < PERM_SIZE; i++)
 		{
 			int tmp = perm[i];
-			int j = rand() % PERM_SIZE;
+			int j = lw_random_uint(random, PERM_SIZE);
 			perm[i] = perm[j];
 			perm[j] = tmp;
 		}
@@ -91,10 +482,12 @@ lw_noise_init()
 		/* Generate random gradient table */
 		for(i = 0; i < PERM_SIZE; i++)
 		{
-			grad[i][0] = rand2f(-1.0f, 1.0f);
-			grad[i][1] = rand2f(-1.0f, 1.0f);
+			grad_x[i] = rand2f(-1.0f, 1.0f);
+			grad_y[i] = rand2f(-1.0f, 1.0f);
 		}
 
+		lw_noise_init_kernel();
+
 		is_initialized = TRUE;
 	}
 }
@@ -117,91 +510,24 @@ lw_noise_init()
 float
 lw_simplex_noise_2f(float x, float y)
 {
-	float t;
-
-	/* Noise contributions from the three corners */
-	float n0, n1, n2;
-
-	/* The distances from the cell origin in (x,y) unskewed coords */
-	float x0, y0, x1, y1, x2, y2;
-
-	/* x and y skewed to (i,j) coords */
-	int i, j;
-
-	/* Offsets for second (middle) corner of simplex in (i,j) coords */
-	int i1, j1;
-
-	/* Permutation/Gradient table indices */
-	int pi, pj, gi0, gi1, gi2;
-
-	/* Skew the input space to determine which simplex cell we're in */
-	t = (x + y) * F2;
-	i = floor(x + t);
-	j = floor(y + t);
-
-	/* Unskew the cell origin back to (x, y) space */
-	t = (i + j) * G2;
-	/* X0 = i - t; Y0 = j - t; */
-
-	x0 = x - i + t; /* x - X0 */
-	y0 = y - j + t; /* y - Y0 */
-
-	/* For the 2D case, the simplex shape is an equilateral triangle.
-	 * Determine which simplex we are in. */
-	if(x0 > y0)
-	{
-		/* lower triangle, XY order: (0,0)->(1,0)->(1,1) */
-		i1 = 1;
-		j1 = 0;
-	}
-	else
-	{
-		/* upper triangle, YX order: (0,0)->(0,1)->(1,1) */
-		i1 = 0;
-		j1 = 1;
-	}
-
-	/* A step of (1,0) in (i,j) means a step of (1-G2,-G2) in (x,y) and
-	 * a step of (0,1) in (i,j) means a step of (-G2,1-G2) in (x,y). */
-	x1 = x0 - i1 + G2;
-	y1 = y0 - j1 + G2;
-	x2 = x0 - 1.0 + 2.0 * G2;
-	y2 = y0 - 1.0 + 2.0 * G2;
-
-	/* Work out the hashed gradient indices of the three simplex corners */
-	pi = i % PERM_SIZE;
-	pj = j % PERM_SIZE;
-	gi0 = perm[pi + perm[pj]];
-	gi1 = perm[pi + i1 + perm[pj + j1]];
-	gi2 = perm[pi + 1  + perm[pj + 1 ]];
-
-	/* Calculate the contribution from the three corners */
-	t = 0.5 - x0*x0 - y0*y0;
-	if(t < 0) n0 = 0.0f;
-	else
-	{
-		t *= t;
-		n0 = t * t * (grad[gi0][0] * x0 + grad[gi0][1] * y0);
-	}
-
-	t = 0.5 - x1*x1 - y1*y1;
-	if(t < 0) n1 = 0.0f;
-	else
-	{
-		t *= t;
-		n1 = t * t * (grad[gi1][0] * x1 + grad[gi1][1] * y1);
-	}
-
-	t = 0.5 - x2*x2 - y2*y2;
-	if(t < 0) n2 = 0.0f;
-	else
-	{
-		t *= t;
-		n2 = t * t * (grad[gi2][0] * x2 + grad[gi2][1] * y2);
-	}
-
-	/* Add contributions from each corner to get the final noise value.
-	 * The result is scaled to return values in the interval [-1;1]. */
-	return 70.0f * (n0 + n1 + n2);
+	return lw_simplex_noise_2f_real(x, y);
 }
 
+/**
+ * lw_simplex_noise_2f_batch:
+ * @x: (array length=n): The x coordinates
+ * @y: (array length=n): The y coordinates
+ * @out: (array length=n): Return location for the noise values
+ * @n: Number of positions
+ *
+ * Calculates the noise values at the positions (@x[i], @y[i]) for i = 0, ..., @n - 1.
+ * The values are the same as the ones returned by lw_simplex_noise_2f(), but
+ * they are calculated with SIMD instructions if the CPU supports them.
+ *
+ * Since: 0.6
+ */
+void
+lw_simplex_noise_2f_batch(const float *x, const float *y, float *out, gsize n)
+{
+	batch_kernel(x, y, out, n);
+}
@@ -0,0 +1,325 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: particle-system
+ * @Short_description: structure-of-arrays particle storage with parallel updates
+ *
+ * A #LwParticleSystem stores the attributes of its particles as columns, one
+ * float array per attribute. Every column is aligned to 32 bytes and padded to a
+ * multiple of 8 particles, so update functions can process it with SSE, AVX or
+ * NEON. A column can be uploaded to a #LwBuffer as it is.
+ *
+ * lw_particle_system_update() splits the particles into chunks whose columns
+ * fit into the first level cache together, and passes them to a
+ * #LwParticleUpdateFunc on the workers of the default #LwJobSystem. The calling
+ * thread works on chunks too and returns once all of them are updated.
+ */
+
+#include <string.h>
+#include <livewallpaper/core.h>
+
+/* Alignment and padding of the columns */
+#define COLUMN_ALIGNMENT 32
+#define COLUMN_PADDING 8
+
+/* Bytes of all columns of a chunk, half of a typical first level cache */
+#define CHUNK_BYTES 16384
+#define MIN_CHUNK_SIZE 64
+
+struct _LwParticleSystemPrivate
+{
+	guint n_columns;
+	guint count;
+	guint capacity;
+	guint chunk_size;
+
+	/* Aligned columns and the allocations they point into */
+	gfloat **columns;
+	gpointer *allocations;
+};
+
+/**
+ * LwParticleSystem:
+ *
+ * Particles stored as structure-of-arrays.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwParticleSystem, lw_particle_system, G_TYPE_OBJECT)
+
+/* One call of lw_particle_system_update() shared by all threads working on it */
+typedef struct
+{
+	LwParticleSystem *system;
+	LwParticleUpdateFunc func;
+	gpointer user_data;
+} LwParticleUpdate;
+
+static void
+lw_particle_system_run_chunks(guint first, guint count, gpointer data)
+{
+	LwParticleUpdate *update = data;
+	LwParticleSystemPrivate *priv = update->system->priv;
+	guint chunk;
+
+	for(chunk = first; chunk < first + count; chunk++)
+	{
+		guint particle = chunk * priv->chunk_size;
+
+		update->func(update->system, particle, MIN(priv->chunk_size, priv->count - particle),
+		             update->user_data);
+	}
+}
+
+/**
+ * lw_particle_system_new:
+ * @n_columns: Number of attributes of every particle
+ *
+ * Creates a new particle system without particles. Use
+ * lw_particle_system_set_count() to add particles.
+ *
+ * Returns: A new #LwParticleSystem. Use g_object_unref() to free it.
+ *
+ * Since: 0.6
+ */
+LwParticleSystem*
+lw_particle_system_new(guint n_columns)
+{
+	LwParticleSystem *self;
+	guint chunk_size;
+
+	g_return_val_if_fail(n_columns > 0, NULL);
+
+	self = g_object_new(LW_TYPE_PARTICLE_SYSTEM, NULL);
+
+	self->priv->n_columns = n_columns;
+	self->priv->columns = g_new0(gfloat*, n_columns);
+	self->priv->allocations = g_new0(gpointer, n_columns);
+
+	chunk_size = CHUNK_BYTES / (n_columns * sizeof(gfloat));
+	chunk_size -= chunk_size % MIN_CHUNK_SIZE;
+	self->priv->chunk_size = CLAMP(chunk_size, MIN_CHUNK_SIZE, LW_PARTICLE_SYSTEM_MAX_CHUNK_SIZE);
+
+	return self;
+}
+
+/**
+ * lw_particle_system_get_n_columns:
+ * @self: A #LwParticleSystem
+ *
+ * Returns: The number of attributes of every particle
+ *
+ * Since: 0.6
+ */
+guint
+lw_particle_system_get_n_columns(LwParticleSystem *self)
+{
+	return self->priv->n_columns;
+}
+
+/**
+ * lw_particle_system_get_count:
+ * @self: A #LwParticleSystem
+ *
+ * Returns: The number of particles
+ *
+ * Since: 0.6
+ */
+guint
+lw_particle_system_get_count(LwParticleSystem *self)
+{
+	return self->priv->count;
+}
+
+/**
+ * lw_particle_system_set_count:
+ * @self: A #LwParticleSystem
+ * @count: The new number of particles
+ *
+ * Changes the number of particles. The attributes of the remaining particles
+ * are kept, the attributes of new particles are set to 0.0. Columns returned by
+ * lw_particle_system_get_column() before may become invalid.
+ *
+ * Since: 0.6
+ */
+void
+lw_particle_system_set_count(LwParticleSystem *self, guint count)
+{
+	LwParticleSystemPrivate *priv = self->priv;
+	guint i;
+
+	if(count > priv->capacity)
+	{
+		guint capacity = MAX(count, 2 * priv->capacity);
+
+		capacity += (COLUMN_PADDING - capacity % COLUMN_PADDING) % COLUMN_PADDING;
+
+		for(i = 0; i < priv->n_columns; i++)
+		{
+			gpointer allocation = g_malloc0(capacity * sizeof(gfloat) + COLUMN_ALIGNMENT - 1);
+			gfloat *column = (gfloat*) (((gsize) allocation + COLUMN_ALIGNMENT - 1)
+			                            & ~(gsize) (COLUMN_ALIGNMENT - 1));
+
+			if(priv->columns[i])
+				memcpy(column, priv->columns[i], priv->count * sizeof(gfloat));
+
+			g_free(priv->allocations[i]);
+			priv->allocations[i] = allocation;
+			priv->columns[i] = column;
+		}
+
+		priv->capacity = capacity;
+	}
+	else if(count > priv->count)
+	{
+		/* Clear the values of particles removed before */
+		for(i = 0; i < priv->n_columns; i++)
+			memset(priv->columns[i] + priv->count, 0, (count - priv->count) * sizeof(gfloat));
+	}
+
+	priv->count = count;
+}
+
+/**
+ * lw_particle_system_get_chunk_size:
+ * @self: A #LwParticleSystem
+ *
+ * Returns the number of particles lw_particle_system_update() passes to the
+ * update function at once. Only the last chunk may be smaller. The chunk size
+ * is a multiple of 8 and not greater than %LW_PARTICLE_SYSTEM_MAX_CHUNK_SIZE.
+ *
+ * Returns: The number of particles in a chunk
+ *
+ * Since: 0.6
+ */
+guint
+lw_particle_system_get_chunk_size(LwParticleSystem *self)
+{
+	return self->priv->chunk_size;
+}
+
+/**
+ * lw_particle_system_get_column:
+ * @self: A #LwParticleSystem
+ * @column: Index of the column
+ *
+ * Returns the values of an attribute of all particles. The array is aligned to
+ * 32 bytes and stays valid until lw_particle_system_set_count() is called.
+ *
+ * Returns: (transfer none): The values of the attribute @column
+ *
+ * Since: 0.6
+ */
+gfloat*
+lw_particle_system_get_column(LwParticleSystem *self, guint column)
+{
+	g_return_val_if_fail(column < self->priv->n_columns, NULL);
+
+	return self->priv->columns[column];
+}
+
+/**
+ * lw_particle_system_upload_column:
+ * @self: A #LwParticleSystem
+ * @column: Index of the column
+ * @buffer: A #LwBuffer
+ *
+ * Copies the values of an attribute of all particles into @buffer, so it can
+ * be used as a float vertex attribute.
+ *
+ * Since: 0.6
+ */
+void
+lw_particle_system_upload_column(LwParticleSystem *self, guint column, LwBuffer *buffer)
+{
+	g_return_if_fail(column < self->priv->n_columns);
+
+	lw_buffer_set_data(buffer, self->priv->count * sizeof(gfloat), self->priv->columns[column]);
+}
+
+/**
+ * lw_particle_system_update:
+ * @self: A #LwParticleSystem
+ * @func: (scope call): The function updating a chunk of particles
+ * @user_data: Data to pass to @func
+ *
+ * Calls @func for all chunks of particles. The chunks are distributed between
+ * the calling thread and the workers of the default #LwJobSystem, so @func has
+ * to be thread safe. The function returns after all chunks have been updated.
+ *
+ * Since: 0.6
+ */
+void
+lw_particle_system_update(LwParticleSystem *self, LwParticleUpdateFunc func, gpointer user_data)
+{
+	LwParticleUpdate update;
+	guint n_chunks = (self->priv->count + self->priv->chunk_size - 1) / self->priv->chunk_size;
+
+	update.system = self;
+	update.func = func;
+	update.user_data = user_data;
+
+	/* Every chunk can be stolen by another worker */
+	lw_job_system_parallel_for(lw_job_system_get_default(), n_chunks, 1,
+	                           lw_particle_system_run_chunks, &update);
+}
+
+static void
+lw_particle_system_init(LwParticleSystem *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_PARTICLE_SYSTEM,
+	                                         LwParticleSystemPrivate);
+
+	self->priv->n_columns = 0;
+	self->priv->count = 0;
+	self->priv->capacity = 0;
+	self->priv->chunk_size = MIN_CHUNK_SIZE;
+	self->priv->columns = NULL;
+	self->priv->allocations = NULL;
+}
+
+static void
+lw_particle_system_finalize(GObject *object)
+{
+	LwParticleSystem *self = LW_PARTICLE_SYSTEM(object);
+	guint i;
+
+	for(i = 0; i < self->priv->n_columns; i++)
+		g_free(self->priv->allocations[i]);
+
+	g_free(self->priv->allocations);
+	g_free(self->priv->columns);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_particle_system_parent_class)->finalize(object);
+}
+
+static void
+lw_particle_system_class_init(LwParticleSystemClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_particle_system_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwParticleSystemPrivate));
+}
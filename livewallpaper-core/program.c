@@ -60,16 +60,84 @@
  *
  * The noise plugin makes use of the #LwProgram object. Take a look at the source code of that
  * plugin to see a full working example for #LwProgram.
+ *
+ * Compiling and linking shaders can take a noticeable amount of time. Use
+ * lw_program_link_async() instead of lw_program_link() to let the driver compile
+ * the program in the background (if it supports
+ * <ulink url="https://www.khronos.org/registry/OpenGL/extensions/KHR/KHR_parallel_shader_compile.txt">GL_KHR_parallel_shader_compile</ulink>)
+ * and poll lw_program_is_ready() before using the program. While the program is not ready
+ * the wallpaper should draw without it.
+ *
+ * A #LwProgram can also hold several variants of the same shaders, which only differ
+ * in a set of preprocessor defines. Use lw_program_set_defines() to switch between them.
+ * Every variant is compiled the first time it is selected and kept afterwards, so
+ * toggling a feature back and forth does not compile the shaders again.
+ *
+ * <example>
+ *   <title>Using shader variants</title>
+ *   <programlisting>
+ * const gchar *defines[] = { "USE_TEXTURE", NULL };
+ *
+ * lw_program_create_and_attach_shader_from_resource(prog, "resource:///path/to/vert.glsl", GL_VERTEX_SHADER);
+ * lw_program_create_and_attach_shader_from_resource(prog, "resource:///path/to/frag.glsl", GL_FRAGMENT_SHADER);
+ * lw_program_link_async(prog);
+ *
+ * ...
+ *
+ * // Compiles the shaders again with "#define USE_TEXTURE 1" on first use
+ * lw_program_set_defines(prog, defines);
+ *
+ * if(lw_program_is_ready(prog))
+ *     lw_program_enable(prog);</programlisting>
+ * </example>
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <livewallpaper/core.h>
 
-struct _LwProgramPrivate
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef enum
+{
+	LW_PROGRAM_STATUS_UNLINKED,
+	LW_PROGRAM_STATUS_LINKING,
+	LW_PROGRAM_STATUS_LINKED,
+	LW_PROGRAM_STATUS_FAILED
+} LwProgramStatus;
+
+typedef struct
 {
 	guint name;
+	LwProgramStatus status;
 
 	GArray *tex_units;
+
+	/* Sorted, NULL-terminated list of defines or NULL */
+	gchar **defines;
+} LwProgramVariant;
+
+typedef struct
+{
+	guint type;
+	gchar *source;
+} LwProgramSource;
+
+struct _LwProgramPrivate
+{
+	/* The currently selected variant */
+	LwProgramVariant *variant;
+
+	/* Maps the joined defines of a variant to the LwProgramVariant */
+	GHashTable *variants;
+
+	/* Shader sources used to build new variants */
+	GArray *sources;
+
+	/* Shaders attached with lw_program_attach_shader(), attached to new variants as they are */
+	GPtrArray *shaders;
 };
 
 /**
@@ -96,6 +164,49 @@ array_clear_func(gpointer pointer)
 	g_free(*(gchar**)pointer);
 }
 
+static void
+source_clear_func(gpointer pointer)
+{
+	g_free(((LwProgramSource*)pointer)->source);
+}
+
+static LwProgramVariant*
+lw_program_variant_new(gchar **defines)
+{
+	LwProgramVariant *variant = g_slice_new(LwProgramVariant);
+
+	variant->name = LW_OPENGL_1_4_HELPER(glCreateProgram, glCreateProgramObjectARB, ());
+	variant->status = LW_PROGRAM_STATUS_UNLINKED;
+	variant->tex_units = g_array_new(FALSE, FALSE, sizeof(gchar*));
+	g_array_set_clear_func(variant->tex_units, array_clear_func);
+	variant->defines = defines;
+
+	return variant;
+}
+
+static void
+lw_program_variant_free(gpointer pointer)
+{
+	LwProgramVariant *variant = pointer;
+
+	if(variant->name)
+	{
+		lw_gl_state_forget_program(variant->name);
+		LW_OPENGL_1_4_HELPER(glDeleteProgram, glDeleteObjectARB, (variant->name));
+	}
+
+	g_array_free(variant->tex_units, TRUE);
+	g_strfreev(variant->defines);
+
+	g_slice_free(LwProgramVariant, variant);
+}
+
+static gint
+compare_defines(gconstpointer a, gconstpointer b)
+{
+	return strcmp(*(const gchar**)a, *(const gchar**)b);
+}
+
 /**
  * LwProgram:
  *
@@ -106,18 +217,49 @@ array_clear_func(gpointer pointer)
 
 G_DEFINE_TYPE(LwProgram, lw_program, G_TYPE_OBJECT)
 
+/* Returns TRUE if the driver can compile and link shaders in the background.
+ * The first call also asks the driver to use as many compiler threads as it likes. */
+static gboolean
+lw_program_has_parallel_compile(void)
+{
+	static gint supported = -1;
+
+	if(supported == -1)
+	{
+		supported = FALSE;
+
+#ifdef GL_KHR_parallel_shader_compile
+		if(GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			supported = TRUE;
+		}
+#endif
+#ifdef GL_ARB_parallel_shader_compile
+		if(!supported && GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+			supported = TRUE;
+		}
+#endif
+	}
+
+	return supported;
+}
+
 /**
  * lw_program_get_name:
  * @self: A #LwProgram
  *
  * Returns: The program name returned by <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glCreateProgram.xml">glCreateProgram</ulink>
+ *          for the currently selected variant
  *
  * Since: 0.4
  */
 guint
 lw_program_get_name(LwProgram *self)
 {
-	return self->priv->name;
+	return self->priv->variant->name;
 }
 
 /**
@@ -128,12 +270,145 @@ lw_program_get_name(LwProgram *self)
  * Attaches the shader to the program. This function uses <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glAttachShader.xml">glAttachShader</ulink>
  * to attach the shader. The #LwShader can be freed after attaching it to a #LwProgram.
  *
+ * The program keeps a reference to the shader and attaches it to every variant,
+ * including the ones selected later with lw_program_set_defines(). Unlike the
+ * shaders added by lw_program_create_and_attach_shader(), it is not compiled
+ * again with the defines of a variant.
+ *
  * Since: 0.4
  */
 void
 lw_program_attach_shader(LwProgram *self, LwShader *shader)
 {
-	LW_OPENGL_1_4_HELPER(glAttachShader, glAttachObjectARB, (self->priv->name, lw_shader_get_name(shader)));
+	GHashTableIter iter;
+	LwProgramVariant *variant;
+
+	g_ptr_array_add(self->priv->shaders, g_object_ref(shader));
+
+	g_hash_table_iter_init(&iter, self->priv->variants);
+	while(g_hash_table_iter_next(&iter, NULL, (gpointer*) &variant))
+		LW_OPENGL_1_4_HELPER(glAttachShader, glAttachObjectARB, (variant->name, lw_shader_get_name(shader)));
+}
+
+/* Prints the info log of every attached shader that failed to compile. Shaders are
+ * compiled without checking their status, so compile errors show up here. */
+static void
+lw_program_print_shader_logs(LwProgram *self)
+{
+	GLuint shaders[8];
+	GLsizei count, i;
+
+	LW_OPENGL_1_4_HELPER(glGetAttachedShaders, glGetAttachedObjectsARB, (self->priv->variant->name, G_N_ELEMENTS(shaders), &count, shaders));
+	for(i = 0; i < count; i++)
+	{
+		int status, log_length;
+		gchar *log_buffer;
+
+		LW_OPENGL_1_4_HELPER(glGetShaderiv, glGetObjectParameterivARB, (shaders[i], GL_COMPILE_STATUS, &status));
+		if(status != GL_FALSE)
+			continue;
+
+		LW_OPENGL_1_4_HELPER(glGetShaderiv, glGetObjectParameterivARB, (shaders[i], GL_INFO_LOG_LENGTH, &log_length));
+		log_buffer = g_malloc(log_length * sizeof(gchar));
+
+		LW_OPENGL_1_4_HELPER(glGetShaderInfoLog, glGetInfoLogARB, (shaders[i], log_length, NULL, log_buffer));
+
+		g_warning("%s", log_buffer);
+
+		g_free(log_buffer);
+	}
+}
+
+/* Queries the link status, which blocks until the driver has finished linking */
+static gboolean
+lw_program_check_link_status(LwProgram *self)
+{
+	int status;
+
+	LW_OPENGL_1_4_HELPER(glGetProgramiv, glGetObjectParameterivARB, (self->priv->variant->name, GL_LINK_STATUS, &status));
+	if(status == GL_FALSE)
+	{
+		int log_length;
+		gchar *log_buffer;
+
+		lw_program_print_shader_logs(self);
+
+		LW_OPENGL_1_4_HELPER(glGetProgramiv, glGetObjectParameterivARB, (self->priv->variant->name, GL_INFO_LOG_LENGTH, &log_length));
+		log_buffer = g_malloc(log_length * sizeof(gchar));
+
+		LW_OPENGL_1_4_HELPER(glGetProgramInfoLog, glGetInfoLogARB, (self->priv->variant->name, log_length, NULL, log_buffer));
+
+		g_warning("%s", log_buffer);
+
+		g_free(log_buffer);
+
+		self->priv->variant->status = LW_PROGRAM_STATUS_FAILED;
+		return FALSE;
+	}
+
+	self->priv->variant->status = LW_PROGRAM_STATUS_LINKED;
+	return TRUE;
+}
+
+/**
+ * lw_program_link_async:
+ * @self: A #LwProgram
+ *
+ * Starts linking the program using <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glLinkProgram.xml">glLinkProgram</ulink>,
+ * but does not wait for the result. Use lw_program_is_ready() to check whether the program
+ * can be used.
+ *
+ * If the driver supports GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile,
+ * compiling and linking happens in the background and the wallpaper can keep on loading
+ * textures in the meantime. Otherwise the first call to lw_program_is_ready() waits for the
+ * driver to finish.
+ *
+ * Since: 0.6
+ */
+void
+lw_program_link_async(LwProgram *self)
+{
+	LW_OPENGL_1_4_HELPER(glLinkProgram, glLinkProgramARB, (self->priv->variant->name));
+
+	/* Reset tex units */
+	g_array_free(self->priv->variant->tex_units, TRUE);
+	self->priv->variant->tex_units = g_array_new(FALSE, FALSE, sizeof(gchar*));
+	g_array_set_clear_func(self->priv->variant->tex_units, array_clear_func);
+
+	self->priv->variant->status = LW_PROGRAM_STATUS_LINKING;
+}
+
+/**
+ * lw_program_is_ready:
+ * @self: A #LwProgram
+ *
+ * Checks whether the program has been linked successfully. If the program was linked
+ * with lw_program_link_async() and the driver is still busy, this function returns
+ * %FALSE without blocking. If linking failed, a warning is printed once and this function
+ * keeps returning %FALSE.
+ *
+ * Returns: %TRUE if the program can be used, %FALSE otherwise
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_program_is_ready(LwProgram *self)
+{
+	if(self->priv->variant->status == LW_PROGRAM_STATUS_LINKING)
+	{
+		if(lw_program_has_parallel_compile())
+		{
+			int completed;
+
+			LW_OPENGL_1_4_HELPER(glGetProgramiv, glGetObjectParameterivARB, (self->priv->variant->name, GL_COMPLETION_STATUS_KHR, &completed));
+			if(completed == GL_FALSE)
+				return FALSE;
+		}
+
+		lw_program_check_link_status(self);
+	}
+
+	return self->priv->variant->status == LW_PROGRAM_STATUS_LINKED;
 }
 
 /**
@@ -143,6 +418,9 @@ lw_program_attach_shader(LwProgram *self, LwShader *shader)
  * Links the program using <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glLinkProgram.xml">glLinkProgram</ulink>.
  * If an error occurs, this function returns %FALSE and prints a warning.
  *
+ * This function waits until the driver has finished linking. See lw_program_link_async()
+ * for a non-blocking alternative.
+ *
  * Returns: %TRUE on success, %FALSE if an error occured
  *
  * Since: 0.4
@@ -150,33 +428,43 @@ lw_program_attach_shader(LwProgram *self, LwShader *shader)
 gboolean
 lw_program_link(LwProgram *self)
 {
-	int status;
-
-	LW_OPENGL_1_4_HELPER(glLinkProgram, glLinkProgramARB, (self->priv->name));
+	lw_program_link_async(self);
 
-	/* Reset tex units */
-	g_array_free(self->priv->tex_units, TRUE);
-	self->priv->tex_units = g_array_new(FALSE, FALSE, sizeof(gchar*));
-	g_array_set_clear_func(self->priv->tex_units, array_clear_func);
-
-	/* Handle errors */
-	LW_OPENGL_1_4_HELPER(glGetProgramiv, glGetObjectParameterivARB, (self->priv->name, GL_LINK_STATUS, &status));
-	if(status == GL_FALSE)
-	{
-		int log_length;
-		gchar *log_buffer;
+	return lw_program_check_link_status(self);
+}
 
-		LW_OPENGL_1_4_HELPER(glGetProgramiv, glGetObjectParameterivARB, (self->priv->name, GL_INFO_LOG_LENGTH, &log_length));
-		log_buffer = g_malloc(log_length * sizeof(gchar));
+/* Compiles @source with the defines of @variant and attaches it to @variant */
+static void
+lw_program_variant_attach_source(LwProgramVariant *variant, LwProgramSource *source)
+{
+	LwShader *shader = lw_shader_new_from_string_with_defines(source->source, source->type,
+	                                                          (const gchar * const *) variant->defines);
 
-		LW_OPENGL_1_4_HELPER(glGetProgramInfoLog, glGetInfoLogARB, (self->priv->name, log_length, NULL, log_buffer));
+	lw_shader_compile_async(shader);
+	LW_OPENGL_1_4_HELPER(glAttachShader, glAttachObjectARB, (variant->name, lw_shader_get_name(shader)));
+	g_object_unref(shader);
+}
 
-		g_warning("%s", log_buffer);
+static gboolean
+lw_program_add_shader_source(LwProgram *self, const gchar *uri, guint type)
+{
+	GError *error = NULL;
+	LwProgramSource source;
+	GFile *file = g_file_new_for_uri(uri);
 
-		g_free(log_buffer);
+	g_file_load_contents(file, NULL, &source.source, NULL, NULL, &error);
+	g_object_unref(file);
+	if(error != NULL)
+	{
+		g_critical("Could not load shader: %s", error->message);
+		g_error_free(error);
 		return FALSE;
 	}
 
+	source.type = type;
+	g_array_append_val(self->priv->sources, source);
+
+	lw_program_variant_attach_source(self->priv->variant, &source);
 	return TRUE;
 }
 
@@ -190,6 +478,10 @@ lw_program_link(LwProgram *self)
  * It is easier to use this function instead of creating, compiling and
  * attaching the shader by yourself.
  *
+ * The shader is compiled with lw_shader_compile_async(), so compile errors
+ * are reported when the program gets linked. The source code is kept, so the
+ * shader can be compiled again for other variants (see lw_program_set_defines()).
+ *
  * Returns: %TRUE on success, %FALSE otherwise
  *
  * Since: 0.4
@@ -197,18 +489,7 @@ lw_program_link(LwProgram *self)
 gboolean
 lw_program_create_and_attach_shader(LwProgram *self, const gchar *path, guint type)
 {
-	LwShader *shader = lw_shader_new_from_uri(path, type);
-
-	if(shader != NULL)
-	{
-		lw_shader_compile(shader);
-		lw_program_attach_shader(self, shader);
-		g_object_unref(shader);
-
-		return TRUE;
-	}
-
-	return FALSE;
+	return lw_program_add_shader_source(self, path, type);
 }
 
 /**
@@ -221,6 +502,10 @@ lw_program_create_and_attach_shader(LwProgram *self, const gchar *path, guint ty
  * It is easier to use this function instead of creating, compiling and
  * attaching the shader by yourself.
  *
+ * The shader is compiled with lw_shader_compile_async(), so compile errors
+ * are reported when the program gets linked. The source code is kept, so the
+ * shader can be compiled again for other variants (see lw_program_set_defines()).
+ *
  * Returns: %TRUE on success, %FALSE otherwise
  *
  * Since: 0.5
@@ -228,18 +513,68 @@ lw_program_create_and_attach_shader(LwProgram *self, const gchar *path, guint ty
 gboolean
 lw_program_create_and_attach_shader_from_resource (LwProgram *self, const gchar *path, guint type)
 {
-	LwShader *shader = lw_shader_new_from_uri (path, type);
+	return lw_program_add_shader_source(self, path, type);
+}
+
+/**
+ * lw_program_set_defines:
+ * @self: A #LwProgram
+ * @defines: (array zero-terminated=1) (allow-none): A %NULL-terminated list of names to define or %NULL
+ *
+ * Selects the variant of the program which is compiled with the given preprocessor
+ * defines. Every name in @defines is inserted as "#define name 1" right after the
+ * #version directive of every shader which was added with
+ * lw_program_create_and_attach_shader() or lw_program_create_and_attach_shader_from_resource().
+ * Shaders attached with lw_program_attach_shader() are shared by all variants as they
+ * are. The order of @defines does not matter.
+ *
+ * If the variant is selected for the first time, its shaders are compiled and
+ * linked with lw_program_link_async(), so use lw_program_is_ready() before enabling
+ * it. Switching back to a variant that was used before is cheap. All other functions
+ * of #LwProgram work on the selected variant. Passing %NULL selects the variant
+ * without any defines, which is the one selected after creating the program.
+ *
+ * Since: 0.6
+ */
+void
+lw_program_set_defines(LwProgram *self, const gchar * const *defines)
+{
+	LwProgramVariant *variant;
+	gchar **sorted = NULL;
+	gchar *key;
+	guint i;
 
-	if(shader != NULL)
+	if(defines != NULL && defines[0] != NULL)
 	{
-		lw_shader_compile(shader);
-		lw_program_attach_shader(self, shader);
-		g_object_unref(shader);
+		sorted = g_strdupv((gchar**) defines);
+		qsort(sorted, g_strv_length(sorted), sizeof(gchar*), compare_defines);
+		key = g_strjoinv(" ", sorted);
+	}
+	else
+		key = g_strdup("");
+
+	variant = g_hash_table_lookup(self->priv->variants, key);
+	if(variant != NULL)
+	{
+		g_strfreev(sorted);
+		g_free(key);
+	}
+	else
+	{
+		variant = lw_program_variant_new(sorted);
+		g_hash_table_insert(self->priv->variants, key, variant);
 
-		return TRUE;
+		for(i = 0; i < self->priv->sources->len; i++)
+			lw_program_variant_attach_source(variant, &g_array_index(self->priv->sources, LwProgramSource, i));
+
+		for(i = 0; i < self->priv->shaders->len; i++)
+			LW_OPENGL_1_4_HELPER(glAttachShader, glAttachObjectARB, (variant->name, lw_shader_get_name(g_ptr_array_index(self->priv->shaders, i))));
 	}
 
-	return FALSE;
+	self->priv->variant = variant;
+
+	if(variant->status == LW_PROGRAM_STATUS_UNLINKED && (self->priv->sources->len > 0 || self->priv->shaders->len > 0))
+		lw_program_link_async(self);
 }
 
 /**
@@ -257,7 +592,7 @@ lw_program_create_and_attach_shader_from_resource (LwProgram *self, const gchar
 gint
 lw_program_get_attrib_location(LwProgram *self, const gchar *name)
 {
-	gint location = LW_OPENGL_1_4_HELPER(glGetAttribLocation, glGetAttribLocationARB, (self->priv->name, name));
+	gint location = LW_OPENGL_1_4_HELPER(glGetAttribLocation, glGetAttribLocationARB, (self->priv->variant->name, name));
 	if(location == -1) g_warning("lw_program_get_attrib_location(): "
 	                             "Could not find attribute '%s'", name);
 	return location;
@@ -278,7 +613,7 @@ lw_program_get_attrib_location(LwProgram *self, const gchar *name)
 gint
 lw_program_get_uniform_location(LwProgram *self, const gchar *name)
 {
-	gint location = LW_OPENGL_1_4_HELPER(glGetUniformLocation, glGetUniformLocationARB, (self->priv->name, name));
+	gint location = LW_OPENGL_1_4_HELPER(glGetUniformLocation, glGetUniformLocationARB, (self->priv->variant->name, name));
 	if(location == -1) g_warning("lw_program_get_uniform_location(): "
 	                             "Could not find uniform '%s'", name);
 	return location;
@@ -401,17 +736,17 @@ lw_program_set_texture(LwProgram *self, const gchar *name, LwTexture *texture)
 {
 	guint i;
 
-	for(i = 0; i < self->priv->tex_units->len; i++)
-		if(strcmp(name, g_array_index(self->priv->tex_units, gchar*, i)) == 0)
+	for(i = 0; i < self->priv->variant->tex_units->len; i++)
+		if(strcmp(name, g_array_index(self->priv->variant->tex_units, gchar*, i)) == 0)
 			break;
 
-	if(i == self->priv->tex_units->len)
+	if(i == self->priv->variant->tex_units->len)
 	{
 		/* Get next unused texture unit and set uniform */
 		gint location = lw_program_get_uniform_location(self, name);
 		gchar *name_copy = g_strdup(name);
 
-		g_array_append_val(self->priv->tex_units, name_copy);
+		g_array_append_val(self->priv->variant->tex_units, name_copy);
 		LW_OPENGL_1_4_HELPER(glUniform1i, glUniform1iARB, (location, i));
 	}
 
@@ -447,7 +782,7 @@ lw_program_set_matrix(LwProgram *self, const gchar *name, LwMatrix *matrix)
 void
 lw_program_enable(LwProgram *self)
 {
-	LW_OPENGL_1_4_HELPER(glUseProgram, glUseProgramObjectARB, (self->priv->name));
+	lw_gl_state_use_program(self->priv->variant->name);
 }
 
 /**
@@ -461,18 +796,27 @@ lw_program_enable(LwProgram *self)
 void
 lw_program_disable(LwProgram *self G_GNUC_UNUSED)
 {
-	LW_OPENGL_1_4_HELPER(glUseProgram, glUseProgramObjectARB, (0));
+	lw_gl_state_use_program(0);
 }
 
 static void
 lw_program_init(LwProgram *self)
 {
+	/* Enable background compilation before the first shader is compiled */
+	lw_program_has_parallel_compile();
+
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_PROGRAM,
 	                                         LwProgramPrivate);
 
-	self->priv->name = LW_OPENGL_1_4_HELPER(glCreateProgram, glCreateProgramObjectARB, ());
-	self->priv->tex_units = g_array_new(FALSE, FALSE, sizeof(gchar*));
-	g_array_set_clear_func(self->priv->tex_units, array_clear_func);
+	self->priv->variants = g_hash_table_new_full(g_str_hash, g_str_equal,
+	                                             g_free, lw_program_variant_free);
+	self->priv->sources = g_array_new(FALSE, FALSE, sizeof(LwProgramSource));
+	g_array_set_clear_func(self->priv->sources, source_clear_func);
+	self->priv->shaders = g_ptr_array_new_with_free_func(g_object_unref);
+
+	/* The variant without any defines */
+	self->priv->variant = lw_program_variant_new(NULL);
+	g_hash_table_insert(self->priv->variants, g_strdup(""), self->priv->variant);
 }
 
 static void
@@ -480,10 +824,9 @@ lw_program_finalize(GObject *object)
 {
 	LwProgram *self = LW_PROGRAM(object);
 
-	if(self->priv->name)
-		LW_OPENGL_1_4_HELPER(glDeleteProgram, glDeleteObjectARB, (self->priv->name));
-
-	g_array_free(self->priv->tex_units, TRUE);
+	g_hash_table_destroy(self->priv->variants);
+	g_array_free(self->priv->sources, TRUE);
+	g_ptr_array_unref(self->priv->shaders);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(lw_program_parent_class)->finalize(object);
@@ -0,0 +1,202 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+#include <livewallpaper/core.h>
+
+/**
+ * LwRandom:
+ * @s: The internal state, do not access it directly
+ *
+ * The state of a pseudo random number generator.
+ *
+ * Since: 0.6
+ */
+
+static void lw_random_free_default(gpointer data);
+
+static GPrivate default_random = G_PRIVATE_INIT(lw_random_free_default);
+
+static void
+lw_random_free_default(gpointer data)
+{
+	g_slice_free(LwRandom, data);
+}
+
+static inline guint32
+rotl(guint32 x, gint k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+/* One step of xoshiro128+, see http://prng.di.unimi.it/ */
+static inline guint32
+lw_random_step(guint32 *s)
+{
+	const guint32 result = s[0] + s[3];
+	const guint32 t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+	s[3] = rotl(s[3], 11);
+
+	return result;
+}
+
+/* The upper 24 bits have the best quality and fit exactly into a float */
+#define LW_RANDOM_TO_FLOAT(x) (((x) >> 8) * (1.0f / 16777216.0f))
+
+/**
+ * lw_random_init:
+ * @self: A #LwRandom
+ * @seed: The seed
+ *
+ * Initializes @self with @seed. Two instances initialized with the same seed
+ * return the same sequence of numbers.
+ *
+ * Since: 0.6
+ */
+void
+lw_random_init(LwRandom *self, guint64 seed)
+{
+	gint i;
+
+	/* Expand the seed with splitmix64, so similar seeds give different states */
+	for(i = 0; i < 4; i += 2)
+	{
+		guint64 z;
+
+		seed += G_GUINT64_CONSTANT(0x9E3779B97F4A7C15);
+		z = seed;
+		z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT(0xBF58476D1CE4E5B9);
+		z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT(0x94D049BB133111EB);
+		z = z ^ (z >> 31);
+
+		self->s[i] = (guint32) z;
+		self->s[i + 1] = (guint32) (z >> 32);
+	}
+}
+
+/**
+ * lw_random_get_default:
+ *
+ * Returns the #LwRandom of the calling thread. It gets created and seeded with
+ * the current time the first time a thread calls this function, so every thread
+ * gets a different sequence.
+ *
+ * Returns: (transfer none): The #LwRandom of the calling thread
+ *
+ * Since: 0.6
+ */
+LwRandom*
+lw_random_get_default(void)
+{
+	LwRandom *self = g_private_get(&default_random);
+
+	if(self == NULL)
+	{
+		static gint threads = 0;
+
+		self = g_slice_new(LwRandom);
+		lw_random_init(self, g_get_real_time() +
+		                     ((guint64) g_atomic_int_add(&threads, 1) << 48));
+		g_private_set(&default_random, self);
+	}
+
+	return self;
+}
+
+/**
+ * lw_random_next:
+ * @self: A #LwRandom
+ *
+ * Returns: A random 32 bit number
+ *
+ * Since: 0.6
+ */
+guint32
+lw_random_next(LwRandom *self)
+{
+	return lw_random_step(self->s);
+}
+
+/**
+ * lw_random_uint:
+ * @self: A #LwRandom
+ * @n: The number of possible values, must be greater than 0
+ *
+ * Use this instead of <code>rand() % n</code>.
+ *
+ * Returns: A random number between 0 and @n - 1
+ *
+ * Since: 0.6
+ */
+guint32
+lw_random_uint(LwRandom *self, guint32 n)
+{
+	return (guint32) (((guint64) lw_random_step(self->s) * n) >> 32);
+}
+
+/**
+ * lw_random_float:
+ * @self: A #LwRandom
+ *
+ * Returns: A random floating point number between 0 (inclusive) and 1 (exclusive)
+ *
+ * Since: 0.6
+ */
+gfloat
+lw_random_float(LwRandom *self)
+{
+	return LW_RANDOM_TO_FLOAT(lw_random_step(self->s));
+}
+
+/**
+ * lw_random_fill_uniform:
+ * @self: A #LwRandom
+ * @out: (array length=n): Return location for the random numbers
+ * @n: Number of random numbers
+ * @min: A number to use as minimum
+ * @max: A number to use as maximum
+ *
+ * Fills @out with @n random floating point numbers between @min and @max. This
+ * is faster than calling lw_random_float() @n times.
+ *
+ * Since: 0.6
+ */
+void
+lw_random_fill_uniform(LwRandom *self, gfloat *out, gsize n, gfloat min, gfloat max)
+{
+	const gfloat range = max - min;
+	guint32 s[4];
+	gsize i;
+
+	/* Work on a local copy, so the compiler can keep the state in registers */
+	s[0] = self->s[0]; s[1] = self->s[1]; s[2] = self->s[2]; s[3] = self->s[3];
+
+	for(i = 0; i < n; i++)
+		out[i] = min + range * LW_RANDOM_TO_FLOAT(lw_random_step(s));
+
+	self->s[0] = s[0]; self->s[1] = s[1]; self->s[2] = s[2]; self->s[3] = s[3];
+}
@@ -141,6 +141,67 @@ lw_shader_new_from_string(const gchar *source, guint type)
 	return shader;
 }
 
+/**
+ * lw_shader_new_from_string_with_defines:
+ * @source: The source code of the shader
+ * @type: GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+ * @defines: (array zero-terminated=1) (allow-none): A %NULL-terminated list of names to define or %NULL
+ *
+ * Creates a new shader like lw_shader_new_from_string(), but inserts "#define name 1"
+ * for every name in @defines. The defines are put right after the #version directive,
+ * or in front of the source code if there is none. This makes it possible to compile
+ * specialized variants of one shader which use #ifdef to leave out unused features.
+ *
+ * Returns: A new #LwShader. You should use g_object_unref() to free the #LwShader.
+ *
+ * Since: 0.6
+ */
+LwShader*
+lw_shader_new_from_string_with_defines(const gchar *source, guint type, const gchar * const *defines)
+{
+	LwShader *shader;
+	GString *header;
+	const gchar *body = source;
+	const gchar *sources[3];
+	int lengths[3];
+	guint i;
+
+	if(defines == NULL || defines[0] == NULL)
+		return lw_shader_new_from_string(source, type);
+
+	/* The #version directive has to be the first one in the shader */
+	while(g_ascii_isspace(*body))
+		body++;
+
+	if(strncmp(body, "#version", 8) == 0)
+	{
+		body = strchr(body, '\n');
+		body = (body != NULL) ? body + 1 : source + strlen(source);
+	}
+	else
+		body = source;
+
+	header = g_string_new(NULL);
+	for(i = 0; defines[i] != NULL; i++)
+		g_string_append_printf(header, "#define %s 1\n", defines[i]);
+
+	sources[0] = source;
+	lengths[0] = body - source;
+	sources[1] = header->str;
+	lengths[1] = header->len;
+	sources[2] = body;
+	lengths[2] = strlen(body);
+
+	shader = g_object_new(LW_TYPE_SHADER, NULL);
+	shader->priv->name = LW_OPENGL_1_4_HELPER(glCreateShader, glCreateShaderObjectARB, (type));
+	shader->priv->type = type;
+
+	LW_OPENGL_1_4_HELPER(glShaderSource, glShaderSourceARB, (shader->priv->name, 3, sources, lengths));
+
+	g_string_free(header, TRUE);
+	return shader;
+}
+
 /**
  * lw_shader_get_name:
  * @self: A #LwShader
@@ -169,6 +230,23 @@ lw_shader_get_shader_type(LwShader *self)
 	return self->priv->type;
 }
 
+/**
+ * lw_shader_compile_async:
+ * @self: A #LwShader
+ *
+ * Starts compiling the source code of the shader without waiting for the result.
+ * Querying the compile status forces the driver to finish the compilation, so this
+ * function does not check for errors. Errors are printed when a #LwProgram the shader
+ * is attached to fails to link.
+ *
+ * Since: 0.6
+ */
+void
+lw_shader_compile_async(LwShader *self)
+{
+	LW_OPENGL_1_4_HELPER(glCompileShader, glCompileShaderARB, (self->priv->name));
+}
+
 /**
  * lw_shader_compile:
  * @self: A #LwShader
@@ -185,7 +263,7 @@ lw_shader_compile(LwShader *self)
 {
 	int status;
 
-	LW_OPENGL_1_4_HELPER(glCompileShader, glCompileShaderARB, (self->priv->name));
+	lw_shader_compile_async(self);
 
 	/* Handle errors */
 	LW_OPENGL_1_4_HELPER(glGetShaderiv, glGetObjectParameterivARB, (self->priv->name, GL_COMPILE_STATUS, &status));
@@ -0,0 +1,584 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: texture-atlas
+ * @Short_description: packs many small images into one texture
+ *
+ * A #LwTextureAtlas packs several images into a single #LwTexture, so sprites
+ * using different images can be drawn without switching textures in between,
+ * e.g. all inside of one glBegin()/glEnd() block or one draw call.
+ *
+ * The images are packed with the skyline bottom-left algorithm, sorted by height.
+ * Use lw_texture_atlas_get_matrix() to get a #LwTextureMatrix for each image. It
+ * maps the texture coordinates of the image, ranging from 0.0 to 1.0, to the part
+ * of the atlas that holds the image.
+ *
+ * lw_texture_atlas_new_from_resources() returns a transparent atlas right away and
+ * decodes and packs the images on the threads of the default #LwTextureLoader. The
+ * matrices are updated as soon as the packed atlas is uploaded, so always use the
+ * current values of the matrices.
+ *
+ * <example>
+ *   <title>Drawing two sprites from one atlas</title>
+ *   <programlisting>
+ * const gchar *paths[] = { "/path/to/a.png", "/path/to/b.png", NULL };
+ * LwTextureAtlas *atlas = lw_texture_atlas_new_from_resources(paths, 1);
+ * const LwTextureMatrix *a = lw_texture_atlas_get_matrix(atlas, 0);
+ *
+ * lw_texture_enable(LW_TEXTURE(atlas));
+ * glBegin(GL_QUADS);
+ *     glTexCoord2f(LW_TEX_COORD_X(*a, 0.0f), LW_TEX_COORD_Y(*a, 0.0f));
+ *     ...
+ * glEnd();
+ * lw_texture_disable(LW_TEXTURE(atlas));</programlisting>
+ * </example>
+ */
+
+#include <math.h>
+#include <string.h>
+#include <livewallpaper/core.h>
+
+
+typedef struct _LwSkylineNode LwSkylineNode;
+typedef struct _LwAtlasRect LwAtlasRect;
+
+/* A horizontal segment of the skyline, everything below it is occupied */
+struct _LwSkylineNode
+{
+	guint x, y;
+	guint width;
+};
+
+/* The space of one image inside of the atlas, including the padding */
+struct _LwAtlasRect
+{
+	guint index;
+	guint x, y;
+	guint width, height;
+};
+
+typedef struct _LwAtlasLoad LwAtlasLoad;
+
+/* Images packed by the threads of the texture loader */
+struct _LwAtlasLoad
+{
+	gchar **paths;
+	guint padding;
+
+	/* Written by the loader thread, copied to the atlas once it is uploaded */
+	LwTextureMatrix *matrices;
+};
+
+struct _LwTextureAtlasPrivate
+{
+	/* One LwTextureMatrix per image */
+	GArray *matrices;
+
+	/* Images being loaded or %NULL, owned by the texture loader. If loading
+	 * fails, texture-loaded is never emitted and it must not be used anymore. */
+	LwAtlasLoad *load;
+};
+
+/**
+ * LwTextureAtlas:
+ *
+ * A texture holding several images.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwTextureAtlas, lw_texture_atlas, LW_TYPE_TEXTURE)
+
+static int
+compare_rects(const void *a, const void *b)
+{
+	const LwAtlasRect *ra = a, *rb = b;
+
+	if(ra->height != rb->height)
+		return (ra->height > rb->height) ? -1 : 1;
+	if(ra->width != rb->width)
+		return (ra->width > rb->width) ? -1 : 1;
+
+	return (ra->index < rb->index) ? -1 : 1;
+}
+
+/* Returns the y position of a rectangle placed at the start of node @i,
+ * or G_MAXUINT if it does not fit into the atlas */
+static guint
+skyline_fit(GArray *skyline, guint i, guint width, guint atlas_width)
+{
+	LwSkylineNode *node = &g_array_index(skyline, LwSkylineNode, i);
+	guint y = 0, remaining = width;
+
+	if(node->x + width > atlas_width)
+		return G_MAXUINT;
+
+	for(; i < skyline->len && remaining > 0; i++)
+	{
+		node = &g_array_index(skyline, LwSkylineNode, i);
+		y = MAX(y, node->y);
+		remaining -= MIN(remaining, node->width);
+	}
+
+	return y;
+}
+
+static void
+skyline_insert(GArray *skyline, guint i, guint x, guint y, guint width)
+{
+	LwSkylineNode node;
+
+	node.x = x;
+	node.y = y;
+	node.width = width;
+	g_array_insert_val(skyline, i, node);
+
+	/* Shrink or remove the nodes covered by the new one */
+	for(i = i + 1; i < skyline->len;)
+	{
+		LwSkylineNode *prev = &g_array_index(skyline, LwSkylineNode, i - 1),
+		              *cur  = &g_array_index(skyline, LwSkylineNode, i);
+		guint prev_end = prev->x + prev->width;
+
+		if(cur->x >= prev_end)
+			break;
+
+		if(cur->x + cur->width > prev_end)
+		{
+			cur->width -= prev_end - cur->x;
+			cur->x = prev_end;
+			break;
+		}
+
+		g_array_remove_index(skyline, i);
+	}
+
+	/* Merge neighbours of the same height */
+	for(i = 0; i + 1 < skyline->len;)
+	{
+		LwSkylineNode *a = &g_array_index(skyline, LwSkylineNode, i),
+		              *b = &g_array_index(skyline, LwSkylineNode, i + 1);
+
+		if(a->y == b->y)
+		{
+			a->width += b->width;
+			g_array_remove_index(skyline, i + 1);
+		}
+		else
+			i++;
+	}
+}
+
+/* Places all rectangles inside an atlas of @atlas_width, returns the used height */
+static guint
+skyline_pack(LwAtlasRect *rects, guint n_rects, guint atlas_width)
+{
+	GArray *skyline = g_array_new(FALSE, FALSE, sizeof(LwSkylineNode));
+	LwSkylineNode first;
+	guint height = 0, r, i;
+
+	first.x = 0;
+	first.y = 0;
+	first.width = atlas_width;
+	g_array_append_val(skyline, first);
+
+	for(r = 0; r < n_rects; r++)
+	{
+		LwAtlasRect *rect = &rects[r];
+		guint best = G_MAXUINT, best_top = G_MAXUINT, best_width = G_MAXUINT;
+
+		/* Bottom-left: lowest top edge first, then the narrowest segment */
+		for(i = 0; i < skyline->len; i++)
+		{
+			LwSkylineNode *node = &g_array_index(skyline, LwSkylineNode, i);
+			guint y = skyline_fit(skyline, i, rect->width, atlas_width);
+
+			if(y == G_MAXUINT)
+				continue;
+
+			if(y + rect->height < best_top ||
+			   (y + rect->height == best_top && node->width < best_width))
+			{
+				best = i;
+				best_top = y + rect->height;
+				best_width = node->width;
+			}
+		}
+
+		if(best == G_MAXUINT)
+		{
+			height = G_MAXUINT;
+			break;
+		}
+
+		rect->x = g_array_index(skyline, LwSkylineNode, best).x;
+		rect->y = best_top - rect->height;
+		skyline_insert(skyline, best, rect->x, best_top, rect->width);
+
+		height = MAX(height, best_top);
+	}
+
+	g_array_free(skyline, TRUE);
+
+	return height;
+}
+
+static guint
+next_power_of_two(guint n)
+{
+	guint p = 1;
+
+	while(p < n)
+		p <<= 1;
+
+	return p;
+}
+
+/* Packs the images into a new RGBA buffer of @width x @height pixels and stores the
+ * matrix of every image in @matrices */
+static guchar*
+lw_texture_atlas_pack(GdkPixbuf **pixbufs, guint n_pixbufs, guint padding,
+                      guint *out_width, guint *out_height, LwTextureMatrix *matrices)
+{
+	LwAtlasRect *rects;
+	guchar *data;
+	guint width, height, area = 0, max_width = 0, i;
+
+	rects = g_new0(LwAtlasRect, n_pixbufs);
+	for(i = 0; i < n_pixbufs; i++)
+	{
+		rects[i].index = i;
+		rects[i].width = gdk_pixbuf_get_width(pixbufs[i]) + padding;
+		rects[i].height = gdk_pixbuf_get_height(pixbufs[i]) + padding;
+
+		area += rects[i].width * rects[i].height;
+		max_width = MAX(max_width, rects[i].width);
+	}
+
+	qsort(rects, n_pixbufs, sizeof(LwAtlasRect), compare_rects);
+
+	/* Start with a square that might hold everything and widen it as long
+	 * as the atlas becomes higher than wide */
+	width = next_power_of_two(MAX((guint) ceil(sqrt(area)), max_width));
+	while((height = skyline_pack(rects, n_pixbufs, width)) > width)
+		width <<= 1;
+
+	/* Copy the images into the atlas */
+	data = g_malloc0(4 * width * height);
+	for(i = 0; i < n_pixbufs; i++)
+	{
+		GdkPixbuf *pixbuf = pixbufs[rects[i].index];
+		const guchar *pixels = gdk_pixbuf_read_pixels(pixbuf);
+		guint image_width  = gdk_pixbuf_get_width(pixbuf),
+		      image_height = gdk_pixbuf_get_height(pixbuf),
+		      rowstride    = gdk_pixbuf_get_rowstride(pixbuf),
+		      n_channels   = gdk_pixbuf_get_n_channels(pixbuf),
+		      x, y;
+
+		for(y = 0; y < image_height; y++)
+		{
+			const guchar *src = pixels + y * rowstride;
+			guchar *dst = data + 4 * ((rects[i].y + y) * width + rects[i].x);
+
+			if(n_channels == 4)
+			{
+				memcpy(dst, src, 4 * image_width);
+				continue;
+			}
+
+			for(x = 0; x < image_width; x++, src += n_channels, dst += 4)
+			{
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = 255;
+			}
+		}
+	}
+
+	/* Map texture coordinates of the images to their part of the atlas */
+	for(i = 0; i < n_pixbufs; i++)
+	{
+		LwTextureMatrix *m = &matrices[rects[i].index];
+
+		m->xx = (gfloat) (rects[i].width - padding) / width;
+		m->yx = 0.0f;
+		m->xy = 0.0f;
+		m->yy = (gfloat) (rects[i].height - padding) / height;
+		m->x0 = (gfloat) rects[i].x / width;
+		m->y0 = (gfloat) rects[i].y / height;
+	}
+
+	g_free(rects);
+
+	*out_width = width;
+	*out_height = height;
+	return data;
+}
+
+/* Creates an atlas of @width x @height pixels holding @data and @n_images matrices */
+static LwTextureAtlas*
+lw_texture_atlas_new(const guchar *data, guint width, guint height, guint n_images)
+{
+	LwTextureAtlas *atlas = g_object_new(LW_TYPE_TEXTURE_ATLAS,
+	                                     "target", GL_TEXTURE_2D,
+	                                     "width", width,
+	                                     "height", height,
+	                                     NULL);
+
+	lw_gl_state_bind_texture(lw_texture_get_target(LW_TEXTURE(atlas)),
+	                         lw_texture_get_name(LW_TEXTURE(atlas)));
+
+	glTexImage2D(lw_texture_get_target(LW_TEXTURE(atlas)),
+	             0,
+	             GL_RGBA,
+	             width, height,
+	             0,
+	             GL_RGBA,
+	             GL_UNSIGNED_BYTE,
+	             data);
+
+	lw_texture_set_filter(LW_TEXTURE(atlas), GL_NEAREST);
+	lw_texture_set_wrap(LW_TEXTURE(atlas), GL_CLAMP_TO_EDGE);
+
+	g_array_set_size(atlas->priv->matrices, n_images);
+
+	return atlas;
+}
+
+/**
+ * lw_texture_atlas_new_from_pixbufs:
+ * @pixbufs: (array length=n_pixbufs): The images to pack
+ * @n_pixbufs: Number of images
+ * @padding: Number of transparent pixels between two images
+ *
+ * Packs the images into a new texture atlas. The index of an image inside the atlas
+ * is its index inside of @pixbufs. A @padding of one pixel avoids bleeding between
+ * images with GL_LINEAR filtering.
+ *
+ * Returns: A new #LwTextureAtlas or %NULL if @n_pixbufs is 0. You should use
+ *          g_object_unref() to free the #LwTextureAtlas.
+ *
+ * Since: 0.6
+ */
+LwTextureAtlas*
+lw_texture_atlas_new_from_pixbufs(GdkPixbuf **pixbufs, guint n_pixbufs, guint padding)
+{
+	LwTextureAtlas *atlas;
+	LwTextureMatrix *matrices;
+	guchar *data;
+	guint width, height;
+
+	if(n_pixbufs == 0)
+	{
+		g_warning("lw_texture_atlas_new_from_pixbufs(): No images to pack");
+		return NULL;
+	}
+
+	matrices = g_new(LwTextureMatrix, n_pixbufs);
+	data = lw_texture_atlas_pack(pixbufs, n_pixbufs, padding, &width, &height, matrices);
+
+	atlas = lw_texture_atlas_new(data, width, height, n_pixbufs);
+	memcpy(atlas->priv->matrices->data, matrices, n_pixbufs * sizeof(LwTextureMatrix));
+
+	g_free(matrices);
+	g_free(data);
+
+	return atlas;
+}
+
+static void
+lw_atlas_load_free(LwAtlasLoad *load)
+{
+	g_strfreev(load->paths);
+	g_free(load->matrices);
+	g_slice_free(LwAtlasLoad, load);
+}
+
+static void
+lw_atlas_load_free_pixels(guchar *pixels, G_GNUC_UNUSED gpointer data)
+{
+	g_free(pixels);
+}
+
+/* Runs on a thread of the texture loader */
+static GdkPixbuf*
+lw_atlas_load_decode(gpointer data, GError **error)
+{
+	LwAtlasLoad *load = data;
+	guint n = g_strv_length(load->paths), width, height, i;
+	GdkPixbuf **pixbufs = g_new0(GdkPixbuf*, n);
+	GdkPixbuf *result = NULL;
+
+	for(i = 0; i < n; i++)
+	{
+		pixbufs[i] = gdk_pixbuf_new_from_resource(load->paths[i], error);
+		if(pixbufs[i] == NULL)
+			break;
+	}
+
+	if(i == n)
+	{
+		guchar *pixels = lw_texture_atlas_pack(pixbufs, n, load->padding,
+		                                       &width, &height, load->matrices);
+
+		result = gdk_pixbuf_new_from_data(pixels, GDK_COLORSPACE_RGB, TRUE, 8,
+		                                  width, height, 4 * width,
+		                                  lw_atlas_load_free_pixels, NULL);
+	}
+
+	for(i = 0; i < n; i++)
+		if(pixbufs[i])
+			g_object_unref(pixbufs[i]);
+	g_free(pixbufs);
+
+	return result;
+}
+
+static void
+lw_texture_atlas_loaded(G_GNUC_UNUSED LwTextureLoader *loader,
+                        LwTexture *texture,
+                        LwTextureAtlas *self)
+{
+	if(texture != LW_TEXTURE(self) || self->priv->load == NULL)
+		return;
+
+	memcpy(self->priv->matrices->data, self->priv->load->matrices,
+	       self->priv->matrices->len * sizeof(LwTextureMatrix));
+
+	/* The loader frees the load after this signal */
+	self->priv->load = NULL;
+}
+
+/**
+ * lw_texture_atlas_new_from_resources:
+ * @paths: (array zero-terminated=1): %NULL terminated list of resources to pack
+ * @padding: Number of transparent pixels between two images
+ *
+ * Loads the images from gresources and packs them like
+ * lw_texture_atlas_new_from_pixbufs(). The images are decoded and packed on the
+ * threads of the default #LwTextureLoader. Until the atlas is uploaded, it is
+ * transparent and all matrices are zero. If an image can not be loaded, a warning
+ * is printed and the atlas stays transparent.
+ *
+ * Returns: A new #LwTextureAtlas or %NULL if @paths is empty. You should use
+ *          g_object_unref() to free the #LwTextureAtlas.
+ *
+ * Since: 0.6
+ */
+LwTextureAtlas*
+lw_texture_atlas_new_from_resources(const gchar * const *paths, guint padding)
+{
+	static const guchar transparent[4] = { 0, 0, 0, 0 };
+	LwTextureLoader *loader = lw_texture_loader_get_default();
+	guint n = g_strv_length((gchar**) paths);
+	LwTextureAtlas *atlas;
+	LwAtlasLoad *load;
+
+	if(n == 0)
+	{
+		g_warning("lw_texture_atlas_new_from_resources(): No images to pack");
+		return NULL;
+	}
+
+	atlas = lw_texture_atlas_new(transparent, 1, 1, n);
+
+	load = g_slice_new(LwAtlasLoad);
+	load->paths = g_strdupv((gchar**) paths);
+	load->padding = padding;
+	load->matrices = g_new0(LwTextureMatrix, n);
+	atlas->priv->load = load;
+
+	g_signal_connect_object(loader, "texture-loaded",
+	                        G_CALLBACK(lw_texture_atlas_loaded), atlas, 0);
+	lw_texture_loader_load_into(loader, LW_TEXTURE(atlas), lw_atlas_load_decode, load,
+	                            (GDestroyNotify) lw_atlas_load_free, LW_TEXTURE_FLAGS_NONE);
+
+	return atlas;
+}
+
+/**
+ * lw_texture_atlas_get_n_images:
+ * @self: A #LwTextureAtlas
+ *
+ * Returns: The number of images inside the atlas
+ *
+ * Since: 0.6
+ */
+guint
+lw_texture_atlas_get_n_images(LwTextureAtlas *self)
+{
+	return self->priv->matrices->len;
+}
+
+/**
+ * lw_texture_atlas_get_matrix:
+ * @self: A #LwTextureAtlas
+ * @index: The index of the image
+ *
+ * Returns the matrix to transform texture coordinates of the image at @index,
+ * ranging from 0.0 to 1.0, to texture coordinates inside the atlas. Use it
+ * with #LW_TEX_COORD_X and #LW_TEX_COORD_Y.
+ *
+ * Returns: (transfer none): The #LwTextureMatrix of the image
+ *
+ * Since: 0.6
+ */
+const LwTextureMatrix*
+lw_texture_atlas_get_matrix(LwTextureAtlas *self, guint index)
+{
+	g_return_val_if_fail(index < self->priv->matrices->len, NULL);
+
+	return &g_array_index(self->priv->matrices, LwTextureMatrix, index);
+}
+
+static void
+lw_texture_atlas_init(LwTextureAtlas *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_TEXTURE_ATLAS,
+	                                         LwTextureAtlasPrivate);
+
+	self->priv->matrices = g_array_new(FALSE, TRUE, sizeof(LwTextureMatrix));
+	self->priv->load = NULL;
+}
+
+static void
+lw_texture_atlas_finalize(GObject *object)
+{
+	LwTextureAtlas *self = LW_TEXTURE_ATLAS(object);
+
+	g_array_free(self->priv->matrices, TRUE);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_texture_atlas_parent_class)->finalize(object);
+}
+
+static void
+lw_texture_atlas_class_init(LwTextureAtlasClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_texture_atlas_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwTextureAtlasPrivate));
+}
+
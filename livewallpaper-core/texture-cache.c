@@ -0,0 +1,350 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: texture-cache
+ * @Short_description: shares textures loaded from the same image
+ *
+ * A #LwTextureCache returns the same #LwTexture if an image is loaded several times
+ * with the same filter and wrap parameters and #LwTextureFlags. The textures are loaded asynchronously by
+ * the default #LwTextureLoader.
+ *
+ * The cache does not keep the textures alive while they are in use, it just knows about
+ * them. As soon as the last reference outside of the cache is dropped, the texture is
+ * moved to a list of recently released textures. Loading the image again revives the
+ * texture without decoding it again, which makes toggling between images cheap. The
+ * released textures are freed, least recently released first, as soon as their total
+ * size exceeds the budget set with lw_texture_cache_set_budget().
+ *
+ * <note>
+ *   <para>
+ *     Textures returned by the cache are shared, so you should not change their
+ *     filter or wrap parameters. Load the image with other parameters instead.
+ *   </para>
+ * </note>
+ */
+
+#include <livewallpaper/core.h>
+
+
+/* Default size of recently released textures kept by the cache, in bytes */
+#define DEFAULT_BUDGET (16 * 1024 * 1024)
+
+typedef struct _LwTextureCacheEntry LwTextureCacheEntry;
+
+struct _LwTextureCacheEntry
+{
+	LwTextureCache *cache;
+	gchar *key;
+
+	/* The cache holds a toggle reference on the texture */
+	LwTexture *texture;
+
+	/* Link into the list of released textures or %NULL while the texture is in use */
+	GList *released;
+	gsize size;
+};
+
+struct _LwTextureCachePrivate
+{
+	/* Maps keys to entries */
+	GHashTable *entries;
+
+	/* Released entries, the least recently released one first */
+	GQueue *released;
+	gsize released_size;
+
+	gsize budget;
+};
+
+static LwTextureCache *default_cache = NULL;
+
+/**
+ * LwTextureCache:
+ *
+ * Shares textures loaded from the same image.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwTextureCache, lw_texture_cache, G_TYPE_OBJECT)
+
+static void lw_texture_cache_toggle_notify(LwTextureCacheEntry *entry, G_GNUC_UNUSED GObject *object, gboolean is_last_ref);
+
+static void
+lw_texture_cache_entry_free(LwTextureCacheEntry *entry)
+{
+	if(entry->released)
+	{
+		g_queue_delete_link(entry->cache->priv->released, entry->released);
+		entry->cache->priv->released_size -= entry->size;
+	}
+
+	/* Drops the texture if nobody else uses it anymore */
+	g_object_remove_toggle_ref(G_OBJECT(entry->texture),
+	                           (GToggleNotify) lw_texture_cache_toggle_notify, entry);
+
+	g_free(entry->key);
+	g_slice_free(LwTextureCacheEntry, entry);
+}
+
+/* Frees released textures until their size fits into the budget */
+static void
+lw_texture_cache_trim(LwTextureCache *self, gsize budget)
+{
+	while(self->priv->released_size > budget)
+	{
+		LwTextureCacheEntry *entry = g_queue_peek_head(self->priv->released);
+		g_hash_table_remove(self->priv->entries, entry->key);
+	}
+}
+
+static void
+lw_texture_cache_toggle_notify(LwTextureCacheEntry *entry,
+                               G_GNUC_UNUSED GObject *object,
+                               gboolean is_last_ref)
+{
+	LwTextureCachePrivate *priv = entry->cache->priv;
+
+	if(is_last_ref)
+	{
+		LwTextureFlags flags = lw_texture_get_flags(entry->texture);
+
+		/* Textures loaded asynchronously might have changed their size meanwhile */
+		entry->size = 4 * lw_texture_get_width(entry->texture)
+		                * lw_texture_get_height(entry->texture);
+
+		/* Estimate the memory used by compressed formats and mipmaps */
+		if(flags & LW_TEXTURE_FLAGS_COMPRESSED)
+			entry->size /= 4;
+		if(flags & LW_TEXTURE_FLAGS_MIPMAP)
+			entry->size += entry->size / 3;
+
+		g_queue_push_tail(priv->released, entry);
+		entry->released = g_queue_peek_tail_link(priv->released);
+		priv->released_size += entry->size;
+
+		lw_texture_cache_trim(entry->cache, priv->budget);
+	}
+	else if(entry->released)
+	{
+		g_queue_delete_link(priv->released, entry->released);
+		entry->released = NULL;
+		priv->released_size -= entry->size;
+	}
+}
+
+static LwTexture*
+lw_texture_cache_load(LwTextureCache *self,
+                      const gchar *path,
+                      gboolean is_resource,
+                      guint filter,
+                      guint wrap,
+                      LwTextureFlags flags)
+{
+	LwTextureCacheEntry *entry;
+	gchar *key = g_strdup_printf("%s://%s?filter=%u&wrap=%u&flags=%u",
+	                             (is_resource) ? "resource" : "file",
+	                             path, filter, wrap, flags);
+
+	entry = g_hash_table_lookup(self->priv->entries, key);
+	if(entry != NULL)
+	{
+		g_free(key);
+		/* Takes the texture out of the released list by toggling the reference */
+		return g_object_ref(entry->texture);
+	}
+
+	entry = g_slice_new0(LwTextureCacheEntry);
+	entry->cache = self;
+	entry->key = key;
+
+	if(is_resource)
+		entry->texture = lw_texture_loader_load_resource(lw_texture_loader_get_default(), path, flags);
+	else
+		entry->texture = lw_texture_loader_load_file(lw_texture_loader_get_default(), path, flags);
+
+	lw_texture_set_filter(entry->texture, filter);
+	lw_texture_set_wrap(entry->texture, wrap);
+
+	/* The reference returned by the loader is passed to the caller */
+	g_object_add_toggle_ref(G_OBJECT(entry->texture),
+	                        (GToggleNotify) lw_texture_cache_toggle_notify, entry);
+	g_hash_table_insert(self->priv->entries, key, entry);
+
+	return entry->texture;
+}
+
+/**
+ * lw_texture_cache_get_default:
+ *
+ * Returns: (transfer none): The texture cache shared by all plugins
+ *
+ * Since: 0.6
+ */
+LwTextureCache*
+lw_texture_cache_get_default(void)
+{
+	if(default_cache == NULL)
+		default_cache = g_object_new(LW_TYPE_TEXTURE_CACHE, NULL);
+
+	return default_cache;
+}
+
+/**
+ * lw_texture_cache_load_file:
+ * @self: A #LwTextureCache
+ * @path: Name of the file to load
+ * @filter: The texture filter, see lw_texture_set_filter()
+ * @wrap: The wrap parameter, see lw_texture_set_wrap()
+ * @flags: #LwTextureFlags for the texture
+ *
+ * Returns the cached texture for the image file and parameters or starts loading it
+ * by using lw_texture_loader_load_file().
+ *
+ * Returns: A shared #LwTexture. You should use g_object_unref() to release the #LwTexture.
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_texture_cache_load_file(LwTextureCache *self, const gchar *path, guint filter, guint wrap, LwTextureFlags flags)
+{
+	return lw_texture_cache_load(self, path, FALSE, filter, wrap, flags);
+}
+
+/**
+ * lw_texture_cache_load_resource:
+ * @self: A #LwTextureCache
+ * @path: Name of the resource to load
+ * @filter: The texture filter, see lw_texture_set_filter()
+ * @wrap: The wrap parameter, see lw_texture_set_wrap()
+ * @flags: #LwTextureFlags for the texture
+ *
+ * Returns the cached texture for the resource and parameters or starts loading it
+ * by using lw_texture_loader_load_resource().
+ *
+ * Returns: A shared #LwTexture. You should use g_object_unref() to release the #LwTexture.
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_texture_cache_load_resource(LwTextureCache *self, const gchar *path, guint filter, guint wrap, LwTextureFlags flags)
+{
+	return lw_texture_cache_load(self, path, TRUE, filter, wrap, flags);
+}
+
+/**
+ * lw_texture_cache_set_budget:
+ * @self: A #LwTextureCache
+ * @budget: Maximum size of released textures in bytes
+ *
+ * Sets how many bytes of released textures the cache keeps for reuse. Released
+ * textures are freed immediately if @budget is 0. The default budget is 16 MiB.
+ *
+ * Since: 0.6
+ */
+void
+lw_texture_cache_set_budget(LwTextureCache *self, gsize budget)
+{
+	self->priv->budget = budget;
+	lw_texture_cache_trim(self, budget);
+}
+
+/**
+ * lw_texture_cache_get_budget:
+ * @self: A #LwTextureCache
+ *
+ * Returns: Maximum size of released textures in bytes
+ *
+ * Since: 0.6
+ */
+gsize
+lw_texture_cache_get_budget(LwTextureCache *self)
+{
+	return self->priv->budget;
+}
+
+/**
+ * lw_texture_cache_get_released_size:
+ * @self: A #LwTextureCache
+ *
+ * Returns: The size of released textures kept by the cache in bytes
+ *
+ * Since: 0.6
+ */
+gsize
+lw_texture_cache_get_released_size(LwTextureCache *self)
+{
+	return self->priv->released_size;
+}
+
+/**
+ * lw_texture_cache_clear:
+ * @self: A #LwTextureCache
+ *
+ * Frees all released textures. Textures that are still in use are not affected.
+ *
+ * Since: 0.6
+ */
+void
+lw_texture_cache_clear(LwTextureCache *self)
+{
+	lw_texture_cache_trim(self, 0);
+}
+
+static void
+lw_texture_cache_init(LwTextureCache *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_TEXTURE_CACHE,
+	                                         LwTextureCachePrivate);
+
+	self->priv->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+	                                            (GDestroyNotify) lw_texture_cache_entry_free);
+	self->priv->released = g_queue_new();
+	self->priv->released_size = 0;
+	self->priv->budget = DEFAULT_BUDGET;
+}
+
+static void
+lw_texture_cache_finalize(GObject *object)
+{
+	LwTextureCache *self = LW_TEXTURE_CACHE(object);
+
+	g_hash_table_destroy(self->priv->entries);
+	g_queue_free(self->priv->released);
+
+	if(default_cache == self)
+		default_cache = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_texture_cache_parent_class)->finalize(object);
+}
+
+static void
+lw_texture_cache_class_init(LwTextureCacheClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_texture_cache_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwTextureCachePrivate));
+}
+
@@ -0,0 +1,788 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2013-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/**
+ * SECTION: texture-loader
+ * @Short_description: loads textures without blocking the paint loop
+ *
+ * Loading an image with lw_texture_new_from_file() decodes and uploads the whole
+ * image at once, which stalls painting for large images. A #LwTextureLoader
+ * decodes images on a thread pool instead and uploads the decoded pixels in small
+ * slices, one slice per frame.
+ *
+ * lw_texture_loader_load_file() and lw_texture_loader_load_resource() return a
+ * placeholder #LwTexture immediately. The placeholder is a transparent 1x1 texture
+ * until the image is completely uploaded, afterwards it holds the loaded image.
+ * Filter and wrap parameters set on the placeholder are kept, the #LwTextureFlags
+ * passed when loading apply to the loaded image. The
+ * #LwTextureLoader::texture-loaded signal is emitted as soon as a texture is ready.
+ *
+ * lw_texture_loader_load_into() fills an existing texture with an image created by
+ * a #LwTextureDecodeFunc, e.g. to compose several images on the loader's threads.
+ *
+ * The uploads happen inside lw_texture_loader_process(), which LiveWallpaper calls
+ * once per frame for the default loader.
+ *
+ * Decoded images are stored as raw texels in the user's cache directory
+ * ($XDG_CACHE_HOME/livewallpaper/textures), named after a checksum of the encoded
+ * image. Loading the same image again maps the cached texels into memory instead
+ * of decoding the image, so loading is limited by the upload only. The cache is
+ * limited to 256 MiB, the least recently used texels are removed first.
+ *
+ * <example>
+ *   <title>Loading a texture asynchronously</title>
+ *   <programlisting>
+ * LwTextureLoader *loader = lw_texture_loader_get_default();
+ * LwTexture *tex = lw_texture_loader_load_resource(loader, "/path/to/texture.png",
+ *                                                  LW_TEXTURE_FLAGS_MIPMAP);
+ *
+ * // tex can be used immediately, it shows the image as soon as it is loaded
+ * lw_texture_set_filter(tex, GL_LINEAR);</programlisting>
+ * </example>
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <livewallpaper/core.h>
+
+
+/* Maximum number of bytes uploaded per call of lw_texture_loader_process() */
+#define UPLOAD_BUDGET (512 * 1024)
+
+/* Number of threads used to decode images */
+#define DECODE_THREADS 2
+
+/* Increase this if the layout of cached texels changes */
+#define TEXEL_CACHE_VERSION 1
+
+/* Maximum size of all cached texels in bytes */
+#define TEXEL_CACHE_SIZE (G_GUINT64_CONSTANT(256) * 1024 * 1024)
+
+typedef struct _LwTexelCacheHeader LwTexelCacheHeader;
+
+/* Header of a cached texel file, followed by the pixels as stored in a GdkPixbuf */
+struct _LwTexelCacheHeader
+{
+	gchar magic[4];
+	guint32 version;
+	guint32 width;
+	guint32 height;
+	guint32 rowstride;
+	guint32 has_alpha;
+};
+
+typedef struct _LwTexelCacheEntry LwTexelCacheEntry;
+
+/* A cached texel file, used to find the least recently used ones */
+struct _LwTexelCacheEntry
+{
+	gchar *path;
+	guint64 size;
+	gint64 mtime;
+};
+
+typedef struct _LwTextureLoaderJob LwTextureLoaderJob;
+
+struct _LwTextureLoaderJob
+{
+	/* Weak pointer to the placeholder, %NULL if it was finalized meanwhile */
+	LwTexture *texture;
+
+	gchar *path;
+	gboolean is_resource;
+	LwTextureFlags flags;
+
+	/* Creates the image instead of loading path if not %NULL */
+	LwTextureDecodeFunc decode_func;
+	gpointer decode_data;
+	GDestroyNotify decode_notify;
+
+	/* Set by the decoding thread */
+	GdkPixbuf *pixbuf;
+	GError *error;
+
+	/* Texture object receiving the image and the next row to upload */
+	guint name;
+	guint row;
+};
+
+struct _LwTextureLoaderPrivate
+{
+	GThreadPool *pool;
+
+	/* Jobs decoded by the thread pool */
+	GAsyncQueue *decoded;
+
+	/* Jobs waiting for their upload, only used by the OpenGL thread */
+	GQueue *uploads;
+
+	/* Directory of cached texels or %NULL if it is not available */
+	gchar *cache_dir;
+
+	/* Serializes pruning the cache between the decoding threads */
+	GMutex prune_mutex;
+
+	/* Pixel unpack buffer or 0 if pixel buffer objects are not supported */
+	guint pbo;
+	gboolean pbo_checked;
+
+	guint pending;
+};
+
+enum
+{
+	TEXTURE_LOADED,
+	LAST_SIGNAL
+};
+
+static guint loader_signals[LAST_SIGNAL] = { 0 };
+
+static LwTextureLoader *default_loader = NULL;
+
+/**
+ * LwTextureLoader:
+ *
+ * Loads textures on a thread pool and uploads them in slices.
+ *
+ * Since: 0.6
+ */
+
+G_DEFINE_TYPE(LwTextureLoader, lw_texture_loader, G_TYPE_OBJECT)
+
+static void
+lw_texture_loader_job_free(LwTextureLoaderJob *job)
+{
+	if(job->texture)
+		g_object_remove_weak_pointer(G_OBJECT(job->texture), (gpointer*) &(job->texture));
+
+	if(job->name)
+	{
+		lw_gl_state_forget_texture(job->name);
+		glDeleteTextures(1, &(job->name));
+	}
+
+	g_clear_object(&(job->pixbuf));
+	g_clear_error(&(job->error));
+	g_free(job->path);
+
+	if(job->decode_notify)
+		job->decode_notify(job->decode_data);
+
+	g_slice_free(LwTextureLoaderJob, job);
+}
+
+static void
+lw_texture_loader_unmap_texels(G_GNUC_UNUSED guchar *pixels, gpointer data)
+{
+	g_mapped_file_unref(data);
+}
+
+/* Maps cached texels into a GdkPixbuf, returns %NULL if they are not cached or invalid */
+static GdkPixbuf*
+lw_texture_loader_map_texels(const gchar *path)
+{
+	GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+	const LwTexelCacheHeader *header;
+	gsize size, n_channels;
+	guint64 row_size;
+
+	if(file == NULL)
+		return NULL;
+
+	header = (const LwTexelCacheHeader*) g_mapped_file_get_contents(file);
+	size = g_mapped_file_get_length(file);
+
+	if(size < sizeof(LwTexelCacheHeader))
+	{
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	n_channels = (header->has_alpha) ? 4 : 3;
+	row_size = (guint64) header->width * n_channels;
+
+	/* Rows are padded to four bytes like in a GdkPixbuf, and the file holds
+	 * exactly the header and the pixels */
+	if(memcmp(header->magic, "LWTX", 4) != 0 ||
+	   header->version != TEXEL_CACHE_VERSION ||
+	   header->has_alpha > 1 ||
+	   header->width == 0 || header->height == 0 ||
+	   header->width > G_MAXINT || header->height > G_MAXINT ||
+	   header->rowstride < row_size || header->rowstride > row_size + 3 ||
+	   size != sizeof(LwTexelCacheHeader) + (guint64) header->rowstride * (header->height - 1)
+	                                      + row_size)
+	{
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	/* Mark the texels as recently used */
+	g_utime(path, NULL);
+
+	/* The pixbuf keeps the file mapped */
+	return gdk_pixbuf_new_from_data((const guchar*) (header + 1),
+	                                GDK_COLORSPACE_RGB,
+	                                header->has_alpha,
+	                                8,
+	                                header->width,
+	                                header->height,
+	                                header->rowstride,
+	                                lw_texture_loader_unmap_texels,
+	                                file);
+}
+
+static void
+lw_texture_loader_store_texels(const gchar *path, GdkPixbuf *pixbuf)
+{
+	LwTexelCacheHeader header;
+	gsize length = gdk_pixbuf_get_byte_length(pixbuf);
+	gchar *contents = g_malloc(sizeof(header) + length);
+	GError *error = NULL;
+
+	memcpy(header.magic, "LWTX", 4);
+	header.version = TEXEL_CACHE_VERSION;
+	header.width = gdk_pixbuf_get_width(pixbuf);
+	header.height = gdk_pixbuf_get_height(pixbuf);
+	header.rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	header.has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+
+	memcpy(contents, &header, sizeof(header));
+	memcpy(contents + sizeof(header), gdk_pixbuf_read_pixels(pixbuf), length);
+
+	/* Writes to a temporary file first, so other loaders never see half written texels */
+	if(!g_file_set_contents(path, contents, sizeof(header) + length, &error))
+	{
+		g_debug("Could not cache texels: %s", error->message);
+		g_error_free(error);
+	}
+
+	g_free(contents);
+}
+
+static gint
+lw_texel_cache_entry_compare(gconstpointer a, gconstpointer b)
+{
+	const LwTexelCacheEntry *ea = a, *eb = b;
+
+	return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+/* Removes the least recently used texels until the cache fits into TEXEL_CACHE_SIZE */
+static void
+lw_texture_loader_prune_texels(LwTextureLoader *self)
+{
+	GArray *entries = g_array_new(FALSE, FALSE, sizeof(LwTexelCacheEntry));
+	guint64 total = 0;
+	const gchar *name;
+	GDir *dir;
+	guint i;
+
+	g_mutex_lock(&self->priv->prune_mutex);
+
+	dir = g_dir_open(self->priv->cache_dir, 0, NULL);
+	while(dir && (name = g_dir_read_name(dir)) != NULL)
+	{
+		LwTexelCacheEntry entry;
+		GStatBuf buf;
+
+		if(!g_str_has_suffix(name, ".texels"))
+			continue;
+
+		entry.path = g_build_filename(self->priv->cache_dir, name, NULL);
+		if(g_stat(entry.path, &buf) != 0)
+		{
+			g_free(entry.path);
+			continue;
+		}
+
+		entry.size = buf.st_size;
+		entry.mtime = buf.st_mtime;
+		total += entry.size;
+
+		g_array_append_val(entries, entry);
+	}
+
+	if(dir)
+		g_dir_close(dir);
+
+	if(total > TEXEL_CACHE_SIZE)
+	{
+		g_array_sort(entries, lw_texel_cache_entry_compare);
+
+		for(i = 0; i < entries->len && total > TEXEL_CACHE_SIZE; i++)
+		{
+			LwTexelCacheEntry *entry = &g_array_index(entries, LwTexelCacheEntry, i);
+
+			if(g_unlink(entry->path) == 0)
+				total -= entry->size;
+		}
+	}
+
+	g_mutex_unlock(&self->priv->prune_mutex);
+
+	for(i = 0; i < entries->len; i++)
+		g_free(g_array_index(entries, LwTexelCacheEntry, i).path);
+	g_array_free(entries, TRUE);
+}
+
+/* Runs inside the thread pool, must not touch OpenGL or job->texture */
+static void
+lw_texture_loader_decode(gpointer data, gpointer user_data)
+{
+	LwTextureLoaderJob *job = data;
+	LwTextureLoader *self = user_data;
+	GMappedFile *file = NULL;
+	GBytes *bytes;
+	gchar *texels_path = NULL;
+
+	if(job->decode_func)
+	{
+		job->pixbuf = job->decode_func(job->decode_data, &(job->error));
+		g_async_queue_push(self->priv->decoded, job);
+		return;
+	}
+
+	/* Get the encoded image */
+	if(job->is_resource)
+		bytes = g_resources_lookup_data(job->path, G_RESOURCE_LOOKUP_FLAGS_NONE, &(job->error));
+	else
+	{
+		file = g_mapped_file_new(job->path, FALSE, &(job->error));
+		bytes = (file) ? g_mapped_file_get_bytes(file) : NULL;
+	}
+
+	/* Try to use cached texels of the same image */
+	if(bytes && self->priv->cache_dir)
+	{
+		gchar *checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA1, bytes);
+		gchar *name = g_strconcat(checksum, ".texels", NULL);
+
+		texels_path = g_build_filename(self->priv->cache_dir, name, NULL);
+		job->pixbuf = lw_texture_loader_map_texels(texels_path);
+
+		g_free(name);
+		g_free(checksum);
+	}
+
+	if(bytes && job->pixbuf == NULL)
+	{
+		GInputStream *stream = g_memory_input_stream_new_from_bytes(bytes);
+
+		job->pixbuf = gdk_pixbuf_new_from_stream(stream, NULL, &(job->error));
+		g_object_unref(stream);
+
+		if(job->pixbuf && texels_path)
+		{
+			lw_texture_loader_store_texels(texels_path, job->pixbuf);
+			lw_texture_loader_prune_texels(self);
+		}
+	}
+
+	if(bytes)
+		g_bytes_unref(bytes);
+	if(file)
+		g_mapped_file_unref(file);
+	g_free(texels_path);
+
+	g_async_queue_push(self->priv->decoded, job);
+}
+
+static LwTexture*
+lw_texture_loader_load(LwTextureLoader *self,
+                       const gchar *path,
+                       gboolean is_resource,
+                       LwTextureFlags flags)
+{
+	static const guchar transparent[4] = { 0, 0, 0, 0 };
+	LwTextureLoaderJob *job = g_slice_new0(LwTextureLoaderJob);
+	LwTexture *texture = lw_texture_new_from_data(transparent, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+
+	job->texture = texture;
+	g_object_add_weak_pointer(G_OBJECT(texture), (gpointer*) &(job->texture));
+
+	job->path = g_strdup(path);
+	job->is_resource = is_resource;
+	job->flags = flags;
+
+	self->priv->pending++;
+	g_thread_pool_push(self->priv->pool, job, NULL);
+
+	return texture;
+}
+
+/**
+ * lw_texture_loader_get_default:
+ *
+ * Returns the loader used by LiveWallpaper. Its uploads are processed once per frame,
+ * so you usually want to use this loader.
+ *
+ * Returns: (transfer none): The default #LwTextureLoader
+ *
+ * Since: 0.6
+ */
+LwTextureLoader*
+lw_texture_loader_get_default(void)
+{
+	if(default_loader == NULL)
+		default_loader = g_object_new(LW_TYPE_TEXTURE_LOADER, NULL);
+
+	return default_loader;
+}
+
+/**
+ * lw_texture_loader_load_file:
+ * @self: A #LwTextureLoader
+ * @path: Name of the file to load
+ * @flags: #LwTextureFlags for the loaded texture
+ *
+ * Starts loading an image from a file. This function supports all file formats
+ * supported by gdk-pixbuf. If the image can not be loaded, a warning is printed
+ * and the texture stays transparent.
+ *
+ * Returns: A placeholder #LwTexture that receives the image as soon as it is
+ *          loaded. You should use g_object_unref() to free the #LwTexture.
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_texture_loader_load_file(LwTextureLoader *self, const gchar *path, LwTextureFlags flags)
+{
+	return lw_texture_loader_load(self, path, FALSE, flags);
+}
+
+/**
+ * lw_texture_loader_load_resource:
+ * @self: A #LwTextureLoader
+ * @path: Name of the resource to load
+ * @flags: #LwTextureFlags for the loaded texture
+ *
+ * Starts loading an image from a gresource. See lw_texture_loader_load_file().
+ *
+ * Returns: A placeholder #LwTexture that receives the image as soon as it is
+ *          loaded. You should use g_object_unref() to free the #LwTexture.
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_texture_loader_load_resource(LwTextureLoader *self, const gchar *path, LwTextureFlags flags)
+{
+	return lw_texture_loader_load(self, path, TRUE, flags);
+}
+
+/**
+ * lw_texture_loader_load_into:
+ * @self: A #LwTextureLoader
+ * @texture: The #LwTexture receiving the image
+ * @func: (scope notified): Function creating the image
+ * @data: Data passed to @func
+ * @notify: Function to free @data or %NULL
+ * @flags: #LwTextureFlags for the loaded texture
+ *
+ * Calls @func on a thread of the loader and uploads its image into @texture like
+ * the images loaded by lw_texture_loader_load_file(). @texture keeps its old image
+ * until the new one is uploaded completely. The images of @func are not cached.
+ *
+ * Since: 0.6
+ */
+void
+lw_texture_loader_load_into(LwTextureLoader *self, LwTexture *texture,
+                            LwTextureDecodeFunc func, gpointer data,
+                            GDestroyNotify notify, LwTextureFlags flags)
+{
+	LwTextureLoaderJob *job = g_slice_new0(LwTextureLoaderJob);
+
+	job->texture = texture;
+	g_object_add_weak_pointer(G_OBJECT(texture), (gpointer*) &(job->texture));
+
+	job->decode_func = func;
+	job->decode_data = data;
+	job->decode_notify = notify;
+	job->flags = flags;
+
+	self->priv->pending++;
+	g_thread_pool_push(self->priv->pool, job, NULL);
+}
+
+/* Uploads at most @budget bytes of the job's image, returns the number of bytes uploaded.
+ * Compressed images that cannot be uploaded in slices exceed the budget. */
+static guint
+lw_texture_loader_upload_slice(LwTextureLoader *self, LwTextureLoaderJob *job, guint budget)
+{
+	GdkPixbuf *pixbuf = job->pixbuf;
+	guint width     = gdk_pixbuf_get_width(pixbuf),
+	      height    = gdk_pixbuf_get_height(pixbuf),
+	      row_size  = width * gdk_pixbuf_get_n_channels(pixbuf),
+	      rowstride = gdk_pixbuf_get_rowstride(pixbuf),
+	      format    = (gdk_pixbuf_get_has_alpha(pixbuf)) ? GL_RGBA : GL_RGB;
+	/* Rows are aligned to GL_UNPACK_ALIGNMENT, which is 4 by default */
+	guint stride = (row_size + 3) & ~3u;
+	guint rows = MAX(budget / stride, 1);
+	guint internal_format = lw_texture_get_internal_format(format, job->flags);
+	const guchar *src = gdk_pixbuf_read_pixels(pixbuf) + job->row * rowstride;
+	const guchar *pixels;
+	guchar *dst = NULL;
+	gboolean whole = FALSE;
+	guint i;
+
+	if(job->flags & LW_TEXTURE_FLAGS_COMPRESSED)
+	{
+		/* Only S3TC guarantees that glTexSubImage2D works on compressed
+		 * textures, as long as the slices are made of whole 4x4 blocks.
+		 * Other formats get their image in one go. */
+		if(internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+		   internal_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+			rows = MAX(rows & ~3u, 4);
+		else
+			whole = TRUE;
+	}
+	rows = (whole) ? height : MIN(rows, height - job->row);
+
+	lw_gl_state_active_texture(0);
+	lw_gl_state_bind_texture(GL_TEXTURE_2D, job->name);
+
+	/* Allocate the texture's storage before uploading the first slice */
+	if(job->row == 0 && !whole)
+		glTexImage2D(GL_TEXTURE_2D, 0, internal_format,
+		             width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+
+	/* Mipmaps are generated as soon as level 0 changes, so wait for the last slice */
+	if((job->flags & LW_TEXTURE_FLAGS_MIPMAP) && job->row + rows == height)
+		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+
+	if(self->priv->pbo)
+	{
+		lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, self->priv->pbo);
+
+		/* Orphan the previous slice, so we do not have to wait until it is consumed */
+		LW_OPENGL_1_4_HELPER(glBufferData, glBufferDataARB, (GL_PIXEL_UNPACK_BUFFER, rows * stride, NULL, GL_STREAM_DRAW));
+		dst = LW_OPENGL_1_4_HELPER(glMapBuffer, glMapBufferARB, (GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+
+		if(dst == NULL)
+			lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	if(dst != NULL)
+	{
+		for(i = 0; i < rows; i++)
+			memcpy(dst + i * stride, src + i * rowstride, row_size);
+
+		LW_OPENGL_1_4_HELPER(glUnmapBuffer, glUnmapBufferARB, (GL_PIXEL_UNPACK_BUFFER));
+
+		/* The data pointer is an offset into the pixel unpack buffer */
+		pixels = NULL;
+	}
+	else
+	{
+		/* gdk-pixbuf aligns its rows to 4 bytes as well */
+		pixels = src;
+	}
+
+	if(whole)
+		glTexImage2D(GL_TEXTURE_2D, 0, internal_format,
+		             width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+	else
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->row, width, rows,
+		                format, GL_UNSIGNED_BYTE, pixels);
+
+	if(dst != NULL)
+		lw_gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	job->row += rows;
+
+	return rows * stride;
+}
+
+/**
+ * lw_texture_loader_process:
+ * @self: A #LwTextureLoader
+ *
+ * Uploads the next slice of decoded images and emits #LwTextureLoader::texture-loaded
+ * for every texture that became ready. Call this once per frame with a current
+ * OpenGL context. LiveWallpaper already does this for the default loader.
+ *
+ * Since: 0.6
+ */
+void
+lw_texture_loader_process(LwTextureLoader *self)
+{
+	LwTextureLoaderJob *job;
+	guint budget = UPLOAD_BUDGET;
+
+	if(self->priv->pending == 0)
+		return;
+
+	/* Pixel buffer objects are core since OpenGL 2.1 */
+	if(!self->priv->pbo_checked)
+	{
+		self->priv->pbo_checked = TRUE;
+		if(GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)
+			LW_OPENGL_1_4_HELPER(glGenBuffers, glGenBuffersARB, (1, &(self->priv->pbo)));
+	}
+
+	/* Move decoded images to the upload queue */
+	while((job = g_async_queue_try_pop(self->priv->decoded)) != NULL)
+	{
+		if(job->error != NULL)
+		{
+			/* Nobody is interested in the image if the placeholder is gone */
+			if(job->texture != NULL)
+				g_warning("Could not load the texture: %s", job->error->message);
+
+			lw_texture_loader_job_free(job);
+			self->priv->pending--;
+		}
+		else
+			g_queue_push_tail(self->priv->uploads, job);
+	}
+
+	while(budget > 0 && (job = g_queue_peek_head(self->priv->uploads)) != NULL)
+	{
+		guint uploaded;
+
+		/* Skip images whose placeholder has been finalized already */
+		if(job->texture != NULL)
+		{
+			if(job->name == 0)
+				glGenTextures(1, &(job->name));
+
+			uploaded = lw_texture_loader_upload_slice(self, job, budget);
+			budget -= MIN(uploaded, budget);
+
+			/* The budget is used up if the image is not complete yet */
+			if(job->row < (guint) gdk_pixbuf_get_height(job->pixbuf))
+				break;
+
+			lw_texture_replace(job->texture, job->name,
+			                   gdk_pixbuf_get_width(job->pixbuf),
+			                   gdk_pixbuf_get_height(job->pixbuf),
+			                   job->flags);
+			job->name = 0;
+
+			g_signal_emit(self, loader_signals[TEXTURE_LOADED], 0, job->texture);
+		}
+
+		g_queue_pop_head(self->priv->uploads);
+		lw_texture_loader_job_free(job);
+		self->priv->pending--;
+	}
+}
+
+/**
+ * lw_texture_loader_is_busy:
+ * @self: A #LwTextureLoader
+ *
+ * Returns: %TRUE if some textures are still being decoded or uploaded
+ *
+ * Since: 0.6
+ */
+gboolean
+lw_texture_loader_is_busy(LwTextureLoader *self)
+{
+	return self->priv->pending > 0;
+}
+
+static void
+lw_texture_loader_init(LwTextureLoader *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self, LW_TYPE_TEXTURE_LOADER,
+	                                         LwTextureLoaderPrivate);
+
+	self->priv->pool = g_thread_pool_new(lw_texture_loader_decode, self,
+	                                     DECODE_THREADS, FALSE, NULL);
+	self->priv->decoded = g_async_queue_new();
+	self->priv->uploads = g_queue_new();
+
+	g_mutex_init(&self->priv->prune_mutex);
+
+	self->priv->cache_dir = g_build_filename(g_get_user_cache_dir(), "livewallpaper", "textures", NULL);
+	if(g_mkdir_with_parents(self->priv->cache_dir, 0700) != 0)
+	{
+		g_debug("Could not create the texel cache %s", self->priv->cache_dir);
+		g_free(self->priv->cache_dir);
+		self->priv->cache_dir = NULL;
+	}
+
+	self->priv->pbo = 0;
+	self->priv->pbo_checked = FALSE;
+	self->priv->pending = 0;
+}
+
+static void
+lw_texture_loader_finalize(GObject *object)
+{
+	LwTextureLoader *self = LW_TEXTURE_LOADER(object);
+	LwTextureLoaderJob *job;
+
+	/* Drop queued images, but wait for the ones being decoded */
+	g_thread_pool_free(self->priv->pool, TRUE, TRUE);
+
+	while((job = g_async_queue_try_pop(self->priv->decoded)) != NULL)
+		lw_texture_loader_job_free(job);
+	g_async_queue_unref(self->priv->decoded);
+
+	g_queue_free_full(self->priv->uploads, (GDestroyNotify) lw_texture_loader_job_free);
+	g_free(self->priv->cache_dir);
+	g_mutex_clear(&self->priv->prune_mutex);
+
+	if(self->priv->pbo)
+	{
+		lw_gl_state_forget_buffer(self->priv->pbo);
+		LW_OPENGL_1_4_HELPER(glDeleteBuffers, glDeleteBuffersARB, (1, &(self->priv->pbo)));
+	}
+
+	if(default_loader == self)
+		default_loader = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS(lw_texture_loader_parent_class)->finalize(object);
+}
+
+static void
+lw_texture_loader_class_init(LwTextureLoaderClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = lw_texture_loader_finalize;
+
+	g_type_class_add_private(klass, sizeof(LwTextureLoaderPrivate));
+
+	/**
+	 * LwTextureLoader::texture-loaded:
+	 * @loader: The #LwTextureLoader, that emitted the signal
+	 * @texture: The #LwTexture that holds the loaded image now
+	 *
+	 * Emitted when an image has been uploaded completely.
+	 *
+	 * Since: 0.6
+	 */
+	loader_signals[TEXTURE_LOADED] =
+		g_signal_new("texture-loaded",
+		             G_TYPE_FROM_CLASS(klass),
+		             G_SIGNAL_RUN_FIRST,
+		             0,
+		             NULL,
+		             NULL,
+		             g_cclosure_marshal_VOID__OBJECT,
+		             G_TYPE_NONE,
+		             1,
+		             LW_TYPE_TEXTURE);
+}
+
@@ -35,6 +35,13 @@
  * (lw_texture_new_from_data()). In each case you should free the #LwTexture
  * if you don't need it anymore by using g_object_unref().
  *
+ * Textures created with lw_texture_new_from_data_with_flags() or by a
+ * #LwTextureLoader can opt in to mipmaps, anisotropic filtering and compressed
+ * internal formats by passing #LwTextureFlags. Mipmaps and anisotropic filtering
+ * avoid aliasing when a texture is drawn smaller than its size, and compressed
+ * textures need less memory and memory bandwidth. Flags not supported by the
+ * OpenGL implementation are ignored.
+ *
  * <note>
  *   <para>
  *     LwTexture only supports 2D textures at the moment.
@@ -141,12 +148,22 @@ static LwTextureMatrix identity_texture_matrix = {
 
 static gint max_texture_units = 0;
 
+/* Anisotropy used for LW_TEXTURE_FLAGS_ANISOTROPIC, higher values hardly make a difference */
+#define MAX_ANISOTROPY 8.0f
+
+static gfloat max_anisotropy = 0.0f;
+
 struct _LwTexturePrivate
 {
 	guint name;
 	guint target;
 	guint filter;
 	guint wrap;
+	LwTextureFlags flags;
+
+	/* Whether filter and wrap have been passed to OpenGL yet */
+	gboolean filter_applied;
+	gboolean wrap_applied;
 
 	gint width;
 	gint height;
@@ -181,6 +198,108 @@ lw_texture_get_max_texture_units()
 	return max_texture_units;
 }
 
+/**
+ * LwTextureFlags:
+ * @LW_TEXTURE_FLAGS_NONE: A plain texture without mipmaps
+ * @LW_TEXTURE_FLAGS_MIPMAP: Generate mipmaps and use them for minification. GL_LINEAR
+ *                           becomes trilinear filtering.
+ * @LW_TEXTURE_FLAGS_ANISOTROPIC: Use anisotropic filtering if
+ *                                GL_EXT_texture_filter_anisotropic is supported
+ * @LW_TEXTURE_FLAGS_COMPRESSED: Let OpenGL compress the texture, see
+ *                               lw_texture_get_internal_format()
+ *
+ * Flags to opt in to texture features when creating a texture.
+ *
+ * Since: 0.6
+ */
+
+/**
+ * lw_texture_get_internal_format:
+ * @format: Format of the image data, e.g. GL_RGBA
+ * @flags: The #LwTextureFlags of the texture
+ *
+ * Chooses the internal format to store image data of @format in. Without
+ * #LW_TEXTURE_FLAGS_COMPRESSED this is always GL_RGBA. Otherwise S3TC is preferred,
+ * followed by ETC2 and finally the generic compressed formats of OpenGL 1.3.
+ * Single and two channel images passed to lw_texture_new_from_data_with_flags()
+ * use RGTC if it is available. #LwTextureLoader only produces RGB and RGBA images.
+ *
+ * Returns: The internal format to pass to glTexImage2D
+ *
+ * Since: 0.6
+ */
+guint
+lw_texture_get_internal_format(guint format, LwTextureFlags flags)
+{
+	if(!(flags & LW_TEXTURE_FLAGS_COMPRESSED))
+		return GL_RGBA;
+
+	switch(format)
+	{
+		case GL_RGB:
+		case GL_BGR:
+			if(GLEW_EXT_texture_compression_s3tc)
+				return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			if(GLEW_ARB_ES3_compatibility)
+				return GL_COMPRESSED_RGB8_ETC2;
+			return GL_COMPRESSED_RGB;
+
+		case GL_RED:
+			if(GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc)
+				return GL_COMPRESSED_RED_RGTC1;
+			return GL_RGBA;
+
+		case GL_RG:
+			if(GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc)
+				return GL_COMPRESSED_RG_RGTC2;
+			return GL_RGBA;
+
+		case GL_RGBA:
+		case GL_BGRA:
+		default:
+			if(GLEW_EXT_texture_compression_s3tc)
+				return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			if(GLEW_ARB_ES3_compatibility)
+				return GL_COMPRESSED_RGBA8_ETC2_EAC;
+			return GL_COMPRESSED_RGBA;
+	}
+}
+
+/* Returns the minifying function to use for @filter */
+static guint
+lw_texture_get_min_filter(LwTexture *self, guint filter)
+{
+	if(!(self->priv->flags & LW_TEXTURE_FLAGS_MIPMAP))
+		return filter;
+
+	switch(filter)
+	{
+		case GL_LINEAR:
+			return GL_LINEAR_MIPMAP_LINEAR;
+
+		case GL_NEAREST:
+			return GL_NEAREST_MIPMAP_NEAREST;
+
+		default:
+			return filter;
+	}
+}
+
+/* Expects the texture to be bound */
+static void
+lw_texture_apply_anisotropy(LwTexture *self)
+{
+	if(!(self->priv->flags & LW_TEXTURE_FLAGS_ANISOTROPIC) ||
+	   !GLEW_EXT_texture_filter_anisotropic)
+		return;
+
+	if(max_anisotropy == 0.0f)
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy);
+
+	glTexParameterf(self->priv->target, GL_TEXTURE_MAX_ANISOTROPY_EXT,
+	                MIN(max_anisotropy, MAX_ANISOTROPY));
+}
+
 /**
  * LwTexture:
  * @matrix: The #LwTextureMatrix of this texture
@@ -307,6 +426,34 @@ lw_texture_new_from_data(const guchar *data,
                          guint height,
                          guint format,
                          guint type)
+{
+	return lw_texture_new_from_data_with_flags(data, width, height, format, type,
+	                                           LW_TEXTURE_FLAGS_NONE);
+}
+
+/**
+ * lw_texture_new_from_data_with_flags:
+ * @data: A pointer to the image data
+ * @width: Width of the image in pixels
+ * @height: Height of the image in pixels
+ * @format: Format of the image data
+ * @type: Data type of the image data
+ * @flags: #LwTextureFlags to opt in to mipmaps, anisotropic filtering or compression
+ *
+ * Like lw_texture_new_from_data(), but allows to opt in to additional texture features.
+ * Mipmaps are regenerated automatically whenever the texture's image changes.
+ *
+ * Returns: A new #LwTexture. You should use g_object_unref() to free the #LwTexture.
+ *
+ * Since: 0.6
+ */
+LwTexture*
+lw_texture_new_from_data_with_flags(const guchar *data,
+                                    guint width,
+                                    guint height,
+                                    guint format,
+                                    guint type,
+                                    LwTextureFlags flags)
 {
 	LwTexture *texture;
 
@@ -315,13 +462,18 @@ lw_texture_new_from_data(const guchar *data,
 	                       "width", width,
 	                       "height", height,
 	                       NULL);
+	texture->priv->flags = flags;
 
-	glBindTexture(lw_texture_get_target(texture),
-	              lw_texture_get_name(texture));
+	lw_gl_state_bind_texture(lw_texture_get_target(texture),
+	                         lw_texture_get_name(texture));
+
+	/* Available since OpenGL 1.4, it regenerates mipmaps every time level 0 changes */
+	if(flags & LW_TEXTURE_FLAGS_MIPMAP)
+		glTexParameteri(lw_texture_get_target(texture), GL_GENERATE_MIPMAP, GL_TRUE);
 
 	glTexImage2D(lw_texture_get_target(texture),
 	             0,
-	             GL_RGBA,
+	             lw_texture_get_internal_format(format, flags),
 	             width, height,
 	             0,
 	             format,
@@ -330,6 +482,7 @@ lw_texture_new_from_data(const guchar *data,
 
 	lw_texture_set_filter(texture, GL_NEAREST);
 	lw_texture_set_wrap(texture, GL_CLAMP_TO_EDGE);
+	lw_texture_apply_anisotropy(texture);
 
 	return texture;
 }
@@ -419,6 +572,20 @@ lw_texture_get_target(LwTexture *self)
 	return self->priv->target;
 }
 
+/**
+ * lw_texture_get_flags:
+ * @self: A #LwTexture
+ *
+ * Returns: The #LwTextureFlags the texture has been created with
+ *
+ * Since: 0.6
+ */
+LwTextureFlags
+lw_texture_get_flags(LwTexture *self)
+{
+	return self->priv->flags;
+}
+
 /**
  * lw_texture_set_filter:
  * @self: A #LwTexture
@@ -432,18 +599,26 @@ lw_texture_get_target(LwTexture *self)
  * page of <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glTexParameter.xml">glTexParameter</ulink>.
  * This functions sets the GL_TEXTURE_MIN_FILTER and GL_TEXTURE_MAG_FILTER at the same time, so
  * only filters supported by both are vaild arguments.
+ *
+ * If the texture has been created with #LW_TEXTURE_FLAGS_MIPMAP, the minifying function
+ * also blends between mipmaps, so GL_LINEAR results in trilinear filtering.
+ *
+ * Nothing is done if @filter is already the texture's filter. Otherwise the texture
+ * stays bound to the active texture unit afterwards.
  */
 void
 lw_texture_set_filter(LwTexture *self, guint filter)
 {
-	glBindTexture(self->priv->target, self->priv->name);
+	if(self->priv->filter_applied && self->priv->filter == filter)
+		return;
+
+	lw_gl_state_bind_texture(self->priv->target, self->priv->name);
 
 	self->priv->filter = filter;
+	self->priv->filter_applied = TRUE;
 
-	glTexParameteri(self->priv->target, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(self->priv->target, GL_TEXTURE_MIN_FILTER, lw_texture_get_min_filter(self, filter));
 	glTexParameteri(self->priv->target, GL_TEXTURE_MAG_FILTER, filter);
-
-	glBindTexture(self->priv->target, 0);
 }
 
 /**
@@ -469,18 +644,23 @@ lw_texture_get_filter(LwTexture *self)
  * This functions calls <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glTexParameter.xml">glTexParameter</ulink>
  * for GL_TEXTURE_WRAP_S and GL_TEXTURE_WRAP_T. You can find a complete list of all supported
  * parameters at the documentation page of <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glTexParameter.xml">glTexParameter</ulink>.
+ *
+ * Nothing is done if @wrap is already the texture's wrap parameter. Otherwise the texture
+ * stays bound to the active texture unit afterwards.
  */
 void
 lw_texture_set_wrap(LwTexture *self, guint wrap)
 {
-	glBindTexture(self->priv->target, self->priv->name);
+	if(self->priv->wrap_applied && self->priv->wrap == wrap)
+		return;
+
+	lw_gl_state_bind_texture(self->priv->target, self->priv->name);
 
 	self->priv->wrap = wrap;
+	self->priv->wrap_applied = TRUE;
 
 	glTexParameteri(self->priv->target, GL_TEXTURE_WRAP_S, wrap);
 	glTexParameteri(self->priv->target, GL_TEXTURE_WRAP_T, wrap);
-
-	glBindTexture(self->priv->target, 0);
 }
 
 /**
@@ -519,16 +699,63 @@ lw_texture_get_height(LwTexture *self)
 	return self->priv->height;
 }
 
+/**
+ * lw_texture_replace:
+ * @self: A #LwTexture
+ * @name: A texture name returned by <ulink url="http://www.opengl.org/sdk/docs/man/xhtml/glGenTextures.xml">glGenTextures</ulink>
+ * @width: Width of the image stored in @name
+ * @height: Height of the image stored in @name
+ * @flags: The #LwTextureFlags @name has been created with
+ *
+ * Replaces the texture object of @self by @name. The old texture object is
+ * deleted and @self takes the ownership of @name. The current filter and wrap
+ * parameters are applied to the new texture object, so it behaves like the old one.
+ * If @flags contains #LW_TEXTURE_FLAGS_MIPMAP, @name must contain mipmaps already.
+ * #LwTextureLoader uses this to fill placeholder textures.
+ *
+ * Since: 0.6
+ */
+void
+lw_texture_replace(LwTexture *self, guint name, guint width, guint height, LwTextureFlags flags)
+{
+	if(self->priv->name)
+	{
+		lw_gl_state_forget_texture(self->priv->name);
+		glDeleteTextures(1, &(self->priv->name));
+	}
+
+	self->priv->name = name;
+	self->priv->flags = flags;
+
+	lw_gl_state_bind_texture(self->priv->target, name);
+	glTexParameteri(self->priv->target, GL_TEXTURE_MIN_FILTER, lw_texture_get_min_filter(self, self->priv->filter));
+	glTexParameteri(self->priv->target, GL_TEXTURE_MAG_FILTER, self->priv->filter);
+	glTexParameteri(self->priv->target, GL_TEXTURE_WRAP_S, self->priv->wrap);
+	glTexParameteri(self->priv->target, GL_TEXTURE_WRAP_T, self->priv->wrap);
+	lw_texture_apply_anisotropy(self);
+	self->priv->filter_applied = TRUE;
+	self->priv->wrap_applied = TRUE;
+
+	self->priv->width = width;
+	self->matrix.xx = 1.0f / width;
+	self->priv->height = height;
+	self->matrix.yy = 1.0f / height;
+
+	g_object_notify(G_OBJECT(self), "width");
+	g_object_notify(G_OBJECT(self), "height");
+}
+
 /**
  * lw_texture_enable:
  * @self: A #LwTexture
  *
- * Enables the texture target.
+ * Enables the texture target on the active texture unit and binds the texture
+ * with lw_texture_bind().
  */
 void
 lw_texture_enable(LwTexture *self)
 {
-	glEnable(self->priv->target);
+	lw_gl_state_enable(self->priv->target);
 	lw_texture_bind(self);
 }
 
@@ -542,7 +769,7 @@ void
 lw_texture_disable(LwTexture *self)
 {
 	lw_texture_unbind(self);
-	glDisable(self->priv->target);
+	lw_gl_state_disable(self->priv->target);
 }
 
 /**
@@ -587,8 +814,8 @@ lw_texture_bind_to(LwTexture *self, guint unit)
 		return FALSE;
 	}
 
-	glActiveTexture(GL_TEXTURE0 + unit);
-	glBindTexture(self->priv->target, self->priv->name);
+	lw_gl_state_active_texture(unit);
+	lw_gl_state_bind_texture(self->priv->target, self->priv->name);
 	self->priv->bound_to = unit;
 
 	return TRUE;
@@ -609,8 +836,8 @@ lw_texture_bind_to(LwTexture *self, guint unit)
 void
 lw_texture_unbind(LwTexture *self)
 {
-	glActiveTexture(GL_TEXTURE0 + self->priv->bound_to);
-	glBindTexture(self->priv->target, 0);
+	lw_gl_state_active_texture(self->priv->bound_to);
+	lw_gl_state_bind_texture(self->priv->target, 0);
 }
 
 static void
@@ -622,6 +849,9 @@ lw_texture_init(LwTexture *self)
 	self->priv->target = GL_TEXTURE_2D;
 	self->priv->filter = GL_NEAREST;
 	self->priv->wrap = GL_CLAMP_TO_EDGE;
+	self->priv->filter_applied = FALSE;
+	self->priv->wrap_applied = FALSE;
+	self->priv->flags = LW_TEXTURE_FLAGS_NONE;
 
 	self->matrix = identity_texture_matrix;
 
@@ -636,7 +866,10 @@ lw_texture_finalize(GObject *object)
 	LwTexture *self = LW_TEXTURE(object);
 
 	if(self->priv->name)
+	{
+		lw_gl_state_forget_texture(self->priv->name);
 		glDeleteTextures(1, &(self->priv->name));
+	}
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(lw_texture_parent_class)->finalize(object);
@@ -0,0 +1,399 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ * Copyright (C) 2012-2016 Aurélien   Rivière <aurelien.riv@gmail.com>
+ *
+ */
+
+#include <glib.h>
+#include <livewallpaper/core.h>
+#include "orbit.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define GALAXY_ORBIT_X86
+#include <immintrin.h>
+/* The kernels are only used if the CPU supports the instruction set */
+#define GALAXY_ORBIT_SSE2_TARGET __attribute__((target("sse2")))
+#define GALAXY_ORBIT_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GALAXY_ORBIT_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+ * The kernels move the stars along their ellipses and write the x and y
+ * coordinates of the vertices in one pass over the columns. They interpolate
+ * in the sine table of livewallpaper-core like lw_sincos_batch() and do the
+ * same single precision operations in the same order, so they return the
+ * same bits.
+ */
+typedef void (*GalaxyOrbitFunc)(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                                const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                                gfloat elapsed, gfloat *vertices, gsize n);
+
+/* Interpolates the sine and cosine of x, an angle measured in table steps */
+static inline void
+galaxy_orbit_lerp(gfloat x, gfloat *s, gfloat *c)
+{
+	const gint mask = 4 * sin_steps - 1;
+	gint i = (gint) x, is, ic;
+	gfloat f;
+
+	i -= (gfloat) i > x;
+	f = x - (gfloat) i;
+	is = i & mask;
+	ic = (i + sin_steps) & mask;
+
+	*s = sin_values[is] + f * (sin_values[is + 1] - sin_values[is]);
+	*c = sin_values[ic] + f * (sin_values[ic + 1] - sin_values[ic]);
+}
+
+/*
+ * The kernels wrap the angle to (-2PI, 0] without a loop by subtracting
+ * 2PI times the rounded up number of periods, which also works for large steps.
+ */
+static void
+galaxy_orbit_update_scalar(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                           const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                           gfloat elapsed, gfloat *vertices, gsize n)
+{
+	const gfloat scale = 1.0f / step, periods = 1.0f / LW_2PI;
+	gsize k;
+
+	for(k = 0; k < n; k++, vertices += 3)
+	{
+		gfloat a = angle[k] + elapsed * speed[k], q = a * periods, s, c, a_cos_angle, b_sin_angle;
+		gint p = (gint) q;
+
+		p += q > (gfloat) p;
+		a -= (gfloat) p * LW_2PI;
+		angle[k] = a;
+
+		galaxy_orbit_lerp(a * scale, &s, &c);
+
+		/*
+		 * The semi-major axis is the distance, the semi-minor axis is the
+		 * distance times the ratio. The position follows from the general
+		 * parametric form of an ellipse rotated by phi.
+		 */
+		a_cos_angle = distance[k] * c;
+		b_sin_angle = distance[k] * s * ratio;
+
+		vertices[0] = a_cos_angle * cos_phi[k] - b_sin_angle * sin_phi[k];
+		vertices[1] = a_cos_angle * sin_phi[k] + b_sin_angle * cos_phi[k];
+	}
+}
+
+#ifdef GALAXY_ORBIT_X86
+
+/* SSE2 has no gather, so only the table lookups are done per element */
+static inline void GALAXY_ORBIT_SSE2_TARGET
+galaxy_orbit_lerp_sse2(__m128 x, __m128 *s, __m128 *c)
+{
+	const __m128i mask = _mm_set1_epi32(4 * sin_steps - 1), quarter = _mm_set1_epi32(sin_steps);
+	__m128i i = _mm_cvttps_epi32(x);
+	__m128 f;
+	gint is[4], ic[4];
+
+	i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), x)));
+	f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+	_mm_storeu_si128((__m128i*) is, _mm_and_si128(i, mask));
+	_mm_storeu_si128((__m128i*) ic, _mm_and_si128(_mm_add_epi32(i, quarter), mask));
+
+#define GALAXY_ORBIT_SSE2_LERP(idx) \
+	_mm_add_ps(_mm_setr_ps(sin_values[idx[0]], sin_values[idx[1]], sin_values[idx[2]], sin_values[idx[3]]), \
+	           _mm_mul_ps(f, _mm_sub_ps(_mm_setr_ps(sin_values[idx[0] + 1], sin_values[idx[1] + 1], \
+	                                                sin_values[idx[2] + 1], sin_values[idx[3] + 1]), \
+	                                    _mm_setr_ps(sin_values[idx[0]], sin_values[idx[1]], \
+	                                                sin_values[idx[2]], sin_values[idx[3]]))))
+
+	*s = GALAXY_ORBIT_SSE2_LERP(is);
+	*c = GALAXY_ORBIT_SSE2_LERP(ic);
+
+#undef GALAXY_ORBIT_SSE2_LERP
+}
+
+static void GALAXY_ORBIT_SSE2_TARGET
+galaxy_orbit_update_sse2(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                         const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                         gfloat elapsed, gfloat *vertices, gsize n)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / step), periods = _mm_set1_ps(1.0f / LW_2PI);
+	const __m128 two_pi = _mm_set1_ps(LW_2PI), r = _mm_set1_ps(ratio), t = _mm_set1_ps(elapsed);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		__m128 a = _mm_add_ps(_mm_loadu_ps(angle + k), _mm_mul_ps(t, _mm_loadu_ps(speed + k)));
+		__m128 q = _mm_mul_ps(a, periods), s, c, d, cp, sp, a_cos_angle, b_sin_angle;
+		__m128i p = _mm_cvttps_epi32(q);
+		gfloat vx[4], vy[4];
+		gint l;
+
+		p = _mm_sub_epi32(p, _mm_castps_si128(_mm_cmpgt_ps(q, _mm_cvtepi32_ps(p))));
+		a = _mm_sub_ps(a, _mm_mul_ps(_mm_cvtepi32_ps(p), two_pi));
+		_mm_storeu_ps(angle + k, a);
+
+		galaxy_orbit_lerp_sse2(_mm_mul_ps(a, scale), &s, &c);
+
+		d = _mm_loadu_ps(distance + k);
+		cp = _mm_loadu_ps(cos_phi + k);
+		sp = _mm_loadu_ps(sin_phi + k);
+		a_cos_angle = _mm_mul_ps(d, c);
+		b_sin_angle = _mm_mul_ps(_mm_mul_ps(d, s), r);
+
+		_mm_storeu_ps(vx, _mm_sub_ps(_mm_mul_ps(a_cos_angle, cp), _mm_mul_ps(b_sin_angle, sp)));
+		_mm_storeu_ps(vy, _mm_add_ps(_mm_mul_ps(a_cos_angle, sp), _mm_mul_ps(b_sin_angle, cp)));
+
+		/* The z coordinates stay in between */
+		for(l = 0; l < 4; l++)
+		{
+			vertices[3 * (k + l)] = vx[l];
+			vertices[3 * (k + l) + 1] = vy[l];
+		}
+	}
+
+	galaxy_orbit_update_scalar(angle + k, speed + k, distance + k, cos_phi + k, sin_phi + k,
+	                           ratio, elapsed, vertices + 3 * k, n - k);
+}
+
+static inline void GALAXY_ORBIT_AVX2_TARGET
+galaxy_orbit_lerp_avx2(__m256 x, __m256 *s, __m256 *c)
+{
+	const __m256i mask = _mm256_set1_epi32(4 * sin_steps - 1), quarter = _mm256_set1_epi32(sin_steps);
+	__m256i i = _mm256_cvttps_epi32(x), is, ic;
+	__m256 f, v0, v1;
+
+	i = _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(i), x, _CMP_GT_OQ)));
+	f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(i));
+	is = _mm256_and_si256(i, mask);
+	ic = _mm256_and_si256(_mm256_add_epi32(i, quarter), mask);
+
+	v0 = _mm256_i32gather_ps(sin_values, is, 4);
+	v1 = _mm256_i32gather_ps(sin_values + 1, is, 4);
+	*s = _mm256_add_ps(v0, _mm256_mul_ps(f, _mm256_sub_ps(v1, v0)));
+
+	v0 = _mm256_i32gather_ps(sin_values, ic, 4);
+	v1 = _mm256_i32gather_ps(sin_values + 1, ic, 4);
+	*c = _mm256_add_ps(v0, _mm256_mul_ps(f, _mm256_sub_ps(v1, v0)));
+}
+
+static void GALAXY_ORBIT_AVX2_TARGET
+galaxy_orbit_update_avx2(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                         const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                         gfloat elapsed, gfloat *vertices, gsize n)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / step), periods = _mm256_set1_ps(1.0f / LW_2PI);
+	const __m256 two_pi = _mm256_set1_ps(LW_2PI), r = _mm256_set1_ps(ratio), t = _mm256_set1_ps(elapsed);
+	gsize k;
+
+	for(k = 0; k + 8 <= n; k += 8)
+	{
+		__m256 a = _mm256_add_ps(_mm256_loadu_ps(angle + k), _mm256_mul_ps(t, _mm256_loadu_ps(speed + k)));
+		__m256 q = _mm256_mul_ps(a, periods), s, c, d, cp, sp, a_cos_angle, b_sin_angle, vx, vy;
+		__m256i p = _mm256_cvttps_epi32(q);
+		gfloat *v = vertices + 3 * k;
+
+		p = _mm256_sub_epi32(p, _mm256_castps_si256(_mm256_cmp_ps(q, _mm256_cvtepi32_ps(p), _CMP_GT_OQ)));
+		a = _mm256_sub_ps(a, _mm256_mul_ps(_mm256_cvtepi32_ps(p), two_pi));
+		_mm256_storeu_ps(angle + k, a);
+
+		galaxy_orbit_lerp_avx2(_mm256_mul_ps(a, scale), &s, &c);
+
+		d = _mm256_loadu_ps(distance + k);
+		cp = _mm256_loadu_ps(cos_phi + k);
+		sp = _mm256_loadu_ps(sin_phi + k);
+		a_cos_angle = _mm256_mul_ps(d, c);
+		b_sin_angle = _mm256_mul_ps(_mm256_mul_ps(d, s), r);
+
+		vx = _mm256_sub_ps(_mm256_mul_ps(a_cos_angle, cp), _mm256_mul_ps(b_sin_angle, sp));
+		vy = _mm256_add_ps(_mm256_mul_ps(a_cos_angle, sp), _mm256_mul_ps(b_sin_angle, cp));
+
+		/*
+		 * The 8 vertices fill 3 vectors. The x and y coordinates are moved to
+		 * their lanes and blended with the z coordinates, which stay the same.
+		 */
+#define GALAXY_ORBIT_AVX2_INTERLEAVE(l, x_lanes, y_lanes, x_mask, y_mask) \
+	_mm256_storeu_ps(v + 8 * l, \
+	                 _mm256_blend_ps(_mm256_blend_ps(_mm256_loadu_ps(v + 8 * l), \
+	                                                 _mm256_permutevar8x32_ps(vx, x_lanes), x_mask), \
+	                                 _mm256_permutevar8x32_ps(vy, y_lanes), y_mask))
+
+		GALAXY_ORBIT_AVX2_INTERLEAVE(0, _mm256_setr_epi32(0, 0, 0, 1, 0, 0, 2, 0),
+		                   _mm256_setr_epi32(0, 0, 0, 0, 1, 0, 0, 2), 0x49, 0x92);
+		GALAXY_ORBIT_AVX2_INTERLEAVE(1, _mm256_setr_epi32(0, 3, 0, 0, 4, 0, 0, 5),
+		                   _mm256_setr_epi32(0, 0, 3, 0, 0, 4, 0, 0), 0x92, 0x24);
+		GALAXY_ORBIT_AVX2_INTERLEAVE(2, _mm256_setr_epi32(0, 0, 6, 0, 0, 7, 0, 0),
+		                   _mm256_setr_epi32(5, 0, 0, 6, 0, 0, 7, 0), 0x24, 0x49);
+
+#undef GALAXY_ORBIT_AVX2_INTERLEAVE
+	}
+
+	galaxy_orbit_update_sse2(angle + k, speed + k, distance + k, cos_phi + k, sin_phi + k,
+	                         ratio, elapsed, vertices + 3 * k, n - k);
+}
+
+#endif /* GALAXY_ORBIT_X86 */
+
+#ifdef GALAXY_ORBIT_NEON
+
+/* NEON has no gather, so only the table lookups are done per element */
+static float32x4_t
+galaxy_orbit_lookup_neon(const gint *idx, float32x4_t f)
+{
+	gfloat v[8];
+	float32x4_t v0, v1;
+	gint l;
+
+	for(l = 0; l < 4; l++)
+	{
+		v[l] = sin_values[idx[l]];
+		v[l + 4] = sin_values[idx[l] + 1];
+	}
+	v0 = vld1q_f32(v);
+	v1 = vld1q_f32(v + 4);
+
+	return vaddq_f32(v0, vmulq_f32(f, vsubq_f32(v1, v0)));
+}
+
+static inline void
+galaxy_orbit_lerp_neon(float32x4_t x, float32x4_t *s, float32x4_t *c)
+{
+	const int32x4_t mask = vdupq_n_s32(4 * sin_steps - 1), quarter = vdupq_n_s32(sin_steps);
+	int32x4_t i = vcvtq_s32_f32(x);
+	float32x4_t f;
+	gint is[4], ic[4];
+
+	i = vaddq_s32(i, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(i), x)));
+	f = vsubq_f32(x, vcvtq_f32_s32(i));
+	vst1q_s32(is, vandq_s32(i, mask));
+	vst1q_s32(ic, vandq_s32(vaddq_s32(i, quarter), mask));
+
+	*s = galaxy_orbit_lookup_neon(is, f);
+	*c = galaxy_orbit_lookup_neon(ic, f);
+}
+
+static void
+galaxy_orbit_update_neon(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                         const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                         gfloat elapsed, gfloat *vertices, gsize n)
+{
+	const float32x4_t scale = vdupq_n_f32(1.0f / step), periods = vdupq_n_f32(1.0f / LW_2PI);
+	const float32x4_t two_pi = vdupq_n_f32(LW_2PI), r = vdupq_n_f32(ratio), t = vdupq_n_f32(elapsed);
+	gsize k;
+
+	for(k = 0; k + 4 <= n; k += 4)
+	{
+		float32x4_t a = vaddq_f32(vld1q_f32(angle + k), vmulq_f32(t, vld1q_f32(speed + k)));
+		float32x4_t q = vmulq_f32(a, periods), s, c, d, cp, sp, a_cos_angle, b_sin_angle;
+		int32x4_t p = vcvtq_s32_f32(q);
+		float32x4x3_t v;
+
+		p = vsubq_s32(p, vreinterpretq_s32_u32(vcgtq_f32(q, vcvtq_f32_s32(p))));
+		a = vsubq_f32(a, vmulq_f32(vcvtq_f32_s32(p), two_pi));
+		vst1q_f32(angle + k, a);
+
+		galaxy_orbit_lerp_neon(vmulq_f32(a, scale), &s, &c);
+
+		d = vld1q_f32(distance + k);
+		cp = vld1q_f32(cos_phi + k);
+		sp = vld1q_f32(sin_phi + k);
+		a_cos_angle = vmulq_f32(d, c);
+		b_sin_angle = vmulq_f32(vmulq_f32(d, s), r);
+
+		/* Interleave the vertices, the z coordinates are loaded and stored again */
+		v = vld3q_f32(vertices + 3 * k);
+		v.val[0] = vsubq_f32(vmulq_f32(a_cos_angle, cp), vmulq_f32(b_sin_angle, sp));
+		v.val[1] = vaddq_f32(vmulq_f32(a_cos_angle, sp), vmulq_f32(b_sin_angle, cp));
+		vst3q_f32(vertices + 3 * k, v);
+	}
+
+	galaxy_orbit_update_scalar(angle + k, speed + k, distance + k, cos_phi + k, sin_phi + k,
+	                           ratio, elapsed, vertices + 3 * k, n - k);
+}
+
+#endif /* GALAXY_ORBIT_NEON */
+
+/* Picks the fastest kernel the CPU supports, LW_ORBIT_KERNEL limits the choice */
+#define galaxy_orbit_kernel_allowed(forced, name) ((forced) == NULL || g_strcmp0(forced, name) == 0)
+
+static GalaxyOrbitFunc galaxy_orbit_kernel = NULL;
+static const gchar *galaxy_orbit_kernel_name = NULL;
+
+static void
+galaxy_orbit_init(void)
+{
+	static gsize initialized = 0;
+
+	if(g_once_init_enter(&initialized))
+	{
+		const gchar *forced = g_getenv("LW_ORBIT_KERNEL");
+
+		galaxy_orbit_kernel = galaxy_orbit_update_scalar;
+		galaxy_orbit_kernel_name = "scalar";
+
+#if defined(GALAXY_ORBIT_X86)
+		__builtin_cpu_init();
+		if(galaxy_orbit_kernel_allowed(forced, "avx2") && __builtin_cpu_supports("avx2"))
+		{
+			galaxy_orbit_kernel = galaxy_orbit_update_avx2;
+			galaxy_orbit_kernel_name = "avx2";
+		}
+		else if(galaxy_orbit_kernel_allowed(forced, "sse2") && __builtin_cpu_supports("sse2"))
+		{
+			galaxy_orbit_kernel = galaxy_orbit_update_sse2;
+			galaxy_orbit_kernel_name = "sse2";
+		}
+#elif defined(GALAXY_ORBIT_NEON)
+		if(galaxy_orbit_kernel_allowed(forced, "neon"))
+		{
+			galaxy_orbit_kernel = galaxy_orbit_update_neon;
+			galaxy_orbit_kernel_name = "neon";
+		}
+#endif
+
+		g_once_init_leave(&initialized, 1);
+	}
+}
+
+#undef galaxy_orbit_kernel_allowed
+
+/* Returns the name of the kernel used by galaxy_orbit_update(), e.g. "avx2" */
+const gchar*
+galaxy_orbit_get_kernel(void)
+{
+	galaxy_orbit_init();
+
+	return galaxy_orbit_kernel_name;
+}
+
+/*
+ * Moves @n stars along ellipses rotated by phi around the origin. Each angle is
+ * advanced by @elapsed times its speed and wrapped to (-2 pi, 0]. The positions are
+ * written to the x and y coordinates of @vertices, which holds three floats per star.
+ * The semi-minor axis of an ellipse is its distance times @ratio.
+ */
+void
+galaxy_orbit_update(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                    const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                    gfloat elapsed, gfloat *vertices, gsize n)
+{
+	galaxy_orbit_init();
+
+	galaxy_orbit_kernel(angle, speed, distance, cos_phi, sin_phi, ratio, elapsed, vertices, n);
+}
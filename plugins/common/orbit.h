@@ -0,0 +1,44 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ * Copyright (C) 2012-2016 Aurélien   Rivière <aurelien.riv@gmail.com>
+ *
+ */
+
+#ifndef _GALAXY_ORBIT_H_
+#define _GALAXY_ORBIT_H_
+
+#include <glib.h>
+
+/*
+ * The star kernel shared by the galaxy and duckiegalaxy plugins. It is compiled
+ * into each plugin and not part of the public API of livewallpaper-core, so the
+ * symbols are hidden.
+ */
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL const gchar *galaxy_orbit_get_kernel(void);
+
+G_GNUC_INTERNAL void galaxy_orbit_update(gfloat *angle, const gfloat *speed, const gfloat *distance,
+                                         const gfloat *cos_phi, const gfloat *sin_phi, gfloat ratio,
+                                         gfloat elapsed, gfloat *vertices, gsize n);
+
+G_END_DECLS
+
+#endif /* _GALAXY_ORBIT_H_ */
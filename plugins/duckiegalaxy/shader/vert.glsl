@@ -1,8 +0,0 @@
-#version 110
-
-void main(void)
-{
-	gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
-	gl_TexCoord[0] = gl_MultiTexCoord0;
-}
-
@@ -23,7 +23,6 @@
 #include <livewallpaper/core.h>
 #include <libpeas/peas.h>
 
-#include "light.h"
 #include "particle.h"
 #include "duckiegalaxy.h"
 
@@ -40,6 +39,8 @@
 #define YMAX 0.04142135
 #define DEG2RAD (_PI / 180.0f)
 
+#define DUCKIEGALAXY_STAR_COVERAGE 4.0
+
 struct _DuckieGalaxyPluginPrivate
 {
 	GSettings *settings;
@@ -61,9 +62,10 @@ struct _DuckieGalaxyPluginPrivate
 	LwBackground *background;
 
 	gboolean lp_enabled;
-	DuckieGalaxyLightProgram *lp;
+	LwColorizedTexture *light;
 
 	DuckieGalaxyParticleSystem *ps;
+	LwLevelOfDetail *lod;
 };
 
 enum
@@ -197,8 +199,8 @@ duckiegalaxy_plugin_adjust_viewport(G_GNUC_UNUSED LwWallpaper *plugin, LwOutput
 	gdouble xmax = YMAX * lw_output_get_aspect_ratio(output);
 
 	/* Enable blending */
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE); /* Additive */
+	lw_gl_state_enable(GL_BLEND);
+	lw_gl_state_blend_func(GL_SRC_ALPHA, GL_ONE); /* Additive */
 
 	/* Save and reset the coordinate system before touching. */
 	glMatrixMode(GL_PROJECTION);
@@ -220,6 +222,8 @@ duckiegalaxy_plugin_prepare_paint(LwWallpaper *plugin, int ms_since_last_paint)
 {
 	DuckieGalaxyPlugin *self = DUCKIEGALAXY_PLUGIN(plugin);
 
+	lw_level_of_detail_begin_frame(self->priv->lod);
+
 	/* Update particles */
 	duckiegalaxy_particle_system_update(self->priv->ps, ms_since_last_paint);
 
@@ -231,12 +235,15 @@ static void
 duckiegalaxy_plugin_paint(LwWallpaper *plugin, LwOutput *output)
 {
 	DuckieGalaxyPlugin *self = DUCKIEGALAXY_PLUGIN(plugin);
+	LwTexture *light;
 
 	/* Clear color buffer and draw background image */
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	lw_background_draw(self->priv->background, output);
+	lw_level_of_detail_add_output(self->priv->lod, output,
+	                              duckiegalaxy_particle_system_get_star_size(self->priv->ps));
 
 	/* Apply the user defined transformations. */
 	glLoadIdentity();
@@ -256,20 +263,17 @@ duckiegalaxy_plugin_paint(LwWallpaper *plugin, LwOutput *output)
 	/* Draw light. */
 	if(!self->priv->lightTexture) return;
 
-	lw_texture_enable(self->priv->lightTexture);
+	/* The custom colors are baked into a texture when they change */
+	light = self->priv->lp_enabled ? lw_colorized_texture_get_texture(self->priv->light) : NULL;
+	if(!light)
+		light = self->priv->lightTexture;
 
-	/* Save texture environment. */
-	glPushAttrib(GL_TEXTURE_BIT);
+	/* The light and the stars are drawn with texture unit 0 */
+	lw_gl_state_active_texture(0);
+	lw_texture_enable(light);
 
 	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
-	/* Enable light program */
-	if(self->priv->lp_enabled)
-	{
-		lw_program_enable(LW_PROGRAM(self->priv->lp));
-		duckiegalaxy_light_program_set_uniform(self->priv->lp);
-	}
-
 #define DUCKIEGALAXY_LIGHT_SIZE 1.5f
 
 	/* Draw quad. */
@@ -288,17 +292,18 @@ duckiegalaxy_plugin_paint(LwWallpaper *plugin, LwOutput *output)
 		glVertex2f(-DUCKIEGALAXY_LIGHT_SIZE, DUCKIEGALAXY_LIGHT_SIZE);
 	glEnd();
 
-	/* Disable light program */
-	if(self->priv->lp_enabled)
-		lw_program_disable(LW_PROGRAM(self->priv->lp));
-
-	/* Draw particles. */
+	/* Draw particles. This also switches the texture environment back to GL_MODULATE. */
 	duckiegalaxy_particle_system_draw(self->priv->ps);
 
-	/* Restore texture environment. */
-	glPopAttrib();
+	lw_texture_disable(light);
+}
 
-	lw_texture_disable(self->priv->lightTexture);
+static void
+duckiegalaxy_plugin_done_paint(LwWallpaper *plugin)
+{
+	DuckieGalaxyPlugin *self = DUCKIEGALAXY_PLUGIN(plugin);
+
+	lw_level_of_detail_end_frame(self->priv->lod);
 }
 
 static void
@@ -313,8 +318,8 @@ duckiegalaxy_plugin_restore_viewport(G_GNUC_UNUSED LwWallpaper *plugin)
 	glPopMatrix();
 
 	/* Restore blending and other stuffs. */
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_BLEND);
+	lw_gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	lw_gl_state_disable(GL_BLEND);
 }
 
 static void
@@ -344,23 +349,32 @@ duckiegalaxy_plugin_init_plugin(LwWallpaper *plugin)
 	self->priv->settings = g_settings_new("net.launchpad.livewallpaper.plugins.duckiegalaxy");
 
     self->priv->resource = lw_wallpaper_load_gresource (plugin, "duckiegalaxy.gresource");
-	self->priv->lightTexture = lw_texture_new_from_resource    (DUCKIEGALAXY_IMG "galaxy-light.png");
+
+	self->priv->lightTexture = lw_texture_cache_load_resource(lw_texture_cache_get_default(),
+	                                                          DUCKIEGALAXY_IMG "galaxy-light.png",
+	                                                          GL_NEAREST, GL_CLAMP_TO_EDGE,
+	                                                          LW_TEXTURE_FLAGS_NONE);
+	self->priv->light = lw_colorized_texture_new(self->priv->lightTexture);
 	self->priv->background   = lw_background_new_from_resource (DUCKIEGALAXY_IMG "space.png", LwBackgroundTiled);
 
-	self->priv->lp = duckiegalaxy_light_program_new();
 	self->priv->ps = duckiegalaxy_particle_system_new();
 
+	/* The stars are small and blended additively, so they may cover every pixel a few times */
+	self->priv->lod = lw_level_of_detail_new(DUCKIEGALAXY_STAR_COVERAGE);
+	g_settings_bind(self->priv->settings, "auto-quality", self->priv->lod, "enabled", G_SETTINGS_BIND_GET);
+	g_settings_bind(self->priv->settings, "star-count", self->priv->lod, "max-count", G_SETTINGS_BIND_GET);
+	g_object_bind_property(self->priv->lod, "count", self->priv->ps, "star-count", G_BINDING_SYNC_CREATE);
+
     /* Particles */
-    LW_BIND(self->priv->ps, "star-count");
     LW_BIND(self->priv->ps, "star-size");
     LW_BIND(self->priv->ps, "speed-ratio");
     LW_BIND(self->priv->ps, "draw-streaks");
 	LW_BIND_COLOR(self->priv->ps, "star-color");
 
-    /* Light Program */
-	LW_BIND      (self->priv->lp, "color-radius");
-	LW_BIND_COLOR(self->priv->lp, "outer-color");
-	LW_BIND_COLOR(self->priv->lp, "inner-color");
+    /* Light */
+	LW_BIND      (self->priv->light, "color-radius");
+	LW_BIND_COLOR(self->priv->light, "outer-color");
+	LW_BIND_COLOR(self->priv->light, "inner-color");
 
     /* Galaxy */
     LW_BIND(self, "use-custom-light");
@@ -382,7 +396,8 @@ duckiegalaxy_plugin_dispose(GObject *object)
 	g_clear_object(&self->priv->settings);
 	g_clear_object(&self->priv->lightTexture);
 	g_clear_object(&self->priv->background);
-	g_clear_object(&self->priv->lp);
+	g_clear_object(&self->priv->light);
+	g_clear_object(&self->priv->lod);
 	g_clear_object(&self->priv->ps);
 
 	/* Chain up to the parent class */
@@ -426,6 +441,7 @@ lw_wallpaper_iface_init(LwWallpaperInterface *iface)
 	iface->adjust_viewport = duckiegalaxy_plugin_adjust_viewport;
 	iface->prepare_paint = duckiegalaxy_plugin_prepare_paint;
 	iface->paint = duckiegalaxy_plugin_paint;
+	iface->done_paint = duckiegalaxy_plugin_done_paint;
 	iface->restore_viewport = duckiegalaxy_plugin_restore_viewport;
 }
 
@@ -25,30 +25,49 @@
 #include <glib-object.h>
 #include <livewallpaper/core.h>
 #include "particle.h"
+#include "orbit.h"
 
 #define DUCKIEGALAXY_IMG "/net/launchpad/livewallpaper/plugins/duckiegalaxy/images/"
+#define DUCKIEGALAXY_SHADER "resource:///net/launchpad/livewallpaper/plugins/duckiegalaxy/shader/"
 
-typedef struct _Star Star;
-
-struct _Star
+/* The columns of the stars in the LwParticleSystem */
+enum
 {
 	/*
 	 * Those values needed for the general parametic form of an
 	 * ellipse. Phi is the angle between the x-axis and the major
 	 * axis of the ellipse.
 	 */
-	gfloat cos_phi, sin_phi;
+	STAR_COS_PHI,
+	STAR_SIN_PHI,
 
 	/* The current angle/position of this star. */
-	gfloat angle;
+	STAR_ANGLE,
 
 	/* The distance from the center of the galaxy to this star. */
-	gfloat distance;
+	STAR_DISTANCE,
 
 	/* the angular velocity of the star in 1/ms. */
-	gfloat speed;
+	STAR_SPEED,
+
+	/* The distance of the star to the plane of the galaxy. */
+	STAR_Z,
+
+	N_STAR_COLUMNS
 };
 
+/* The names of the columns in the star program */
+static const gchar *star_attributes[N_STAR_COLUMNS] =
+{
+	"cosPhi", "sinPhi", "angle", "distance", "speed", "z"
+};
+
+/*
+ * The time after which the angles are moved forward on the CPU, so the
+ * product of time and speed in the star program stays accurate.
+ */
+#define REBASE_TIME 1000000.0f
+
 /* 0 (line) -> 1.0f (circle) */
 #define ELLIPSE_RATIO .885f
 
@@ -60,9 +79,28 @@ struct _DuckieGalaxyParticleSystemPrivate
 	gboolean draw_streaks;
 	GdkRGBA star_color;
 
-	GArray *stars;
+	LwParticleSystem *stars;
 	gfloat *vertices;
 
+	/*
+	 * The vertices moved on the CPU are streamed into a buffer once per
+	 * frame, so every output draws the same copy.
+	 */
+	LwBuffer *vertex_buffer;
+	gboolean vertices_dirty;
+
+	/* The angle a star with a speed of 1.0 moves in the current frame */
+	gfloat step;
+
+	/*
+	 * The star program moves the stars on the GPU. It gets the columns once
+	 * and the time passed since they have been uploaded every frame.
+	 */
+	LwProgram *star_prog;
+	LwBuffer *star_buffers[N_STAR_COLUMNS];
+	gboolean stars_dirty;
+	gfloat time;
+
 	LwTexture *starTexture;
 };
 
@@ -86,6 +124,7 @@ G_DEFINE_TYPE(DuckieGalaxyParticleSystem, duckiegalaxy_particle_system, G_TYPE_O
 
 static void duckiegalaxy_particle_system_set_star_count(DuckieGalaxyParticleSystem *self, guint count);
 static void duckiegalaxy_particle_system_update_star_texture(DuckieGalaxyParticleSystem *self);
+static void duckiegalaxy_particle_system_rebase(DuckieGalaxyParticleSystem *self);
 
 DuckieGalaxyParticleSystem*
 duckiegalaxy_particle_system_new()
@@ -94,6 +133,21 @@ duckiegalaxy_particle_system_new()
 
 	duckiegalaxy_particle_system_update_star_texture(self);
 
+	/* The stars are moved on the CPU until the star program is linked or if
+	 * gl_PointCoord is not supported */
+	if(GLEW_VERSION_2_1)
+	{
+		guint i;
+
+		self->priv->star_prog = g_object_new(LW_TYPE_PROGRAM, NULL);
+		lw_program_create_and_attach_shader_from_resource(self->priv->star_prog, DUCKIEGALAXY_SHADER "star-vert.glsl", GL_VERTEX_SHADER);
+		lw_program_create_and_attach_shader_from_resource(self->priv->star_prog, DUCKIEGALAXY_SHADER "star-frag.glsl", GL_FRAGMENT_SHADER);
+		lw_program_link_async(self->priv->star_prog);
+
+		for(i = 0; i < N_STAR_COLUMNS; i++)
+			self->priv->star_buffers[i] = lw_buffer_new(GL_STATIC_DRAW);
+	}
+
 	return self;
 }
 
@@ -202,41 +256,53 @@ randng(void)
 }
 
 static inline gfloat
-duckiegalaxy_particle_system_init_star(Star *star)
+duckiegalaxy_particle_system_init_star(LwParticleSystem *stars, guint i)
 {
-	star->angle = rand1f(-LW_2PI);
+	gfloat distance, z;
 
-	star->distance = fabs(randng()) * 0.5f + rand2f(0.001f, 0.05f);
+	lw_particle_system_get_column(stars, STAR_ANGLE)[i] = rand1f(-LW_2PI);
+
+	distance = fabs(randng()) * 0.5f + rand2f(0.001f, 0.05f);
+	lw_particle_system_get_column(stars, STAR_DISTANCE)[i] = distance;
 
 	/*
 	 * Phi depends on the distance of the star to get density waves.
 	 * See http://en.wikipedia.org/wiki/Density_wave_theory
 	 */
-	star->cos_phi = cos(star->distance * LW_2PI);
-	star->sin_phi = sin(star->distance * LW_2PI);
+	lw_particle_system_get_column(stars, STAR_COS_PHI)[i] = cos(distance * LW_2PI);
+	lw_particle_system_get_column(stars, STAR_SIN_PHI)[i] = sin(distance * LW_2PI);
 
 	/* The angular velocity of the star in 1/ms */
-	star->speed = -rand2f(0.00003f, 0.000045f) / star->distance;
+	lw_particle_system_get_column(stars, STAR_SPEED)[i] = -rand2f(0.00003f, 0.000045f) / distance;
+
+	z = ((1 - distance) * 0.25f * randng() /
+         (LW_PI + LW_2PI * pow(distance, 2))   *
+         ((distance < 0.2f) ? 0.8 : 1));
+	lw_particle_system_get_column(stars, STAR_Z)[i] = z;
 
-	return ((1 - star->distance) * 0.25f * randng() /
-            (LW_PI + LW_2PI * pow(star->distance, 2))   *
-            ((star->distance < 0.2f) ? 0.8 : 1));
+	return z;
 }
 
 static void
 duckiegalaxy_particle_system_set_star_count(DuckieGalaxyParticleSystem *self, guint count)
 {
     guint i;
-	g_array_set_size(self->priv->stars, count);
+
+	/* The remaining stars keep their position when the columns are uploaded again */
+	duckiegalaxy_particle_system_rebase(self);
+
+	lw_particle_system_set_count(self->priv->stars, count);
     self->priv->vertices = g_realloc(self->priv->vertices, 3 * count * sizeof(gfloat));
 
     /* Append stars if necessary */
     for(i = self->priv->star_count; i < count; i++)
     {
-        Star *star = &g_array_index(self->priv->stars, Star, i);
-        self->priv->vertices[3 * i + 2] = duckiegalaxy_particle_system_init_star(star);
+        self->priv->vertices[3 * i + 2] = duckiegalaxy_particle_system_init_star(self->priv->stars, i);
     }
 
+	self->priv->stars_dirty = TRUE;
+	self->priv->vertices_dirty = TRUE;
+
 	self->priv->star_count = count;
 }
 
@@ -245,49 +311,100 @@ duckiegalaxy_particle_system_update_star_texture(DuckieGalaxyParticleSystem *sel
 {
 	g_clear_object(&self->priv->starTexture);
 
-	self->priv->starTexture = lw_texture_new_from_resource (
-                            (self->priv->draw_streaks) ? DUCKIEGALAXY_IMG "star-with-streaks.png"
-                                                       : DUCKIEGALAXY_IMG "star.png");
+	/* Toggling draw-streaks reuses the cached textures */
+	self->priv->starTexture = lw_texture_cache_load_resource(lw_texture_cache_get_default(),
+	                              (self->priv->draw_streaks) ? DUCKIEGALAXY_IMG "star-with-streaks.png"
+	                                                         : DUCKIEGALAXY_IMG "star.png",
+	                              GL_LINEAR, GL_CLAMP_TO_EDGE, LW_TEXTURE_FLAGS_MIPMAP);
+}
 
-	if(self->priv->starTexture)
-	{
-		lw_texture_set_filter(self->priv->starTexture, GL_LINEAR);
-		lw_texture_set_wrap(self->priv->starTexture, GL_CLAMP_TO_EDGE);
-	}
+/* Updates a chunk of stars, called from several threads at once */
+static void
+duckiegalaxy_particle_system_update_stars(LwParticleSystem *stars, guint first, guint count, gpointer data)
+{
+	DuckieGalaxyParticleSystem *self = data;
+
+	galaxy_orbit_update(lw_particle_system_get_column(stars, STAR_ANGLE) + first,
+	                    lw_particle_system_get_column(stars, STAR_SPEED) + first,
+	                    lw_particle_system_get_column(stars, STAR_DISTANCE) + first,
+	                    lw_particle_system_get_column(stars, STAR_COS_PHI) + first,
+	                    lw_particle_system_get_column(stars, STAR_SIN_PHI) + first,
+	                    ELLIPSE_RATIO, self->priv->step, self->priv->vertices + 3 * first, count);
+}
+
+guint
+duckiegalaxy_particle_system_get_star_size(DuckieGalaxyParticleSystem *self)
+{
+	return self->priv->star_size;
+}
+
+#define duckiegalaxy_particle_system_has_star_program(self) \
+	((self)->priv->star_prog && lw_program_is_ready((self)->priv->star_prog))
+
+/* Moves the angles to the current time of the star program */
+static void
+duckiegalaxy_particle_system_rebase(DuckieGalaxyParticleSystem *self)
+{
+    if(self->priv->time == 0.0f)
+        return;
+
+    self->priv->step = self->priv->time;
+    self->priv->time = 0.0f;
+    lw_particle_system_update(self->priv->stars, duckiegalaxy_particle_system_update_stars, self);
+    self->priv->stars_dirty = TRUE;
+    self->priv->vertices_dirty = TRUE;
 }
 
 void
 duckiegalaxy_particle_system_update(DuckieGalaxyParticleSystem *self, gint ms_since_last_paint)
 {
-    const Star   * const limit = &g_array_index (self->priv->stars, Star, self->priv->star_count);
-          Star   *       star  = &g_array_index (self->priv->stars, Star, 0);
-    const gfloat         k     =  ms_since_last_paint * self->priv->speed_ratio;
-          gfloat *       v     =  self->priv->vertices;
+    gfloat step = ms_since_last_paint * self->priv->speed_ratio;
 
-    for(; star != limit; ++star, v+=3)
+    /* The star program only needs the time */
+    if(duckiegalaxy_particle_system_has_star_program(self))
     {
-		gfloat a_cos_angle, b_sin_angle;
-
-		/* Make sure that angle is between -2PI and 0! */
-		star->angle += k * star->speed;
-		while(star->angle < -LW_2PI) star->angle += LW_2PI;
-		while(star->angle > 0)     star->angle -= LW_2PI;
-
-		/*
-		 * a is the semi-major axis, here the distance and b is the
-		 * semi-minor axis defined by the distance and the ellipse ratio.
-		 */
-		a_cos_angle = star->distance * lw_cos(star->angle);
-		b_sin_angle = star->distance * lw_sin(star->angle) * ELLIPSE_RATIO;
-
-		/*
-		 * To calculate the current position we use the general
-		 * parametic form of an ellipse.
-		 * See http://en.wikipedia.org/wiki/Ellipse#General_parametric_form
-		 */
-		v[0] = a_cos_angle * star->cos_phi - b_sin_angle * star->sin_phi;
-		v[1] = a_cos_angle * star->sin_phi + b_sin_angle * star->cos_phi;
+        self->priv->time += step;
+        if(fabs(self->priv->time) >= REBASE_TIME)
+            duckiegalaxy_particle_system_rebase(self);
+        return;
     }
+
+    self->priv->step = step;
+    lw_particle_system_update(self->priv->stars, duckiegalaxy_particle_system_update_stars, self);
+    self->priv->stars_dirty = TRUE;
+    self->priv->vertices_dirty = TRUE;
+}
+
+static void
+duckiegalaxy_particle_system_draw_star_program(DuckieGalaxyParticleSystem *self)
+{
+	LwProgram *prog = self->priv->star_prog;
+	guint i;
+
+	/* The columns only change with the star count or when they are rebased */
+	if(self->priv->stars_dirty)
+	{
+		for(i = 0; i < N_STAR_COLUMNS; i++)
+			lw_particle_system_upload_column(self->priv->stars, i, self->priv->star_buffers[i]);
+
+		self->priv->stars_dirty = FALSE;
+	}
+
+	lw_program_enable(prog);
+	glUniform1f(lw_program_get_uniform_location(prog, "time"), self->priv->time);
+
+	for(i = 0; i < N_STAR_COLUMNS; i++)
+		lw_program_set_attribute(prog, star_attributes[i], LW_GLSL_TYPE_FLOAT,
+		                         self->priv->star_buffers[i]);
+
+	glDrawArrays(GL_POINTS, 0, self->priv->star_count);
+
+	/* The light is drawn with the fixed function pipeline */
+	for(i = 0; i < N_STAR_COLUMNS; i++)
+		LW_OPENGL_1_4_HELPER(glDisableVertexAttribArray, glDisableVertexAttribArrayARB,
+		                     (lw_program_get_attrib_location(prog, star_attributes[i])));
+	lw_buffer_unbind(self->priv->star_buffers[0]);
+	lw_program_disable(prog);
 }
 
 void
@@ -297,9 +414,6 @@ duckiegalaxy_particle_system_draw(DuckieGalaxyParticleSystem *self)
 
 	if(self->priv->starTexture) lw_texture_enable(self->priv->starTexture);
 
-	/* Save texture environment */
-	glPushAttrib(GL_TEXTURE_BIT);
-
 	/* glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, quadratic); */
 	glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, 60.0f);
 	glPointParameterf(GL_POINT_SIZE_MIN, 0.1f);
@@ -309,9 +423,7 @@ duckiegalaxy_particle_system_draw(DuckieGalaxyParticleSystem *self)
 	glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
 	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
-	/* Render stars using vertex array */
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnable(GL_POINT_SPRITE);
+	lw_gl_state_enable(GL_POINT_SPRITE);
 
     /* Set star color */
     {
@@ -319,14 +431,33 @@ duckiegalaxy_particle_system_draw(DuckieGalaxyParticleSystem *self)
         glColor4f(c->red, c->green, c->blue, c->alpha);
     }
 
-	glVertexPointer(3, GL_FLOAT, 3 * sizeof(gfloat), self->priv->vertices);
-	glDrawArrays(GL_POINTS, 0, self->priv->star_count);
+	if(duckiegalaxy_particle_system_has_star_program(self))
+		duckiegalaxy_particle_system_draw_star_program(self);
+	else
+	{
+		/* The first output uploads the vertices of this frame */
+		if(self->priv->vertices_dirty && self->priv->star_count)
+		{
+			lw_buffer_stream_data(self->priv->vertex_buffer,
+			                      3 * self->priv->star_count * sizeof(gfloat),
+			                      self->priv->vertices);
+			self->priv->vertices_dirty = FALSE;
+		}
+		else
+			lw_buffer_bind(self->priv->vertex_buffer);
+
+		/* Render stars using the vertex buffer */
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 3 * sizeof(gfloat), NULL);
+		glDrawArrays(GL_POINTS, 0, self->priv->star_count);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		lw_buffer_unbind(self->priv->vertex_buffer);
+	}
 
-	glDisable(GL_POINT_SPRITE);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	lw_gl_state_disable(GL_POINT_SPRITE);
 
 	/* Restore texture environment */
-	glPopAttrib();
+	glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_FALSE);
 
 	if(self->priv->starTexture) lw_texture_disable(self->priv->starTexture);
 }
@@ -342,16 +473,29 @@ duckiegalaxy_particle_system_init(DuckieGalaxyParticleSystem *self)
     self->priv->speed_ratio = 1;
     self->priv->draw_streaks = TRUE;
 
-    self->priv->stars = g_array_new(FALSE, FALSE, sizeof(Star));
+    self->priv->stars = lw_particle_system_new(N_STAR_COLUMNS);
     self->priv->vertices = NULL;
+
+    self->priv->vertex_buffer = lw_buffer_new(GL_STREAM_DRAW);
+    self->priv->vertices_dirty = TRUE;
+
+    self->priv->star_prog = NULL;
+    self->priv->stars_dirty = TRUE;
+    self->priv->time = 0.0f;
 }
 
 static void
 duckiegalaxy_particle_system_dispose(GObject *object)
 {
 	DuckieGalaxyParticleSystem *self = DUCKIEGALAXY_PARTICLE_SYSTEM(object);
+	guint i;
 
 	g_clear_object(&self->priv->starTexture);
+	g_clear_object(&self->priv->star_prog);
+	g_clear_object(&self->priv->vertex_buffer);
+
+	for(i = 0; i < N_STAR_COLUMNS; i++)
+		g_clear_object(&self->priv->star_buffers[i]);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(duckiegalaxy_particle_system_parent_class)->dispose(object);
@@ -362,7 +506,7 @@ duckiegalaxy_particle_system_finalize(GObject *object)
 {
 	DuckieGalaxyParticleSystem *self = DUCKIEGALAXY_PARTICLE_SYSTEM(object);
 
-	g_array_free(self->priv->stars, TRUE);
+	g_object_unref(self->priv->stars);
 	g_free(self->priv->vertices);
 
 	/* Chain up to the parent class */
@@ -54,6 +54,8 @@ GType duckiegalaxy_particle_system_get_type(void);
 
 DuckieGalaxyParticleSystem *duckiegalaxy_particle_system_new();
 
+guint duckiegalaxy_particle_system_get_star_size(DuckieGalaxyParticleSystem *self);
+
 void duckiegalaxy_particle_system_update(DuckieGalaxyParticleSystem *self, gint ms_since_last_paint);
 void duckiegalaxy_particle_system_draw(DuckieGalaxyParticleSystem *self);
 
@@ -0,0 +1,9 @@
+#version 120
+
+uniform sampler2D texture;
+
+void main(void)
+{
+	/* Same as GL_MODULATE */
+	gl_FragColor = gl_Color * texture2D(texture, gl_PointCoord);
+}
@@ -0,0 +1,40 @@
+#version 120
+
+/*
+ * Moves the stars along their orbits. Only the time changes between frames,
+ * the attributes are uploaded once (see galaxy_particle_system_update()).
+ */
+
+/* Has to match ELLIPSE_RATIO in particle.c */
+#define ELLIPSE_RATIO 0.885
+#define TWO_PI 6.2831853
+
+attribute float cosPhi;
+attribute float sinPhi;
+attribute float angle;
+attribute float distance;
+attribute float speed;
+attribute float z;
+
+uniform float time;
+
+void main(void)
+{
+	/* The angle of the star at the current time */
+	float a = mod(angle + time * speed, TWO_PI);
+
+	/*
+	 * a is the semi-major axis, here the distance and b is the
+	 * semi-minor axis defined by the distance and the ellipse ratio.
+	 */
+	float aCosAngle = distance * cos(a);
+	float bSinAngle = distance * sin(a) * ELLIPSE_RATIO;
+
+	/* The general parametic form of an ellipse */
+	vec4 position = vec4(aCosAngle * cosPhi - bSinAngle * sinPhi,
+	                     aCosAngle * sinPhi + bSinAngle * cosPhi,
+	                     z, 1.0);
+
+	gl_Position = gl_ModelViewProjectionMatrix * position;
+	gl_FrontColor = gl_Color;
+}
@@ -54,6 +54,8 @@ GType galaxy_particle_system_get_type(void);
 
 GalaxyParticleSystem *galaxy_particle_system_new();
 
+guint galaxy_particle_system_get_star_size(GalaxyParticleSystem *self);
+
 void galaxy_particle_system_update(GalaxyParticleSystem *self, gint ms_since_last_paint);
 void galaxy_particle_system_draw(GalaxyParticleSystem *self);
 
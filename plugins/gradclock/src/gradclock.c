@@ -131,17 +131,17 @@ gradclock_plugin_update_textures(GradClockPlugin *self)
     cr = lw_cairo_texture_cairo_create (self->priv->tex_sec);
 	draw_grad_circle (cr, self->priv->radius * GRADCLOCK_RADIUS_1, self->priv->radius, self->priv->radius, self->priv->radius, self->priv->color_sec);
 	cairo_destroy (cr);
-	lw_cairo_texture_update (self->priv->tex_sec);
+	lw_cairo_texture_freeze (self->priv->tex_sec);
 	
 	cr = lw_cairo_texture_cairo_create (self->priv->tex_min);
 	draw_grad_circle (cr, self->priv->radius * GRADCLOCK_RADIUS_3, self->priv->radius * GRADCLOCK_RADIUS_2, self->priv->radius * GRADCLOCK_RADIUS_2, self->priv->radius * GRADCLOCK_RADIUS_2, self->priv->color_min);
 	cairo_destroy (cr);
-	lw_cairo_texture_update (self->priv->tex_min);
+	lw_cairo_texture_freeze (self->priv->tex_min);
 	
 	cr = lw_cairo_texture_cairo_create (self->priv->tex_hour);
 	draw_grad_circle (cr, self->priv->radius * GRADCLOCK_RADIUS_5, self->priv->radius * GRADCLOCK_RADIUS_4, self->priv->radius * GRADCLOCK_RADIUS_4, self->priv->radius * GRADCLOCK_RADIUS_4, self->priv->color_hour);
 	cairo_destroy (cr);
-	lw_cairo_texture_update (self->priv->tex_hour);
+	lw_cairo_texture_freeze (self->priv->tex_hour);
 }
 
 static void
@@ -152,11 +152,10 @@ gradclock_plugin_adjust_viewport(LwWallpaper *plugin, LwOutput *output)
 	GradClockPlugin *self = GRADCLOCK_PLUGIN(plugin);
 
 	/* Enable blending */
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	lw_gl_state_enable(GL_BLEND);
+	lw_gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-	/* Save and change texture environment */
-	glPushAttrib(GL_TEXTURE_BIT);
+	/* Change texture environment */
 	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
 	/* Save and reset the coordinate system before touching */
@@ -298,11 +297,11 @@ gradclock_plugin_restore_viewport(G_GNUC_UNUSED LwWallpaper *plugin)
 	glPopMatrix();
 
 	/* Restore texture environment */
-	glPopAttrib();
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
 	/* Restore blending */
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_BLEND);
+	lw_gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	lw_gl_state_disable(GL_BLEND);
 }
 
 static void
@@ -0,0 +1,22 @@
+#version 120
+
+/*
+ * Radial gradient from a bright center slightly above the bottom edge of the
+ * output to a dark border. Positions are in units of the output height.
+ */
+
+#define INNER_COLOR vec3(0.27, 0.27, 0.27)
+#define OUTER_COLOR vec3(0.05, 0.05, 0.05)
+#define CENTER_Y    0.1
+#define RADIUS      1.1
+
+uniform float aspect;
+
+varying vec2 position;
+
+void main(void)
+{
+	float t = distance(position, vec2(0.5 * aspect, CENTER_Y)) / RADIUS;
+
+	gl_FragColor = vec4(mix(INNER_COLOR, OUTER_COLOR, clamp(t, 0.0, 1.0)), 1.0);
+}
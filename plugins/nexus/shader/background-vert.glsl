@@ -0,0 +1,18 @@
+#version 120
+
+/*
+ * Covers the whole output, the quad is already given in clip space
+ * (see nexus_plugin_draw_background()).
+ */
+
+/* Width of the output divided by its height */
+uniform float aspect;
+
+varying vec2 position;
+
+void main(void)
+{
+	/* Height of the output is 1.0, the width grows with the aspect ratio */
+	position = vec2((gl_Vertex.x * 0.5 + 0.5) * aspect, gl_Vertex.y * 0.5 + 0.5);
+	gl_Position = vec4(gl_Vertex.xy, 0.0, 1.0);
+}
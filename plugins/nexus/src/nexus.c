@@ -25,6 +25,8 @@
 #include "particle.h"
 #include "nexus.h"
 
+#define NEXUS_SHADER "resource:///net/launchpad/livewallpaper/plugins/nexus/shader/"
+
 struct _NexusPluginPrivate
 {
 	GSettings *settings;
@@ -32,6 +34,9 @@ struct _NexusPluginPrivate
 
 	NexusParticleSystem *ps;
 
+	/* The background gradient is computed per pixel by background_prog. The
+	 * background texture is only rendered if shaders are not supported. */
+	LwProgram *background_prog;
 	LwBackground *background;
 };
 
@@ -49,11 +54,10 @@ nexus_plugin_adjust_viewport(G_GNUC_UNUSED LwWallpaper *plugin, LwOutput *output
 		  height = lw_output_get_height(output);
 
 	/* Enable blending */
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	lw_gl_state_enable(GL_BLEND);
+	lw_gl_state_blend_func(GL_SRC_ALPHA, GL_ONE);
 
-	/* Save and change texture environment */
-	glPushAttrib(GL_TEXTURE_BIT);
+	/* Change texture environment */
 	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
 	/* Save and reset the coordinate system before touching */
@@ -71,6 +75,35 @@ nexus_plugin_adjust_viewport(G_GNUC_UNUSED LwWallpaper *plugin, LwOutput *output
 	glLoadIdentity();
 }
 
+/* Draws the background gradient at the native resolution of the output */
+static void
+nexus_plugin_draw_background(NexusPlugin *self, LwOutput *output)
+{
+	LwProgram *prog = self->priv->background_prog;
+
+	/* Only the outer color of the gradient is shown until the program is linked */
+	if(!lw_program_is_ready(prog))
+	{
+		glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		return;
+	}
+
+	lw_program_enable(prog);
+	glUniform1f(lw_program_get_uniform_location(prog, "aspect"),
+	            ((gfloat) lw_output_get_width(output)) / lw_output_get_height(output));
+
+	/* The vertex shader ignores the matrices, so the quad is given in clip space */
+	glBegin(GL_QUADS);
+		glVertex2f(-1.0f, -1.0f);
+		glVertex2f(-1.0f,  1.0f);
+		glVertex2f( 1.0f,  1.0f);
+		glVertex2f( 1.0f, -1.0f);
+	glEnd();
+
+	lw_program_disable(prog);
+}
+
 static void
 nexus_plugin_prepare_paint(LwWallpaper *plugin, gint ms_since_last_paint)
 {
@@ -84,11 +117,14 @@ nexus_plugin_paint(LwWallpaper *plugin, LwOutput *output)
 {
 	NexusPlugin *self = NEXUS_PLUGIN(plugin);
 
-	/* Clear color buffer and draw background image */
+	/* Clear color buffer and draw background */
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	lw_background_draw(self->priv->background, output);
+	if(self->priv->background)
+		lw_background_draw(self->priv->background, output);
+	else
+		nexus_plugin_draw_background(self, output);
 
 	/* Draw pulses */
 	nexus_particle_system_draw(self->priv->ps, lw_output_get_longest_side(output));
@@ -105,12 +141,9 @@ nexus_plugin_restore_viewport(G_GNUC_UNUSED LwWallpaper *plugin)
 	glMatrixMode(GL_MODELVIEW);
 	glPopMatrix();
 
-	/* Restore texture environment */
-	/*glPopAttrib();*/
-
 	/* Restore blending */
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_BLEND);
+	lw_gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	lw_gl_state_disable(GL_BLEND);
 }
 
 #define width 1920
@@ -137,7 +170,7 @@ nexus_plugin_create_background_texture()
 
 	cairo_pattern_destroy(pattern);
 	cairo_destroy(cr);
-	lw_cairo_texture_update(texture);
+	lw_cairo_texture_freeze(texture);
 
 	return LW_TEXTURE(texture);
 }
@@ -159,7 +192,16 @@ nexus_plugin_init_plugin(LwWallpaper *plugin)
 
     self->priv->resource = lw_wallpaper_load_gresource (plugin, "nexus.gresource");
 
-	self->priv->background = lw_background_new_from_texture(nexus_plugin_create_background_texture(), LwBackgroundZoom);
+	/* Without shaders the background is rendered into a texture once */
+	if(GLEW_VERSION_2_1)
+	{
+		self->priv->background_prog = g_object_new(LW_TYPE_PROGRAM, NULL);
+		lw_program_create_and_attach_shader_from_resource(self->priv->background_prog, NEXUS_SHADER "background-vert.glsl", GL_VERTEX_SHADER);
+		lw_program_create_and_attach_shader_from_resource(self->priv->background_prog, NEXUS_SHADER "background-frag.glsl", GL_FRAGMENT_SHADER);
+		lw_program_link_async(self->priv->background_prog);
+	}
+	else
+		self->priv->background = lw_background_new_from_texture(nexus_plugin_create_background_texture(), LwBackgroundZoom);
 
 	self->priv->ps = nexus_particle_system_new();
 
@@ -186,6 +228,7 @@ nexus_plugin_dispose(GObject *object)
     lw_unload_gresource (self->priv->resource);
 	g_clear_object(&self->priv->settings);
 	g_clear_object(&self->priv->ps);
+	g_clear_object(&self->priv->background_prog);
 	g_clear_object(&self->priv->background);
 
 	/* Chain up to the parent class */
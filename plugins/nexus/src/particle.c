@@ -19,6 +19,7 @@
  *
  */
 
+#include <string.h>
 #include <glib-object.h>
 #include <gdk/gdk.h>
 #include <livewallpaper/core.h>
@@ -27,24 +28,66 @@
 
 #define NEXUS_RESOURCE "/net/launchpad/livewallpaper/plugins/nexus/"
 
+/* The direction of a pulse, pulses are stored in one bucket per direction */
+typedef enum
+{
+	PULSE_LEFT_TO_RIGHT = 0,
+	PULSE_RIGHT_TO_LEFT,
+	PULSE_BOTTOM_TO_TOP,
+	PULSE_TOP_TO_BOTTOM,
+
+	N_PULSE_DIRECTIONS
+} PulseDirection;
+
+#define PULSE_IS_HORIZONTAL(direction) ((direction) <= PULSE_RIGHT_TO_LEFT)
+
+/* Sign of the velocity, where a pulse starts and how far it travels */
+static const gfloat pulse_sign[N_PULSE_DIRECTIONS]  = { 1.0f, -1.0f,  1.0f, -1.0f };
+static const gfloat pulse_start[N_PULSE_DIRECTIONS] = { 0.0f,  1.0f,  0.0f,  1.0f };
+static const gfloat pulse_end[N_PULSE_DIRECTIONS]   = { 1.0f,  0.0f,  1.0f,  0.0f };
+
 typedef struct _Pulse Pulse;
 
+/* A pulse waiting for its activation */
 struct _Pulse
 {
-	/* Position of the pulse. */
-	gfloat x, y;
+	/* Time in milliseconds at which the pulse appears on the wallpaper */
+	gint64 activation;
+
+	PulseDirection direction;
 
-	/* Velocity of the pulse. */
-	gfloat vx, vy;
+	/* Position along and across the direction of the pulse */
+	gfloat pos, cross;
 
-	/* Length of the pulse. */
+	/* Length of the pulse, which is also its speed per second */
 	gfloat length;
 
 	/* Color of the pulse */
-	GdkRGBA color;
+	guint8 color[4];
+};
 
-	/* Pulse appears after delay milliseconds on the wallpaper. */
-	gint delay;
+typedef struct _PulseBucket PulseBucket;
+
+/* The visible pulses of one direction as separate arrays, so they can be
+ * moved by a loop without branches */
+struct _PulseBucket
+{
+	guint count;
+
+	gfloat *pos;
+	gfloat *cross;
+	gfloat *length;
+	guint8 *color;
+};
+
+typedef struct _PulseVertex PulseVertex;
+
+/* Interleaved vertex of the pulse vertex buffer */
+struct _PulseVertex
+{
+	gfloat x, y;
+	gfloat s, t;
+	guint8 color[4];
 };
 
 struct _NexusParticleSystemPrivate
@@ -55,14 +98,25 @@ struct _NexusParticleSystemPrivate
 
 	guint max_delay;
 
-	GArray *pulses;
+	/* Visible pulses and a min-heap of the delayed pulses sorted by activation.
+	 * Every bucket has room for pulse_count pulses. */
+	PulseBucket buckets[N_PULSE_DIRECTIONS];
+	GArray *delayed;
+	gint64 time;
 
 	guint glow_type;
-	LwTexture *glowTexture;
-	LwTexture *trailTexture;
+	LwTextureAtlas *atlas;
+	const LwTextureMatrix *glow;
+	const LwTextureMatrix *trail;
 
 	GdkRGBA colors[4];
 	gboolean random_colors;
+
+	/* Glow and trail quads of all visible pulses */
+	GArray *vertices;
+	LwBuffer *vertex_buffer;
+	gboolean vertices_dirty;
+	gint vertices_size;
 };
 
 enum
@@ -99,12 +153,24 @@ static void nexus_particle_system_set_glow_type(NexusParticleSystem *self, guint
 NexusParticleSystem*
 nexus_particle_system_new()
 {
+	/* The glows are in the order of NexusGlowType */
+	static const gchar * const images[] = {
+		NEXUS_RESOURCE "images/glow-radial.png",
+		NEXUS_RESOURCE "images/glow-square.png",
+		NEXUS_RESOURCE "images/glow-spiral.png",
+		NEXUS_RESOURCE "images/glow-concentric-cirles.png",
+		NEXUS_RESOURCE "images/trail.png",
+		NULL
+	};
 	NexusParticleSystem *self = g_object_new(NEXUS_TYPE_PARTICLE_SYSTEM, NULL);
 
-	/* Load trail texture? */
-	self->priv->trailTexture = lw_texture_new_from_resource (NEXUS_RESOURCE "images/trail.png");
+	/* Pack all glow types and the trail into one texture. It is packed in the
+	 * background, the matrices are filled in once it is uploaded. */
+	self->priv->atlas = lw_texture_atlas_new_from_resources(images, 1);
+	if(self->priv->atlas)
+		self->priv->trail = lw_texture_atlas_get_matrix(self->priv->atlas, 4);
 
-	/* Load glow texture? */
+	/* Select glow texture */
 	nexus_particle_system_set_glow_type(self, self->priv->glow_type);
 
 	return self;
@@ -126,6 +192,7 @@ nexus_particle_system_set_property(GObject *object,
 
 		case PROP_PULSE_SIZE:
 			self->priv->pulse_size = g_value_get_uint(value);
+			self->priv->vertices_dirty = TRUE;
 			break;
 
 		case PROP_PULSE_LENGTH:
@@ -205,233 +272,411 @@ nexus_particle_system_get_property(GObject *object,
 	}
 }
 
+static inline guint8
+nexus_color_to_byte(gdouble value)
+{
+	return (guint8) (CLAMP(value, 0.0, 1.0) * 255.0 + 0.5);
+}
+
+#define PULSE_HEAP_LESS(heap, a, b) \
+	(g_array_index(heap, Pulse, a).activation < g_array_index(heap, Pulse, b).activation)
+
+static void
+nexus_pulse_heap_swap(GArray *heap, guint a, guint b)
+{
+	Pulse tmp = g_array_index(heap, Pulse, a);
+	g_array_index(heap, Pulse, a) = g_array_index(heap, Pulse, b);
+	g_array_index(heap, Pulse, b) = tmp;
+}
+
+static void
+nexus_pulse_heap_push(GArray *heap, const Pulse *pulse)
+{
+	guint i = heap->len;
+
+	g_array_append_vals(heap, pulse, 1);
+
+	/* Sift up */
+	while(i > 0 && PULSE_HEAP_LESS(heap, i, (i - 1) / 2))
+	{
+		nexus_pulse_heap_swap(heap, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void
+nexus_pulse_heap_pop(GArray *heap, Pulse *pulse)
+{
+	guint i = 0;
+
+	*pulse = g_array_index(heap, Pulse, 0);
+	g_array_index(heap, Pulse, 0) = g_array_index(heap, Pulse, heap->len - 1);
+	g_array_set_size(heap, heap->len - 1);
+
+	/* Sift down */
+	for(;;)
+	{
+		guint child = 2 * i + 1;
+
+		if(child >= heap->len) break;
+		if(child + 1 < heap->len && PULSE_HEAP_LESS(heap, child + 1, child))
+			child++;
+		if(!PULSE_HEAP_LESS(heap, child, i)) break;
+
+		nexus_pulse_heap_swap(heap, i, child);
+		i = child;
+	}
+}
+
+#undef PULSE_HEAP_LESS
+
 static void
 nexus_particle_system_init_pulse(NexusParticleSystem *self, Pulse *pulse)
 {
-	gfloat rd = randf();
+	LwRandom *random = lw_random_get_default();
+	gfloat rd = lw_random_float(random);
+	GdkRGBA color;
+
 	pulse->length = lw_range_randf(self->priv->pulse_length);
-	pulse->delay = rand() % self->priv->max_delay;
+	pulse->activation = self->priv->time + lw_random_uint(random, self->priv->max_delay);
 
 	if (self->priv->random_colors)
 	{
-		pulse->color.red   = randf();
-		pulse->color.green = randf();
-		pulse->color.blue  = randf();
-		pulse->color.alpha = 1.0;
+		color.red   = randf();
+		color.green = randf();
+		color.blue  = randf();
+		color.alpha = 1.0;
 	}
 	else
-		pulse->color = self->priv->colors[rand() % 4];
+		color = self->priv->colors[lw_random_uint(random, 4)];
+
+	pulse->color[0] = nexus_color_to_byte(color.red);
+	pulse->color[1] = nexus_color_to_byte(color.green);
+	pulse->color[2] = nexus_color_to_byte(color.blue);
+	pulse->color[3] = nexus_color_to_byte(color.alpha);
+
+	if(rd > 0.75f)
+		pulse->direction = PULSE_LEFT_TO_RIGHT;
+	else if(rd > 0.5f)
+		pulse->direction = PULSE_RIGHT_TO_LEFT;
+	else if(rd > 0.25f)
+		pulse->direction = PULSE_TOP_TO_BOTTOM;
+	else
+		pulse->direction = PULSE_BOTTOM_TO_TOP;
 
-	if(rd > 0.5f)
-	{
-		pulse->vy = 0.0f;
-		pulse->y = randf();
+	pulse->pos = pulse_start[pulse->direction];
+	pulse->cross = randf();
+}
 
-		if(rd > 0.75f)
-		{
-			/* Left to right */
-			pulse->x = 0.0f;
-			pulse->vx = pulse->length;
-		}
-		else
-		{
-			/* Right to left */
-			pulse->x = 1.0f;
-			pulse->vx = -pulse->length;
-		}
-	}
-	else
-	{
-		pulse->vx = 0.0f;
-		pulse->x = randf();
+/* Creates count new pulses, they appear after their delay */
+static void
+nexus_particle_system_spawn_pulses(NexusParticleSystem *self, guint count)
+{
+	Pulse pulse;
+	guint i;
 
-		if(rd > 0.25f)
-		{
-			/* Top to bottom */
-			pulse->y = 1.0f;
-			pulse->vy = -pulse->length;
-		}
-		else
-		{
-			/* Bottom to top */
-			pulse->y = 0.0f;
-			pulse->vy = pulse->length;
-		}
+	for(i = 0; i < count; i++)
+	{
+		nexus_particle_system_init_pulse(self, &pulse);
+		nexus_pulse_heap_push(self->priv->delayed, &pulse);
 	}
 }
 
 static void
 nexus_particle_system_set_pulse_count(NexusParticleSystem *self, guint count)
 {
-	g_array_set_size(self->priv->pulses, count);
+	guint i, total = self->priv->pulse_count;
+
+	if(count > total)
+	{
+		/* Every bucket must be able to hold all pulses */
+		for(i = 0; i < N_PULSE_DIRECTIONS; i++)
+		{
+			PulseBucket *bucket = &self->priv->buckets[i];
 
-	/* Append pulses */
-	if(self->priv->pulse_count < count)
+			bucket->pos    = g_renew(gfloat, bucket->pos,    count);
+			bucket->cross  = g_renew(gfloat, bucket->cross,  count);
+			bucket->length = g_renew(gfloat, bucket->length, count);
+			bucket->color  = g_renew(guint8, bucket->color,  4 * count);
+		}
+
+		nexus_particle_system_spawn_pulses(self, count - total);
+	}
+	else
 	{
-		guint i;
-		for(i = self->priv->pulse_count; i < count; i++)
+		guint remove = total - count;
+
+		/* Remove delayed pulses first, cutting off the end of the heap keeps it valid */
+		i = MIN(remove, self->priv->delayed->len);
+		g_array_set_size(self->priv->delayed, self->priv->delayed->len - i);
+		remove -= i;
+
+		/* Then remove visible pulses from the end of the buckets */
+		for(i = 0; i < N_PULSE_DIRECTIONS && remove > 0; i++)
 		{
-			Pulse *pulse = &g_array_index(self->priv->pulses, Pulse, i);
-			nexus_particle_system_init_pulse(self, pulse);
+			PulseBucket *bucket = &self->priv->buckets[i];
+			guint n = MIN(remove, bucket->count);
+
+			bucket->count -= n;
+			remove -= n;
 		}
 	}
 
 	self->priv->pulse_count = count;
+	self->priv->vertices_dirty = TRUE;
 }
 
 static inline void
 nexus_particle_system_reinit_pulses(NexusParticleSystem *self)
 {
 	guint i;
-	for(i = 0; i < self->priv->pulse_count; i++)
-	{
-		Pulse *pulse = &g_array_index(self->priv->pulses, Pulse, i);
-		nexus_particle_system_init_pulse(self, pulse);
-	}
+	for(i = 0; i < N_PULSE_DIRECTIONS; i++)
+		self->priv->buckets[i].count = 0;
+
+	g_array_set_size(self->priv->delayed, 0);
+	nexus_particle_system_spawn_pulses(self, self->priv->pulse_count);
+
+	self->priv->vertices_dirty = TRUE;
 }
 
 static void
 nexus_particle_system_set_glow_type(NexusParticleSystem *self, guint type)
 {
-    g_clear_object(&self->priv->glowTexture);
-
-    switch (type)
-    {
-        case NexusGlowTypeSquare:
-            self->priv->glowTexture = lw_texture_new_from_resource (NEXUS_RESOURCE "images/glow-square.png");
-            break;
+	/* All glow types are part of the atlas, the index of a glow is its type */
+	if(type > NexusGlowTypeConcentricCircles)
+		type = NexusGlowTypeRadial;
 
-        case NexusGlowTypeSpiral:
-            self->priv->glowTexture = lw_texture_new_from_resource (NEXUS_RESOURCE "images/glow-spiral.png");
-            break;
+	if(self->priv->atlas)
+		self->priv->glow = lw_texture_atlas_get_matrix(self->priv->atlas, type);
 
-        case NexusGlowTypeConcentricCircles:
-            self->priv->glowTexture = lw_texture_new_from_resource (NEXUS_RESOURCE "images/glow-concentric-cirles.png");
-            break;
+	self->priv->glow_type = type;
+	self->priv->vertices_dirty = TRUE;
+}
 
-        case NexusGlowTypeRadial:
-        default:
-            self->priv->glowTexture = lw_texture_new_from_resource (NEXUS_RESOURCE "images/glow-radial.png");
-            break;
-    }
+/* Moves the pulses of a bucket and returns the number of pulses that left the wallpaper */
+static guint
+nexus_pulse_bucket_update(PulseBucket *bucket, PulseDirection direction, gfloat seconds)
+{
+	gfloat step = pulse_sign[direction] * seconds,
+	       sign = pulse_sign[direction],
+	       end  = pulse_end[direction];
+	gfloat *pos = bucket->pos;
+	const gfloat *length = bucket->length;
+	guint i, count = bucket->count, finished = 0;
+
+	/* The speed of a pulse is its length per second */
+	for(i = 0; i < count; i++)
+		pos[i] += step * length[i];
+
+	/* A pulse is finished when its trail has left the wallpaper */
+	for(i = 0; i < count; i++)
+		finished += (sign * (pos[i] - end) > length[i]);
+
+	if(finished == 0)
+		return 0;
+
+	/* Replace finished pulses by the last ones */
+	for(i = 0; i < count; )
+	{
+		if(sign * (pos[i] - end) > length[i])
+		{
+			count--;
+			pos[i] = pos[count];
+			bucket->cross[i] = bucket->cross[count];
+			bucket->length[i] = bucket->length[count];
+			memcpy(&bucket->color[4 * i], &bucket->color[4 * count], 4);
+		}
+		else
+			i++;
+	}
 
-	self->priv->glow_type = type;
+	bucket->count = count;
+	return finished;
 }
 
 void
 nexus_particle_system_update(NexusParticleSystem *self, gint ms_since_last_paint)
 {
-	guint i;
-	for(i = 0; i < self->priv->pulse_count; i++)
+	gfloat seconds = ms_since_last_paint / 1000.0f;
+	guint i, finished = 0;
+	Pulse pulse;
+
+	self->priv->time += ms_since_last_paint;
+
+	for(i = 0; i < N_PULSE_DIRECTIONS; i++)
+		finished += nexus_pulse_bucket_update(&self->priv->buckets[i], i, seconds);
+
+	/* Finished pulses start again after a new delay */
+	nexus_particle_system_spawn_pulses(self, finished);
+
+	/* Show the pulses whose delay is over */
+	while(self->priv->delayed->len > 0 &&
+	      g_array_index(self->priv->delayed, Pulse, 0).activation <= self->priv->time)
 	{
-		Pulse *pulse = &g_array_index(self->priv->pulses, Pulse, i);
+		PulseBucket *bucket;
 
-		if(pulse->delay > 0)
-		{
-			pulse->delay -= ms_since_last_paint;
-			continue;
-		}
+		nexus_pulse_heap_pop(self->priv->delayed, &pulse);
 
-		if(pulse->vy == 0.0f)
-		{
-			pulse->x += pulse->vx * ms_since_last_paint / 1000;
+		bucket = &self->priv->buckets[pulse.direction];
+		bucket->pos[bucket->count] = pulse.pos;
+		bucket->cross[bucket->count] = pulse.cross;
+		bucket->length[bucket->count] = pulse.length;
+		memcpy(&bucket->color[4 * bucket->count], pulse.color, 4);
+		bucket->count++;
+	}
 
-			if ((pulse->vx < 0 && pulse->x < pulse->vx) ||
-				(pulse->vx > 0 && pulse->x > 1.0f + pulse->vx))
-				nexus_particle_system_init_pulse(self, pulse);
-		}
-		else
-		{
-			pulse->y += pulse->vy * ms_since_last_paint / 1000;
+	self->priv->vertices_dirty = TRUE;
+}
+
+/* Appends the quad for a horizontal trail. m is the LwTextureMatrix of the image inside the atlas. */
+#define PUT_QUAD_H(v, m, c, x1, y1, x2, y2)											\
+		PUT_VERTEX(v, c, x1, y1, LW_TEX_COORD_X(m, 0.0f), LW_TEX_COORD_Y(m, 0.0f));	\
+		PUT_VERTEX(v, c, x1, y2, LW_TEX_COORD_X(m, 0.0f), LW_TEX_COORD_Y(m, 1.0f));	\
+		PUT_VERTEX(v, c, x2, y2, LW_TEX_COORD_X(m, 1.0f), LW_TEX_COORD_Y(m, 1.0f));	\
+		PUT_VERTEX(v, c, x2, y1, LW_TEX_COORD_X(m, 1.0f), LW_TEX_COORD_Y(m, 0.0f))
+
+/* Appends the quad for a vertical trail (Different texture coordinates than PUT_QUAD_H). */
+#define PUT_QUAD_V(v, m, c, x1, y1, x2, y2)											\
+		PUT_VERTEX(v, c, x1, y1, LW_TEX_COORD_X(m, 0.0f), LW_TEX_COORD_Y(m, 1.0f));	\
+		PUT_VERTEX(v, c, x1, y2, LW_TEX_COORD_X(m, 1.0f), LW_TEX_COORD_Y(m, 1.0f));	\
+		PUT_VERTEX(v, c, x2, y2, LW_TEX_COORD_X(m, 1.0f), LW_TEX_COORD_Y(m, 0.0f));	\
+		PUT_VERTEX(v, c, x2, y1, LW_TEX_COORD_X(m, 0.0f), LW_TEX_COORD_Y(m, 0.0f))
+
+#define PUT_VERTEX(v, c, vx, vy, vs, vt)	\
+		(v)->x = (vx);						\
+		(v)->y = (vy);						\
+		(v)->s = (vs);						\
+		(v)->t = (vt);						\
+		(v)->color[0] = (c)[0];				\
+		(v)->color[1] = (c)[1];				\
+		(v)->color[2] = (c)[2];				\
+		(v)->color[3] = (c)[3];				\
+		(v)++
+
+/* Builds the glow and trail quads of all visible pulses for an output whose longest side is size */
+static void
+nexus_particle_system_build_vertices(NexusParticleSystem *self, gint size)
+{
+	gfloat half_glow_size = (4.0f * self->priv->pulse_size) / (2.0f * size);
+	gfloat half_pulse_size = self->priv->pulse_size / (2.0f * size);
+	const LwTextureMatrix *glow = self->priv->glow, *trail = self->priv->trail;
+	PulseVertex *v;
+	guint d, i;
+
+	/* Every pulse needs two quads with four vertices each */
+	g_array_set_size(self->priv->vertices, 8 * self->priv->pulse_count);
+	v = (PulseVertex*) self->priv->vertices->data;
 
-			if ((pulse->vy < 0 && pulse->y < pulse->vy) ||
-				(pulse->vy > 0 && pulse->y > 1.0f + pulse->vy))
-				nexus_particle_system_init_pulse(self, pulse);
+	for(d = 0; d < N_PULSE_DIRECTIONS; d++)
+	{
+		const PulseBucket *bucket = &self->priv->buckets[d];
+
+		for(i = 0; i < bucket->count; i++)
+		{
+			const guint8 *c = &bucket->color[4 * i];
+			gfloat length = bucket->length[i];
+			gfloat x, y;
+
+			if(PULSE_IS_HORIZONTAL(d))
+			{
+				x = bucket->pos[i];
+				y = bucket->cross[i];
+			}
+			else
+			{
+				x = bucket->cross[i];
+				y = bucket->pos[i];
+			}
+
+			/* Glow */
+			PUT_QUAD_H(v, *glow, c, x - half_glow_size, y - half_glow_size,
+			                        x + half_glow_size, y + half_glow_size);
+
+			/* Trail */
+			#define x1 (x - half_pulse_size)
+			#define y1 (y - half_pulse_size)
+			#define x2 (x + half_pulse_size)
+			#define y2 (y + half_pulse_size)
+
+			switch(d)
+			{
+				case PULSE_LEFT_TO_RIGHT:
+					PUT_QUAD_H(v, *trail, c, x2, y2, x1 - length, y1);
+					break;
+
+				case PULSE_RIGHT_TO_LEFT:
+					PUT_QUAD_H(v, *trail, c, x1, y1, x2 + length, y2);
+					break;
+
+				case PULSE_BOTTOM_TO_TOP:
+					PUT_QUAD_V(v, *trail, c, x2, y2, x1, y1 - length);
+					break;
+
+				default:
+					PUT_QUAD_V(v, *trail, c, x1, y1, x2, y2 + length);
+					break;
+			}
+
+			#undef x1
+			#undef y1
+			#undef x2
+			#undef y2
 		}
 	}
+
+	/* Drop the space reserved for delayed pulses */
+	g_array_set_size(self->priv->vertices, v - (PulseVertex*) self->priv->vertices->data);
 }
 
-/* Draws quad for horizontal trail. */
-#define DRAW_QUAD_H(x1, y1, x2, y2)	\
-	glBegin(GL_QUADS);				\
-		glTexCoord2d(0.0f, 0.0f);	\
-		glVertex2f(x1, y1);			\
-		glTexCoord2d(0.0f, 1.0f);	\
-		glVertex2f(x1, y2);			\
-		glTexCoord2d(1.0f, 1.0f);	\
-		glVertex2f(x2, y2);			\
-		glTexCoord2d(1.0f, 0.0f);	\
-		glVertex2f(x2, y1);			\
-	glEnd()
-
-/* Draws quad for vertical trail (Different texture coordinates than DRAW_QUAD_H). */
-#define DRAW_QUAD_V(x1, y1, x2, y2)	\
-	glBegin(GL_QUADS);				\
-		glTexCoord2d(0.0f, 1.0f);	\
-		glVertex2f(x1, y1);			\
-		glTexCoord2d(1.0f, 1.0f);	\
-		glVertex2f(x1, y2);			\
-		glTexCoord2d(1.0f, 0.0f);	\
-		glVertex2f(x2, y2);			\
-		glTexCoord2d(0.0f, 0.0f);	\
-		glVertex2f(x2, y1);			\
-	glEnd()
+#undef PUT_QUAD_H
+#undef PUT_QUAD_V
+#undef PUT_VERTEX
 
 void
 nexus_particle_system_draw(NexusParticleSystem *self, gint size)
 {
-	gfloat half_glow_size = (4.0f * self->priv->pulse_size) / (2.0f * size);
-	gfloat half_pulse_size = self->priv->pulse_size / (2.0f * size);
-	guint i;
+	if(self->priv->atlas == NULL) return;
 
-	for(i = 0; i < self->priv->pulse_count; i++)
+	/* Outputs with the same size share the vertices of a frame */
+	if(self->priv->vertices_dirty || self->priv->vertices_size != size)
 	{
-		Pulse *pulse = &g_array_index(self->priv->pulses, Pulse, i);
-
-		if(pulse->delay > 0) continue;
-
-		/* Set color */
-		glColor4f(pulse->color.red,
-				  pulse->color.green,
-				  pulse->color.blue,
-				  pulse->color.alpha);
-
-		/* Draw glow */
-		lw_texture_enable(self->priv->glowTexture);
-		DRAW_QUAD_H(pulse->x - half_glow_size, pulse->y - half_glow_size,
-		            pulse->x + half_glow_size, pulse->y + half_glow_size);
-		lw_texture_disable(self->priv->glowTexture);
-
-		/* Draw trail */
-		#define x1 (pulse->x - half_pulse_size)
-		#define y1 (pulse->y - half_pulse_size)
-		#define x2 (pulse->x + half_pulse_size)
-		#define y2 (pulse->y + half_pulse_size)
-
-		lw_texture_enable(self->priv->trailTexture);
-		if(pulse->vx > 0)       /* Left to right */
-		{
-			DRAW_QUAD_H(x2, y2, x1 - pulse->length, y1);
-		}
-		else if(pulse->vx < 0)  /* Right to left */
-		{
-			DRAW_QUAD_H(x1, y1, x2 + pulse->length, y2);
-		}
-		else if(pulse->vy > 0)  /* Bottom to top */
-		{
-			DRAW_QUAD_V(x2, y2, x1, y1 - pulse->length);
-		}
-		else                    /* Top to bottom */
-		{
-			DRAW_QUAD_V(x1, y1, x2, y2 + pulse->length);
-		}
-		lw_texture_disable(self->priv->trailTexture);
+		nexus_particle_system_build_vertices(self, size);
+
+		if(self->priv->vertices->len)
+			lw_buffer_stream_data(self->priv->vertex_buffer,
+			                      self->priv->vertices->len * sizeof(PulseVertex),
+			                      self->priv->vertices->data);
 
-		#undef x1
-		#undef y1
-		#undef x2
-		#undef y2
+		self->priv->vertices_dirty = FALSE;
+		self->priv->vertices_size = size;
 	}
+	else
+		lw_buffer_bind(self->priv->vertex_buffer);
+
+	if(self->priv->vertices->len == 0)
+	{
+		lw_buffer_unbind(self->priv->vertex_buffer);
+		return;
+	}
+
+	/* Glows and trails share one texture, so all pulses are drawn at once */
+	lw_texture_enable(LW_TEXTURE(self->priv->atlas));
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(PulseVertex), (gpointer) G_STRUCT_OFFSET(PulseVertex, x));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(PulseVertex), (gpointer) G_STRUCT_OFFSET(PulseVertex, s));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PulseVertex), (gpointer) G_STRUCT_OFFSET(PulseVertex, color));
+
+	glDrawArrays(GL_QUADS, 0, self->priv->vertices->len);
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	lw_buffer_unbind(self->priv->vertex_buffer);
+
+	lw_texture_disable(LW_TEXTURE(self->priv->atlas));
 }
 
 static void
@@ -447,11 +692,19 @@ nexus_particle_system_init(NexusParticleSystem *self)
 
     self->priv->max_delay = 5000;
 
-    self->priv->pulses = g_array_new(FALSE, TRUE, sizeof(Pulse));
+    memset(self->priv->buckets, 0, sizeof(self->priv->buckets));
+    self->priv->delayed = g_array_new(FALSE, FALSE, sizeof(Pulse));
+    self->priv->time = 0;
 
 	self->priv->glow_type = NexusGlowTypeRadial;
-    self->priv->glowTexture = NULL;
-    self->priv->trailTexture = NULL;
+    self->priv->atlas = NULL;
+    self->priv->glow = NULL;
+    self->priv->trail = NULL;
+
+    self->priv->vertices = g_array_new(FALSE, FALSE, sizeof(PulseVertex));
+    self->priv->vertex_buffer = lw_buffer_new(GL_STREAM_DRAW);
+    self->priv->vertices_dirty = TRUE;
+    self->priv->vertices_size = 0;
 }
 
 static void
@@ -459,8 +712,8 @@ nexus_particle_system_dispose(GObject *object)
 {
 	NexusParticleSystem *self = NEXUS_PARTICLE_SYSTEM(object);
 
-	g_clear_object(&self->priv->glowTexture);
-	g_clear_object(&self->priv->trailTexture);
+	g_clear_object(&self->priv->atlas);
+	g_clear_object(&self->priv->vertex_buffer);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(nexus_particle_system_parent_class)->dispose(object);
@@ -471,7 +724,18 @@ nexus_particle_system_finalize(GObject *object)
 {
 	NexusParticleSystem *self = NEXUS_PARTICLE_SYSTEM(object);
 
-	g_array_free(self->priv->pulses, TRUE);
+	guint i;
+
+	for(i = 0; i < N_PULSE_DIRECTIONS; i++)
+	{
+		g_free(self->priv->buckets[i].pos);
+		g_free(self->priv->buckets[i].cross);
+		g_free(self->priv->buckets[i].length);
+		g_free(self->priv->buckets[i].color);
+	}
+
+	g_array_free(self->priv->delayed, TRUE);
+	g_array_free(self->priv->vertices, TRUE);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(nexus_particle_system_parent_class)->finalize(object);
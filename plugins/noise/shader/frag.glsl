@@ -1,10 +1,11 @@
 #version 120
 
-varying vec4 vColor;
+varying float vAlpha;
 
 uniform sampler2D texture;
 
 void main(void)
 {
-	gl_FragColor = texture2D(texture, gl_PointCoord) * vColor;
+	vec4 color = texture2D(texture, gl_PointCoord);
+	gl_FragColor = vec4(color.rgb, color.a * vAlpha);
 }
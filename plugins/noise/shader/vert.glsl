@@ -1,14 +1,23 @@
+/*
+ * Variants (see noise_particle_system_update_variant()):
+ *   CONSTANT_SIZE: all particles have the same size, which is passed as uniform
+ */
+
 attribute vec2 position;
 attribute float alpha;
+#ifdef CONSTANT_SIZE
+uniform float size;
+#else
 attribute float size;
+#endif
 
 uniform mat4 mvp_matrix;
 
-varying vec4 vColor;
+varying float vAlpha;
 
 void main(void)
 {
-	vColor = vec4(1.0, 1.0, 1.0, alpha);
+	vAlpha = alpha;
 	gl_PointSize = size;
 	gl_Position = mvp_matrix * vec4(position, 0.0, 1.0);
 }
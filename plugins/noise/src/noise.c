@@ -36,6 +36,7 @@ struct _NoisePluginPrivate
 
 	LwMatrix *matrix;
 	NoiseParticleSystem *ps;
+	LwLevelOfDetail *lod;
 
 	LwBackground *background;
 };
@@ -53,8 +54,8 @@ noise_plugin_adjust_viewport(LwWallpaper *plugin, LwOutput *output)
 	guint width, height;
 
 	/* Enable blending */
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	lw_gl_state_enable(GL_BLEND);
+	lw_gl_state_blend_func(GL_SRC_ALPHA, GL_ONE);
 
 	/* Change the matrix to fit the screen */
 	width = lw_output_get_width(output);
@@ -72,7 +73,7 @@ noise_plugin_adjust_viewport(LwWallpaper *plugin, LwOutput *output)
 			            0.0, 1.0,
 			            0.0, 1.0);
 
-	glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+	lw_gl_state_enable(GL_VERTEX_PROGRAM_POINT_SIZE);
 }
 
 static void
@@ -80,6 +81,7 @@ noise_plugin_prepare_paint(LwWallpaper *plugin, gint ms_since_last_paint)
 {
 	NoisePlugin *self = NOISE_PLUGIN(plugin);
 
+	lw_level_of_detail_begin_frame(self->priv->lod);
 	noise_particle_system_update(self->priv->ps, ms_since_last_paint);
 }
 
@@ -93,23 +95,33 @@ noise_plugin_paint(LwWallpaper *plugin, LwOutput *output)
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	lw_background_draw(self->priv->background, output);
+	lw_level_of_detail_add_output(self->priv->lod, output,
+	                              noise_particle_system_get_mean_size(self->priv->ps));
 
 	noise_particle_system_draw(self->priv->ps, self->priv->matrix);
 }
 
+static void
+noise_plugin_done_paint(LwWallpaper *plugin)
+{
+	NoisePlugin *self = NOISE_PLUGIN(plugin);
+
+	lw_level_of_detail_end_frame(self->priv->lod);
+}
+
 static void
 noise_plugin_restore_viewport(LwWallpaper *plugin)
 {
 	NoisePlugin *self = NOISE_PLUGIN(plugin);
 
-	glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+	lw_gl_state_disable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
 	/* Restore the matrix */
 	lw_matrix_pop(self->priv->matrix);
 
 	/* Restore blending */
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_BLEND);
+	lw_gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	lw_gl_state_disable(GL_BLEND);
 }
 
 static void
@@ -133,8 +145,12 @@ noise_plugin_init_plugin(LwWallpaper *plugin)
 
 	self->priv->ps = noise_particle_system_new();
 
+	self->priv->lod = lw_level_of_detail_new(1.0);
+	g_settings_bind(self->priv->settings, "auto-quality", self->priv->lod, "enabled", G_SETTINGS_BIND_GET);
+	g_settings_bind(self->priv->settings, "particle-count", self->priv->lod, "max-count", G_SETTINGS_BIND_GET);
+	g_object_bind_property(self->priv->lod, "count", self->priv->ps, "particle-count", G_BINDING_SYNC_CREATE);
+
     /* Particle settings */
-	LW_BIND      (self->priv->ps, "particle-count");
 	LW_BIND      (self->priv->ps, "fade-time");
 	LW_BIND_RANGE(self->priv->ps, "particle-size");
 	LW_BIND_RANGE(self->priv->ps, "lifetime");
@@ -148,6 +164,7 @@ noise_plugin_dispose(GObject *object)
     lw_unload_gresource (self->priv->resource);
 	g_clear_object(&self->priv->settings);
 	g_clear_object(&self->priv->matrix);
+	g_clear_object(&self->priv->lod);
 	g_clear_object(&self->priv->ps);
 	g_clear_object(&self->priv->background);
 
@@ -179,6 +196,7 @@ lw_wallpaper_iface_init(LwWallpaperInterface *iface)
 	iface->adjust_viewport = noise_plugin_adjust_viewport;
 	iface->prepare_paint = noise_plugin_prepare_paint;
 	iface->paint = noise_plugin_paint;
+	iface->done_paint = noise_plugin_done_paint;
 	iface->restore_viewport = noise_plugin_restore_viewport;
 }
 
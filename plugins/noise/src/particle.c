@@ -28,25 +28,36 @@
 
 #define NOISE_RESOURCE "/net/launchpad/livewallpaper/plugins/noise/"
 
-typedef struct
+/* Grid points of the flow field in each direction. The noise changes slowly
+ * over the area of the particles, so a coarse grid is enough. */
+#define FLOW_FIELD_RESOLUTION 128
+
+/* The columns of the particles in the LwParticleSystem */
+enum
 {
 	/* Position, speed and size of the particle */
-	gfloat x, y;
-	gfloat speed;
-	gfloat size;
+	PARTICLE_X,
+	PARTICLE_Y,
+	PARTICLE_SPEED,
+	PARTICLE_SIZE,
 
-	/* A random value which makes the movement of a particle unique */
-	gfloat wander;
+	/* Cosine and sine of a random angle the particle turns the direction of the
+	 * flow field by, which makes the movement of a particle unique */
+	PARTICLE_TURN_COS,
+	PARTICLE_TURN_SIN,
 
 	/* The total lifetime of the particle in milliseconds */
-	int lifetime;
+	PARTICLE_LIFETIME,
 
 	/* The time in milliseconds the particle is alive */
-	int alive;
+	PARTICLE_ALIVE,
 
-	/* The alpha value of the particle */
-	gfloat alpha;
-} Particle;
+	/* The alpha value of the particle and the faded one passed to the shader */
+	PARTICLE_ALPHA,
+	PARTICLE_FADED_ALPHA,
+
+	N_PARTICLE_COLUMNS
+};
 
 struct _NoiseParticleSystemPrivate
 {
@@ -55,10 +66,13 @@ struct _NoiseParticleSystemPrivate
 	gint fade_time;
 	LwRange lifetime;
 
-	GArray *particles;
+	LwParticleSystem *particles;
+	LwFlowField *flow_field;
+
+	/* Milliseconds since the last frame, read by the update threads */
+	gint ms_since_last_paint;
+
 	gfloat *vertices;
-	gfloat *alpha;
-	gfloat *size;
 
 	LwBuffer *vertex_buffer;
 	LwBuffer *alpha_buffer;
@@ -84,6 +98,24 @@ static GParamSpec *obj_properties[N_PROPERTIES] = {NULL, };
 
 G_DEFINE_TYPE(NoiseParticleSystem, noise_particle_system, G_TYPE_OBJECT)
 
+/* If all particles have the same size, the size is passed as uniform
+ * instead of uploading it for every particle */
+#define noise_particle_system_has_constant_size(self) \
+	((self)->priv->particle_size.min == (self)->priv->particle_size.max)
+
+static void
+noise_particle_system_update_variant(NoiseParticleSystem *self)
+{
+	const gchar *defines[] = { "CONSTANT_SIZE", NULL };
+
+	if(self->priv->prog == NULL)
+		return;
+
+	if(noise_particle_system_has_constant_size(self))
+		lw_program_set_defines(self->priv->prog, defines);
+	else
+		lw_program_set_defines(self->priv->prog, NULL);
+}
 
 static void noise_particle_system_set_particle_count(NoiseParticleSystem *self, guint count);
 
@@ -92,15 +124,24 @@ noise_particle_system_new()
 {
 	NoiseParticleSystem *self = g_object_new(NOISE_TYPE_PARTICLE_SYSTEM, NULL);
 
-	/* Load particle texture */
-	self->priv->texture = lw_texture_new_from_resource (NOISE_RESOURCE "images/particle.png");
-
-	/* Load program */
+	/* Load program. Linking is not waited for, so the driver can compile
+	 * the shaders while the particle texture is decoded */
 	self->priv->prog = g_object_new(LW_TYPE_PROGRAM, NULL);
+	noise_particle_system_update_variant(self);
 
     lw_program_create_and_attach_shader_from_resource (self->priv->prog, "resource://"NOISE_RESOURCE "shader/vert.glsl", GL_VERTEX_SHADER);
     lw_program_create_and_attach_shader_from_resource (self->priv->prog, "resource://"NOISE_RESOURCE "shader/frag.glsl", GL_FRAGMENT_SHADER);
-	lw_program_link(self->priv->prog);
+	lw_program_link_async(self->priv->prog);
+
+	/* Load particle texture */
+	self->priv->texture = lw_texture_cache_load_resource(lw_texture_cache_get_default(),
+	                                                     NOISE_RESOURCE "images/particle.png",
+	                                                     GL_NEAREST, GL_CLAMP_TO_EDGE,
+	                                                     LW_TEXTURE_FLAGS_NONE);
+
+	/* Sample the noise once for the area particles can live in */
+	self->priv->flow_field = lw_flow_field_new(-0.1f, -0.1f, 1.2f, 1.2f,
+	                                           FLOW_FIELD_RESOLUTION, FLOW_FIELD_RESOLUTION);
 
 	return self;
 }
@@ -121,6 +162,7 @@ noise_particle_system_set_property(GObject *object,
 
 		case PROP_PARTICLE_SIZE:
 			self->priv->particle_size = *((LwRange*)g_value_get_boxed(value));
+			noise_particle_system_update_variant(self);
 			break;
 
 		case PROP_FADE_TIME:
@@ -169,26 +211,32 @@ noise_particle_system_get_property(GObject *object,
 	}
 }
 
+/* Only uses the random generator of the calling thread, so particles can be
+ * initialized by several update threads at once */
 static inline void
-noise_particle_system_init_particle(NoiseParticleSystem *self, Particle *particle)
+noise_particle_system_init_particle(NoiseParticleSystem *self, guint i)
 {
-	particle->x = randf();
-	particle->y = randf();
+	LwParticleSystem *particles = self->priv->particles;
+	gfloat turn = rand2f(-LW_PI2, LW_PI2);
+
+	lw_particle_system_get_column(particles, PARTICLE_X)[i] = randf();
+	lw_particle_system_get_column(particles, PARTICLE_Y)[i] = randf();
 
-	particle->speed = rand2f(0.000005f, 0.0001f);
-	particle->size = lw_range_randf(self->priv->particle_size);
-	particle->wander = rand2f(0.5f, 1.5f);
+	lw_particle_system_get_column(particles, PARTICLE_SPEED)[i] = rand2f(0.000005f, 0.0001f);
+	lw_particle_system_get_column(particles, PARTICLE_SIZE)[i] = lw_range_randf(self->priv->particle_size);
+	lw_particle_system_get_column(particles, PARTICLE_TURN_COS)[i] = lw_cos(turn);
+	lw_particle_system_get_column(particles, PARTICLE_TURN_SIN)[i] = lw_sin(turn);
 
-	particle->lifetime = 1000 *lw_range_rand(self->priv->lifetime)
-	                   + 2 * self->priv->fade_time;
-	particle->alive = 0;
-	particle->alpha = rand2f(0.1f, 1.0f);
+	lw_particle_system_get_column(particles, PARTICLE_LIFETIME)[i] = 1000 *lw_range_rand(self->priv->lifetime)
+	                                                               + 2 * self->priv->fade_time;
+	lw_particle_system_get_column(particles, PARTICLE_ALIVE)[i] = 0;
+	lw_particle_system_get_column(particles, PARTICLE_ALPHA)[i] = rand2f(0.1f, 1.0f);
 }
 
 static void
 noise_particle_system_set_particle_count(NoiseParticleSystem *self, guint count)
 {
-	g_array_set_size(self->priv->particles, count);
+	lw_particle_system_set_count(self->priv->particles, count);
 
 	/* Append particles */
 	if(self->priv->particle_count < count)
@@ -197,84 +245,103 @@ noise_particle_system_set_particle_count(NoiseParticleSystem *self, guint count)
 
 		for(i = self->priv->particle_count; i < count; i++)
 		{
-			Particle *particle = &g_array_index(self->priv->particles, Particle, i);
-			noise_particle_system_init_particle(self, particle);
+			noise_particle_system_init_particle(self, i);
 		}
 	}
 
 	self->priv->vertices = g_realloc(self->priv->vertices, 2 * count * sizeof(gfloat));
-	self->priv->alpha = g_realloc(self->priv->alpha, count * sizeof(gfloat));
-	self->priv->size = g_realloc(self->priv->size, count * sizeof(gfloat));
 	self->priv->particle_count = count;
 }
 
-void
-noise_particle_system_update(NoiseParticleSystem *self, gint ms_since_last_paint)
+/* Updates a chunk of particles, called from several threads at once */
+static void
+noise_particle_system_update_particles(LwParticleSystem *particles, guint first, guint count, gpointer data)
 {
-	gfloat *v = self->priv->vertices;
+	NoiseParticleSystem *self = data;
+	gfloat *x = lw_particle_system_get_column(particles, PARTICLE_X);
+	gfloat *y = lw_particle_system_get_column(particles, PARTICLE_Y);
+	const gfloat *p_speed = lw_particle_system_get_column(particles, PARTICLE_SPEED);
+	const gfloat *turn_cos = lw_particle_system_get_column(particles, PARTICLE_TURN_COS);
+	const gfloat *turn_sin = lw_particle_system_get_column(particles, PARTICLE_TURN_SIN);
+	const gfloat *lifetime = lw_particle_system_get_column(particles, PARTICLE_LIFETIME);
+	gfloat *alive = lw_particle_system_get_column(particles, PARTICLE_ALIVE);
+	const gfloat *alpha = lw_particle_system_get_column(particles, PARTICLE_ALPHA);
+	gfloat *faded_alpha = lw_particle_system_get_column(particles, PARTICLE_FADED_ALPHA);
+	const gint ms_since_last_paint = self->priv->ms_since_last_paint;
+	const gint fade_time = self->priv->fade_time;
+	gfloat *v = self->priv->vertices + 2 * first;
 	guint i;
 
-	for(i = 0; i < self->priv->particle_count; i++)
+	for(i = first; i < first + count; i++)
 	{
-		float noise, angle, speed;
-    	Particle *p = &g_array_index(self->priv->particles, Particle, i);
+		float noise, dx, dy, speed;
 
-		p->alive += ms_since_last_paint;
-		if(p->lifetime < p->alive || p->x < -0.1f || p->x > 1.1f || p->y < -0.1f || p->y > 1.1f)
+		alive[i] += ms_since_last_paint;
+		if(lifetime[i] < alive[i] || x[i] < -0.1f || x[i] > 1.1f || y[i] < -0.1f || y[i] > 1.1f)
 		{
-			noise_particle_system_init_particle(self, p);
+			noise_particle_system_init_particle(self, i);
 		}
 
-		/* Update position */
-    	noise = lw_simplex_noise_2f(p->x, p->y);
-		angle = LW_2PI * noise * p->wander;
-		speed = p->speed * ms_since_last_paint * noise + 0.00005f;
+		/* Update position. The direction of the flow field is rotated by the
+		 * turn of the particle, so particles at the same spot still move into
+		 * different directions. */
+		lw_flow_field_sample(self->priv->flow_field, x[i], y[i], &dx, &dy, &noise);
+		speed = (p_speed[i] * ms_since_last_paint * noise + 0.00005f) * 0.33f;
 
-		p->x += cos(angle) * speed * 0.33;
-		p->y += sin(angle) * speed * 0.33;
+		x[i] += (dx * turn_cos[i] - dy * turn_sin[i]) * speed;
+		y[i] += (dx * turn_sin[i] + dy * turn_cos[i]) * speed;
 
-		v[0] = p->x;
-		v[1] = p->y;
+		v[0] = x[i];
+		v[1] = y[i];
 		v += 2;
 
 		/* Update alpha */
-		if(p->alive < self->priv->fade_time)
+		if(alive[i] < fade_time)
 		{
 			/* Fade in */
-			self->priv->alpha[i] = p->alpha * p->alive / self->priv->fade_time;
+			faded_alpha[i] = alpha[i] * alive[i] / fade_time;
 		}
-		else if(p->lifetime - p->alive < self->priv->fade_time)
+		else if(lifetime[i] - alive[i] < fade_time)
 		{
 			/* Fade out */
-			self->priv->alpha[i] = p->alpha * (p->lifetime - p->alive) / self->priv->fade_time;
+			faded_alpha[i] = alpha[i] * (lifetime[i] - alive[i]) / fade_time;
 		}
 		else
 		{
-			self->priv->alpha[i] = p->alpha;
+			faded_alpha[i] = alpha[i];
 		}
-
-		/* Update size */
-		self->priv->size[i] = p->size;
 	}
+}
 
-	/* Put data into the buffers */
+gfloat
+noise_particle_system_get_mean_size(NoiseParticleSystem *self)
+{
+	return (self->priv->particle_size.min + self->priv->particle_size.max) / 2.0f;
+}
+
+void
+noise_particle_system_update(NoiseParticleSystem *self, gint ms_since_last_paint)
+{
+	self->priv->ms_since_last_paint = ms_since_last_paint;
+	lw_particle_system_update(self->priv->particles, noise_particle_system_update_particles, self);
+
+	/* Put data into the buffers, the columns are uploaded as they are */
 	lw_buffer_set_data(self->priv->vertex_buffer,
 	                   2 * self->priv->particle_count * sizeof(gfloat),
 	                   self->priv->vertices);
-	lw_buffer_set_data(self->priv->alpha_buffer,
-	                   self->priv->particle_count * sizeof(gfloat),
-	                   self->priv->alpha);
-	lw_buffer_set_data(self->priv->size_buffer,
-	                   self->priv->particle_count * sizeof(gfloat),
-	                   self->priv->size);
+	lw_particle_system_upload_column(self->priv->particles, PARTICLE_FADED_ALPHA,
+	                                 self->priv->alpha_buffer);
+	if(!noise_particle_system_has_constant_size(self))
+		lw_particle_system_upload_column(self->priv->particles, PARTICLE_SIZE,
+		                                 self->priv->size_buffer);
 }
 
 void
 noise_particle_system_draw(NoiseParticleSystem *self, LwMatrix *matrix)
 {
-	if(!self->priv->prog) return;
+	if(!self->priv->prog || !lw_program_is_ready(self->priv->prog)) return;
 
-	glEnable(GL_POINT_SPRITE);
+	lw_gl_state_enable(GL_POINT_SPRITE);
 
 	glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, 60.0f);
 	/*glPointParameterf(GL_POINT_SIZE_MIN, 0.1f);*/
@@ -288,9 +355,13 @@ noise_particle_system_draw(NoiseParticleSystem *self, LwMatrix *matrix)
 	lw_program_set_attribute(self->priv->prog, "alpha",
 	                         LW_GLSL_TYPE_FLOAT,
 	                         self->priv->alpha_buffer);
-	lw_program_set_attribute(self->priv->prog, "size",
-	                         LW_GLSL_TYPE_FLOAT,
-	                         self->priv->size_buffer);
+	if(noise_particle_system_has_constant_size(self))
+		glUniform1f(lw_program_get_uniform_location(self->priv->prog, "size"),
+		            self->priv->particle_size.min);
+	else
+		lw_program_set_attribute(self->priv->prog, "size",
+		                         LW_GLSL_TYPE_FLOAT,
+		                         self->priv->size_buffer);
 	lw_program_set_matrix(self->priv->prog, "mvp_matrix", matrix);
 
 	if(self->priv->texture)
@@ -305,7 +376,7 @@ noise_particle_system_draw(NoiseParticleSystem *self, LwMatrix *matrix)
 	if(self->priv->texture)
 		lw_texture_unbind(self->priv->texture);
 
-	glDisable(GL_POINT_SPRITE);
+	lw_gl_state_disable(GL_POINT_SPRITE);
 }
 
 static void
@@ -321,7 +392,9 @@ noise_particle_system_init(NoiseParticleSystem *self)
 	self->priv->lifetime.min = 30;
 	self->priv->lifetime.max = 80;
 
-	self->priv->particles = g_array_new(FALSE, TRUE, sizeof(Particle));
+	self->priv->particles = lw_particle_system_new(N_PARTICLE_COLUMNS);
+	self->priv->ms_since_last_paint = 0;
+	self->priv->vertices = NULL;
 
 	/* Create buffers */
 	self->priv->vertex_buffer = lw_buffer_new(GL_STREAM_DRAW);
@@ -350,10 +423,9 @@ noise_particle_system_finalize(GObject *object)
 {
 	NoiseParticleSystem *self = NOISE_PARTICLE_SYSTEM(object);
 
-	g_array_free(self->priv->particles, TRUE);
+	g_object_unref(self->priv->particles);
+	g_clear_object(&self->priv->flow_field);
 	g_free(self->priv->vertices);
-	g_free(self->priv->alpha);
-	g_free(self->priv->size);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS(noise_particle_system_parent_class)->finalize(object);
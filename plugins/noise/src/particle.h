@@ -53,6 +53,8 @@ GType noise_particle_system_get_type(void);
 
 NoiseParticleSystem *noise_particle_system_new();
 
+gfloat noise_particle_system_get_mean_size(NoiseParticleSystem *self);
+
 void noise_particle_system_update(NoiseParticleSystem *self, gint ms_since_last_paint);
 void noise_particle_system_draw(NoiseParticleSystem *self, LwMatrix *matrix);
 
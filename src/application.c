@@ -65,6 +65,10 @@ struct _LwApplicationPrivate
 
 	LwPowerManager *pm;
 	LwFPSVisualizer *fps;
+	guint frames_since_gl_report;
+
+	/* The wallpaper changes OpenGL state without lw_gl_state_*() */
+	gboolean wallpaper_bypasses_gl_state;
 };
 
 enum
@@ -130,17 +134,42 @@ lw_application_get_property(GObject *object,
 	}
 }
 
+/* Forgets the cached OpenGL state after every callback of a wallpaper that
+ * changes OpenGL state directly (e.g. Python plugins) */
+#define lw_application_wallpaper_changed_gl_state() \
+	if(self->priv->wallpaper_bypasses_gl_state)     \
+		lw_gl_state_invalidate();
+
 #define lw_application_adjust_viewport()                        \
 	if(self->priv->wallpaper && self->priv->n_outputs == 1)     \
 	{                                                           \
 		LwOutput *o = self->priv->outputs->data;                \
 		lw_output_make_current(o);                              \
 		lw_wallpaper_adjust_viewport(self->priv->wallpaper, o); \
+		lw_application_wallpaper_changed_gl_state();            \
 	}
 
 #define lw_application_restore_viewport()                     \
 	if(self->priv->wallpaper && self->priv->n_outputs == 1)   \
-		lw_wallpaper_restore_viewport(self->priv->wallpaper);
+	{                                                         \
+		lw_wallpaper_restore_viewport(self->priv->wallpaper); \
+		lw_application_wallpaper_changed_gl_state();          \
+	}
+
+/* Plugins can opt out of the OpenGL state cache with X-GLStateCache=false in their
+ * plugin file. Without that key, only plugins written in C are expected to use it,
+ * Python plugins usually call OpenGL directly. */
+static gboolean
+lw_application_wallpaper_bypasses_gl_state(PeasPluginInfo *info, LwWallpaper *wallpaper)
+{
+	const gchar *value = peas_plugin_info_get_external_data(info, "GLStateCache");
+
+	if(value)
+		return g_ascii_strcasecmp(value, "false") == 0;
+
+	/* Types of C plugins are registered by their loadable module */
+	return g_type_get_plugin(G_OBJECT_TYPE(wallpaper)) == NULL;
+}
 
 static void
 lw_application_load_wallpaper_plugin(PeasEngine *engine, PeasPluginInfo *info, LwApplication *self)
@@ -149,7 +178,10 @@ lw_application_load_wallpaper_plugin(PeasEngine *engine, PeasPluginInfo *info, L
 		return;
 
 	self->priv->wallpaper = LW_WALLPAPER(peas_engine_create_extension(engine, info, LW_TYPE_WALLPAPER, NULL));
+	self->priv->wallpaper_bypasses_gl_state =
+		lw_application_wallpaper_bypasses_gl_state(info, self->priv->wallpaper);
 	lw_wallpaper_init_plugin(self->priv->wallpaper);
+	lw_gl_state_invalidate();
 
 	lw_application_adjust_viewport();
 }
@@ -245,9 +277,13 @@ lw_application_dispatch(GSource *source,
 		/* Paint all outputs */
 		GList *outputs = self->priv->outputs;
 
+		/* Upload the next slice of asynchronously loaded textures */
+		lw_texture_loader_process(lw_texture_loader_get_default());
+
 		/* Prepare paint */
 		lw_wallpaper_prepare_paint(self->priv->wallpaper,
                                    lw_clock_get_ms_since_last_frame(self->priv->clock));
+		lw_application_wallpaper_changed_gl_state();
 		for(; outputs; outputs = outputs->next)
 		{
 			LwOutput *o;
@@ -260,20 +296,26 @@ lw_application_dispatch(GSource *source,
 				lw_output_make_current(o);
 
 				lw_wallpaper_adjust_viewport(self->priv->wallpaper, o);
+				lw_application_wallpaper_changed_gl_state();
 			}
 			else    /* Get current output */
 				o = self->priv->outputs->data;
 
 			/* Paint */
 			lw_wallpaper_paint(self->priv->wallpaper, o);
+			lw_application_wallpaper_changed_gl_state();
 			lw_fps_visualizer_paint(self->priv->fps, o);
 
 			if(self->priv->n_outputs > 1)   /* Restore viewport */
+			{
 				lw_wallpaper_restore_viewport(self->priv->wallpaper);
+				lw_application_wallpaper_changed_gl_state();
+			}
 		}
 
 		/* Done paint */
 		lw_wallpaper_done_paint(self->priv->wallpaper);
+		lw_application_wallpaper_changed_gl_state();
 	}
 	else
 	{
@@ -285,6 +327,15 @@ lw_application_dispatch(GSource *source,
 	lw_window_swap_buffers(self->priv->win);
 	lw_clock_end_frame(self->priv->clock);
 
+	/* Report how many OpenGL calls were skipped by the state cache */
+	if(++self->priv->frames_since_gl_report >= 600)
+	{
+		g_debug("OpenGL state cache elided %u calls in the last %u frames",
+		        lw_gl_state_get_elided_calls(), self->priv->frames_since_gl_report);
+		lw_gl_state_reset_elided_calls();
+		self->priv->frames_since_gl_report = 0;
+	}
+
 	return TRUE;
 }
 
@@ -412,6 +463,8 @@ lw_application_init(LwApplication *self)
 	g_settings_bind(self->priv->settings, "fps-limit",
 	                self->priv->clock,    "fps-limit",
 	                G_SETTINGS_BIND_GET);
+	self->priv->frames_since_gl_report = 0;
+	self->priv->wallpaper_bypasses_gl_state = FALSE;
 
 	/* Connect LiveWallpaper to the main loop */
 	self->priv->source = g_source_new(&source_funcs, sizeof(LwSource));
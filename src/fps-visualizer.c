@@ -202,6 +202,9 @@ lw_fps_visualizer_update_tex(LwFPSVisualizer *self)
 	cairo_show_text(cr, s);
 
 	cairo_destroy(cr);
+
+	/* Only the part showing the FPS is drawn */
+	lw_cairo_texture_mark_dirty(self->priv->tex, 0, 0, fps_width, fps_height);
 	lw_cairo_texture_update(self->priv->tex);
 	self->priv->fps_width  = fps_width;
 	self->priv->fps_height = fps_height;
@@ -238,8 +241,8 @@ lw_fps_visualizer_paint(LwFPSVisualizer *self, LwOutput *output)
 	glPushMatrix();
 	glLoadIdentity();
 
-	if(glIsEnabled(GL_BLEND)) was_blending_enabled = TRUE;
-	glDisable(GL_BLEND);
+	if(lw_gl_state_is_enabled(GL_BLEND)) was_blending_enabled = TRUE;
+	lw_gl_state_disable(GL_BLEND);
 
 	glColor3f(1.0f, 1.0f, 1.0f);
 
@@ -276,7 +279,7 @@ lw_fps_visualizer_paint(LwFPSVisualizer *self, LwOutput *output)
 	lw_texture_disable(LW_TEXTURE(self->priv->tex));
 
 	/* Restore viewport */
-	if(was_blending_enabled) glEnable(GL_BLEND);
+	if(was_blending_enabled) lw_gl_state_enable(GL_BLEND);
 
 	glMatrixMode(GL_PROJECTION);
 	glPopMatrix();
@@ -0,0 +1,140 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/*
+ * Measures how fast the CPU path of the galaxy plugin moves its stars. It compares
+ * the former loop over an array of structures with galaxy_orbit_update() on one thread
+ * and split into chunks on the default LwJobSystem, and checks that the stars end
+ * up at the same positions. It is built with the tools and run as a test for each
+ * kernel, see tools/CMakeLists.txt. If LW_ORBIT_KERNEL selects a kernel the CPU
+ * does not support, it exits with 77 so the test is skipped.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <livewallpaper/core.h>
+#include "orbit.h"
+
+#define STARS 500000
+#define RUNS 50
+#define CHUNK_SIZE 2048
+
+/* The step of a frame at 60 frames per second */
+#define ELAPSED 16.0f
+
+/* Exit status which makes CTest report a test as skipped */
+#define SKIP_RETURN_CODE 77
+
+/* Same as in plugins/galaxy/src/particle.c */
+#define ELLIPSE_RATIO .885f
+
+typedef struct
+{
+	gfloat cos_phi, sin_phi, angle, distance, speed;
+} Star;
+
+static Star aos[STARS];
+static gfloat angle[STARS], speed[STARS], distance[STARS], cos_phi[STARS], sin_phi[STARS];
+static gfloat aos_vertices[3 * STARS], soa_vertices[3 * STARS];
+
+static void
+update_aos(void)
+{
+	Star *star;
+	gfloat *v = aos_vertices;
+
+	for(star = aos; star != aos + STARS; ++star, v += 3)
+	{
+		gfloat a_cos_angle, b_sin_angle;
+
+		star->angle += ELAPSED * star->speed;
+		while(star->angle < -LW_2PI) star->angle += LW_2PI;
+		while(star->angle > 0)     star->angle -= LW_2PI;
+
+		a_cos_angle = star->distance * lw_cos(star->angle);
+		b_sin_angle = star->distance * lw_sin(star->angle) * ELLIPSE_RATIO;
+
+		v[0] = a_cos_angle * star->cos_phi - b_sin_angle * star->sin_phi;
+		v[1] = a_cos_angle * star->sin_phi + b_sin_angle * star->cos_phi;
+	}
+}
+
+static void
+update_chunk(guint first, guint count, gpointer data)
+{
+	galaxy_orbit_update(angle + first, speed + first, distance + first, cos_phi + first,
+	                    sin_phi + first, ELLIPSE_RATIO, ELAPSED, soa_vertices + 3 * first, count);
+}
+
+int main(void)
+{
+	const gchar *kernel = g_getenv("LW_ORBIT_KERNEL");
+	LwJobSystem *jobs = lw_job_system_get_default();
+	gint64 start, aos_time, soa_time, parallel_time;
+	gfloat max_error = 0.0f;
+	int i, run;
+
+	/* An unsupported kernel falls back to another one, which is tested on its own */
+	if(kernel != NULL && g_strcmp0(kernel, galaxy_orbit_get_kernel()) != 0)
+	{
+		printf("The %s kernel is not available on this CPU\n", kernel);
+		return SKIP_RETURN_CODE;
+	}
+
+	for(i = 0; i < STARS; i++)
+	{
+		aos[i].distance = distance[i] = rand2f(0.001f, 1.0f);
+		aos[i].cos_phi = cos_phi[i] = cos(distance[i] * LW_2PI);
+		aos[i].sin_phi = sin_phi[i] = sin(distance[i] * LW_2PI);
+		aos[i].angle = angle[i] = rand1f(-LW_2PI);
+		aos[i].speed = speed[i] = -rand2f(0.00003f, 0.000045f) / distance[i];
+	}
+
+	start = g_get_monotonic_time();
+	for(run = 0; run < RUNS; run++)
+		update_aos();
+	aos_time = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for(run = 0; run < RUNS; run++)
+		galaxy_orbit_update(angle, speed, distance, cos_phi, sin_phi, ELLIPSE_RATIO, ELAPSED, soa_vertices, STARS);
+	soa_time = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for(run = 0; run < RUNS; run++)
+		lw_job_system_parallel_for(jobs, STARS, CHUNK_SIZE, update_chunk, NULL);
+	parallel_time = g_get_monotonic_time() - start;
+
+	printf("array of structures: %8.2f ms per frame\n", aos_time / 1000.0 / RUNS);
+	printf("%-6s kernel:       %8.2f ms per frame, %5.1fx faster\n", galaxy_orbit_get_kernel(),
+	       soa_time / 1000.0 / RUNS, (double) aos_time / soa_time);
+	printf("%u worker threads:   %8.2f ms per frame, %5.1fx faster\n", lw_job_system_get_n_workers(jobs),
+	       parallel_time / 1000.0 / RUNS, (double) aos_time / parallel_time);
+
+	/* The other stars have moved twice as often */
+	for(run = 0; run < RUNS; run++)
+		update_aos();
+	for(i = 0; i < 2 * STARS; i++)
+		max_error = MAX(max_error, fabs(aos_vertices[i + i / 2] - soa_vertices[i + i / 2]));
+	printf("maximum difference of the positions: %g\n", max_error);
+
+	return max_error < 1e-4f ? 0 : 1;
+}
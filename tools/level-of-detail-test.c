@@ -0,0 +1,79 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+
+/*
+ * Checks that LwLevelOfDetail lowers the particle count of a weak machine. It
+ * simulates a laptop with a 1366x768 output that is asked to draw 500000 stars
+ * of one pixel. The pixel area has to limit the count at once, and a frame time
+ * growing with the count has to lower it below the budget. There is no OpenGL
+ * context, so only the CPU time is measured. It is run as a test, see
+ * tools/CMakeLists.txt.
+ */
+
+#include <stdio.h>
+#include <livewallpaper/core.h>
+
+#define MAX_COUNT 500000
+#define FRAMES 400
+
+/* Microseconds the simulated frame takes per particle and the budget in milliseconds */
+#define COST 0.025
+#define BUDGET 4.0
+
+int main(void)
+{
+	LwLevelOfDetail *lod = lw_level_of_detail_new(4.0);
+	LwOutput *output = g_object_new(LW_TYPE_OUTPUT, "width", 1366, "height", 768, NULL);
+	guint area_count, count, frame;
+
+	g_object_set(lod, "max-count", MAX_COUNT, "budget", BUDGET, "enabled", TRUE, NULL);
+
+	lw_level_of_detail_begin_frame(lod);
+	lw_level_of_detail_add_output(lod, output, 1.0);
+	lw_level_of_detail_end_frame(lod);
+
+	area_count = lw_level_of_detail_get_count(lod);
+	printf("limited by the area:       %u of %u particles\n", area_count, MAX_COUNT);
+
+	for(frame = 0; frame < FRAMES; frame++)
+	{
+		lw_level_of_detail_begin_frame(lod);
+		g_usleep(lw_level_of_detail_get_count(lod) * COST);
+		lw_level_of_detail_add_output(lod, output, 1.0);
+		lw_level_of_detail_end_frame(lod);
+	}
+
+	count = lw_level_of_detail_get_count(lod);
+	printf("limited by the frame time: %u particles, %.2f ms per frame\n", count, count * COST / 1000.0);
+
+	g_object_set(lod, "enabled", FALSE, NULL);
+	printf("disabled:                  %u particles\n", lw_level_of_detail_get_count(lod));
+
+	if(area_count >= MAX_COUNT || count == 0 || count * COST / 1000.0 > BUDGET ||
+	   lw_level_of_detail_get_count(lod) != MAX_COUNT)
+		return 1;
+
+	g_object_unref(output);
+	g_object_unref(lod);
+
+	return 0;
+}
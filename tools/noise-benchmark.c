@@ -0,0 +1,104 @@
+/*
+ *
+ * LiveWallpaper
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012-2016 Maximilian Schnarr <Maximilian.Schnarr@googlemail.com>
+ *
+ */
+
+/*
+ * Measures the throughput of lw_simplex_noise_2f() and lw_simplex_noise_2f_batch()
+ * and checks that both return the same values. It is built with the tools and
+ * "make test" runs it once for every kernel, selected by LW_NOISE_KERNEL.
+ * Run it with G_MESSAGES_DEBUG=all to see which kernel is used. If the CPU does
+ * not support the selected kernel, it exits with 77 so the test is skipped
+ * instead of testing the scalar kernel again.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <livewallpaper/core.h>
+
+#define SAMPLES 100000
+#define RUNS 100
+
+/* Exit status which makes CTest report a test as skipped */
+#define SKIP_RETURN_CODE 77
+
+/* Returns TRUE if livewallpaper-core can use the kernel called @name on this CPU */
+static gboolean
+kernel_available(const gchar *name)
+{
+	if(g_strcmp0(name, "scalar") == 0)
+		return TRUE;
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_cpu_init();
+	if(g_strcmp0(name, "avx2") == 0)
+		return __builtin_cpu_supports("avx2");
+	if(g_strcmp0(name, "sse2") == 0)
+		return __builtin_cpu_supports("sse2");
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	if(g_strcmp0(name, "neon") == 0)
+		return TRUE;
+#endif
+
+	return FALSE;
+}
+
+int main(void)
+{
+	static float x[SAMPLES], y[SAMPLES], single[SAMPLES], batch[SAMPLES];
+	const gchar *kernel = g_getenv("LW_NOISE_KERNEL");
+	gint64 start, single_time, batch_time;
+	int i, run;
+
+	if(kernel != NULL && !kernel_available(kernel))
+	{
+		printf("The %s kernel is not available on this CPU\n", kernel);
+		return SKIP_RETURN_CODE;
+	}
+
+	lw_noise_init();
+
+	for(i = 0; i < SAMPLES; i++)
+	{
+		x[i] = rand2f(0.0f, 100.0f);
+		y[i] = rand2f(0.0f, 100.0f);
+	}
+
+	start = g_get_monotonic_time();
+	for(run = 0; run < RUNS; run++)
+		for(i = 0; i < SAMPLES; i++)
+			single[i] = lw_simplex_noise_2f(x[i], y[i]);
+	single_time = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for(run = 0; run < RUNS; run++)
+		lw_simplex_noise_2f_batch(x, y, batch, SAMPLES);
+	batch_time = g_get_monotonic_time() - start;
+
+	printf("lw_simplex_noise_2f:       %8.2f million samples/s\n", (double) SAMPLES * RUNS / single_time);
+	printf("lw_simplex_noise_2f_batch: %8.2f million samples/s\n", (double) SAMPLES * RUNS / batch_time);
+
+	if(memcmp(single, batch, sizeof(single)) != 0)
+	{
+		printf("lw_simplex_noise_2f_batch returned different values\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -19,29 +19,78 @@
  *
  */
 
+/*
+ * Generates livewallpaper-core's sine table. The only argument is the number of
+ * table entries per quarter period, a power of two. The build runs it with the
+ * value of the LW_SINE_TABLE_STEPS CMake variable. The table holds one full
+ * period, so lw_sin(), lw_cos() and lw_sincos_batch() can interpolate linearly
+ * without folding the angle into the first quadrant.
+ */
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
-#define STEPS 1024
-#define _PI (float) 3.141593
+#define DEFAULT_STEPS 1024
+#define _PI 3.14159265358979323846
 
-int main(void)
+/* Interpolates like lw_sin() does and returns the maximum error over one period */
+static double max_error(const float *values, int steps, float step)
 {
+	double error = 0.0, e;
 	int i;
-	float step = (_PI) / (2*STEPS);
+
+	for(i = 0; i < 4 * steps * 16; i++)
+	{
+		float angle = (float) (i * _PI / (32 * steps));
+		float x = angle / step, f;
+		int j = (int) x;
+
+		j -= (float) j > x;
+		f = x - (float) j;
+		j &= 4 * steps - 1;
+
+		e = fabs(values[j] + f * (values[j + 1] - values[j]) - sin(angle));
+		if(e > error)
+			error = e;
+	}
+
+	return error;
+}
+
+int main(int argc, char **argv)
+{
+	int i, steps = DEFAULT_STEPS;
+	float step, *values;
+
+	if(argc > 1)
+		steps = atoi(argv[1]);
+
+	if(steps < 16 || (steps & (steps - 1)) != 0)
+	{
+		fprintf(stderr, "The number of steps has to be a power of two and at least 16\n");
+		return 1;
+	}
+
+	step = _PI / (2 * steps);
+	values = malloc((4 * steps + 1) * sizeof(float));
+	for(i = 0; i <= 4 * steps; i++)
+		values[i] = sin(i * _PI / (2 * steps));
 
 	printf("/* This file is automatically generated by tools/sine-table-generator - do not edit manually */\n\n");
-	printf("#define STEPS %i\n\n", STEPS);
-	printf("const float step = %ff;\n", step);
-	printf("const float sin_values[%i] =\n{\n", STEPS);
-	for(i = 0; i < STEPS; i++)
+	printf("/* Maximum error of lw_sin() and lw_cos(): %.2g */\n\n", max_error(values, steps, step));
+	printf("const int sin_steps = %i;\n", steps);
+	printf("const float step = %#.9gf;\n", step);
+	printf("const float sin_values[%i] =\n{\n", 4 * steps + 1);
+	for(i = 0; i <= 4 * steps; i++)
 	{
-		printf("\t%f", sin(i*step));
-		if(i != STEPS - 1)
+		printf("\t%#.9gf", values[i]);
+		if(i != 4 * steps)
 			printf(",\n");
 	}
 	printf("\n};\n\n");
 
+	free(values);
+
 	return 0;
 }
-